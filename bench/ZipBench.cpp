@@ -0,0 +1,370 @@
+// Micro-benchmarks for the ZipArchive operations premake-gen runs while generating a project:
+// opening a library ZIP, path lookups, walking a subtree and extracting entries.
+//
+// Archives are generated into a temporary folder for a matrix of entry counts, folder depths,
+// entry sizes and compression methods, each written both as a plain ZIP and as a "--pack" ZIP
+// with an embedded entry index.
+//
+// Usage: premake-gen-bench [filter] [--min-ms N] [--csv]
+//   filter    only runs cases whose name contains this text
+//   --min-ms  minimum measured time per operation (default 200)
+//   --csv     prints one line per result, for comparing runs in CI
+
+#include "ZipArchive.h"
+#include "ZipWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Scenario
+    {
+        const char* name;
+        uint32_t entryCount;
+        uint32_t depth;         // folders between the archive root and each file
+        uint32_t entrySize;
+        bool deflate;
+    };
+
+    // Shapes seen in real libraries: many small headers, deep include trees, and a few large .lib files
+    const Scenario SCENARIOS[] = {
+        { "headers-flat",     1000, 1, 2 * 1024,        true  },
+        { "headers-deep",     1000, 8, 2 * 1024,        true  },
+        { "headers-many",    20000, 4, 512,             true  },
+        { "headers-stored",   1000, 4, 2 * 1024,        false },
+        { "libs-stored",        16, 2, 4 * 1024 * 1024, false },
+        { "libs-deflate",       16, 2, 4 * 1024 * 1024, true  },
+    };
+
+    struct Options
+    {
+        std::string filter;
+        double minSeconds = 0.2;
+        bool csv = false;
+    };
+
+    struct Result
+    {
+        std::string name;
+        double nsPerOp = 0.0;
+        double itemsPerSecond = 0.0;
+        double megabytesPerSecond = 0.0;
+    };
+
+    // xorshift, so archives are identical from run to run
+    uint32_t NextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Source-like text that deflates to roughly a third of its size
+    std::string MakePayload(uint32_t size, uint32_t seed)
+    {
+        static const char* const WORDS[] = {
+            "const", "std::string", "return", "template", "typename", "uint32_t", "namespace", "if",
+            "for", "inline", "static", "void", "struct", "class", "public:", "size_t", "nullptr", "auto"
+        };
+        std::string text;
+        text.reserve(size);
+        uint32_t state = seed * 2654435761u + 1;
+        while (text.size() < size)
+        {
+            const uint32_t random = NextRandom(state);
+            text += WORDS[random % (sizeof(WORDS) / sizeof(WORDS[0]))];
+            text += (random >> 8) % 9 == 0 ? '\n' : ' ';
+            if ((random >> 16) % 7 == 0)
+                text += std::to_string(random % 1000);
+        }
+        text.resize(size);
+        return text;
+    }
+
+    std::string FolderOf(uint32_t entry, uint32_t depth)
+    {
+        std::string folder = "include";
+        for (uint32_t level = 1; level < depth; ++level)
+            folder += "/dir" + std::to_string((entry >> (level * 2)) % 4);
+        return folder;
+    }
+
+    std::string EntryName(uint32_t entry, uint32_t depth)
+    {
+        return FolderOf(entry, depth) + "/file" + std::to_string(entry) + ".h";
+    }
+
+    // Writes the scenario's archive the way "--pack" does when indexed is set
+    bool WriteArchive(const Scenario& scenario, bool indexed, const std::filesystem::path& folder, const std::string& path)
+    {
+        // A handful of distinct payloads keeps generation fast without making every entry identical
+        constexpr uint32_t PAYLOAD_COUNT = 8;
+        std::vector<std::filesystem::path> payloads;
+        for (uint32_t i = 0; i < PAYLOAD_COUNT; ++i)
+        {
+            payloads.push_back(folder / ("payload" + std::to_string(i) + ".txt"));
+            std::ofstream file(payloads.back(), std::ios::binary);
+            file << MakePayload(scenario.entrySize, i + 1);
+            if (!file)
+                return false;
+        }
+
+        ZipWriter writer;
+        if (!writer.Open(path))
+            return false;
+
+        bool ok = writer.AddData("library.info", (const uint8_t*)"@defines\n", 9);
+        std::vector<std::string> folders;
+        for (uint32_t entry = 0; ok && entry < scenario.entryCount; ++entry)
+        {
+            // Folders are written before their files, like archive tools do
+            const std::string entryFolder = FolderOf(entry, scenario.depth);
+            for (size_t slash = 0; ok && slash != std::string::npos; )
+            {
+                slash = entryFolder.find('/', slash + 1);
+                const std::string parent = entryFolder.substr(0, slash) + "/";
+                if (std::find(folders.begin(), folders.end(), parent) == folders.end())
+                {
+                    folders.push_back(parent);
+                    ok = writer.AddDirectory(parent);
+                }
+            }
+            if (ok)
+                ok = writer.AddFile(EntryName(entry, scenario.depth), payloads[entry % PAYLOAD_COUNT], scenario.deflate, 0.0);
+        }
+
+        if (ok && indexed)
+        {
+            std::vector<uint8_t> directory;
+            std::vector<uint8_t> index;
+            writer.BuildCentralDirectory(directory);
+            ok = ZipArchive::BuildIndex(directory, writer.Records().size(), index);
+            const uint64_t indexOffset = writer.Offset();
+            if (ok)
+                ok = writer.AddData(ZipArchive::INDEX_ENTRY_NAME, index.data(), index.size());
+            if (ok)
+                ok = writer.Close(ZipArchive::IndexComment(indexOffset, index, writer.Offset()));
+        }
+        else if (ok)
+        {
+            ok = writer.Close();
+        }
+
+        for (const std::filesystem::path& payload : payloads)
+        {
+            std::error_code ec;
+            std::filesystem::remove(payload, ec);
+        }
+        return ok;
+    }
+
+    // Runs op until minSeconds have passed and returns the time of one call in nanoseconds
+    template <typename Op>
+    double Measure(const Options& options, Op&& op)
+    {
+        using Clock = std::chrono::steady_clock;
+        op(); // warm up caches and buffers
+
+        uint64_t iterations = 0;
+        uint64_t batch = 1;
+        const Clock::time_point start = Clock::now();
+        double elapsed = 0.0;
+        while (elapsed < options.minSeconds)
+        {
+            for (uint64_t i = 0; i < batch; ++i)
+                op();
+            iterations += batch;
+            batch = std::min<uint64_t>(batch * 2, 1 << 16);
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        return elapsed * 1e9 / (double)iterations;
+    }
+
+    void Report(const Options& options, std::vector<Result>& results, const std::string& name, double nsPerOp, double itemsPerOp, double bytesPerOp)
+    {
+        Result result;
+        result.name = name;
+        result.nsPerOp = nsPerOp;
+        result.itemsPerSecond = itemsPerOp * 1e9 / nsPerOp;
+        result.megabytesPerSecond = bytesPerOp * 1e9 / nsPerOp / (1024.0 * 1024.0);
+
+        if (options.csv)
+        {
+            std::printf("%s,%.1f,%.0f,%.1f\n", result.name.c_str(), result.nsPerOp, result.itemsPerSecond, result.megabytesPerSecond);
+        }
+        else
+        {
+            std::printf("%-44s %14.1f %14.0f", result.name.c_str(), result.nsPerOp, result.itemsPerSecond);
+            if (bytesPerOp > 0.0)
+                std::printf(" %10.1f", result.megabytesPerSecond);
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+        results.push_back(std::move(result));
+    }
+
+    bool RunScenario(const Options& options, const Scenario& scenario, bool indexed, const std::filesystem::path& folder, std::vector<Result>& results)
+    {
+        const std::string name = std::string(scenario.name) + (indexed ? "/packed" : "/plain");
+        const std::string path = (folder / (std::string(scenario.name) + (indexed ? "-packed.zip" : "-plain.zip"))).u8string();
+        if (!WriteArchive(scenario, indexed, folder, path))
+        {
+            std::cout << "[ERR] Could not write benchmark archive: " << path << "\n";
+            return false;
+        }
+
+        ZipArchive zip;
+        if (!zip.Open(path) || zip.LoadedFromIndex() != indexed)
+        {
+            std::cout << "[ERR] Could not open benchmark archive: " << path << "\n";
+            return false;
+        }
+
+        const double entries = (double)zip.Size();
+        Report(options, results, name + "/open", Measure(options, [&]() { zip.Open(path); }), entries, 0.0);
+
+        // Lookups cycle through every file so the intern table and child ranges are not all cached
+        std::vector<std::string> paths;
+        for (uint32_t entry = 0; entry < scenario.entryCount; ++entry)
+            paths.push_back(EntryName(entry, scenario.depth));
+        size_t next = 0;
+        bool found = true;
+        Report(options, results, name + "/contains", Measure(options, [&]()
+        {
+            found &= zip.Contains(paths[next]);
+            next = (next + 1) % paths.size();
+        }), 1.0, 0.0);
+        Report(options, results, name + "/find", Measure(options, [&]()
+        {
+            found &= zip.Find(paths[next]) != ZipArchive::npos;
+            next = (next + 1) % paths.size();
+        }), 1.0, 0.0);
+        found &= !zip.Contains("include/missing.h");
+        if (!found)
+        {
+            std::cout << "[ERR] Lookup failed in " << path << "\n";
+            return false;
+        }
+
+        // Walking "include" and building each relative path is what planning a copy does
+        const uint32_t include = zip.Find("include");
+        std::string relative;
+        uint64_t walked = 0;
+        Report(options, results, name + "/walk", Measure(options, [&]()
+        {
+            for (const uint32_t index : zip.Subtree(include))
+            {
+                zip.RelativePath(index, include, relative);
+                walked += relative.size();
+            }
+        }), (double)zip.Subtree(include).size(), 0.0);
+
+        // Extraction is measured on a spread of entries so small files are not all served from one buffer
+        constexpr size_t EXTRACT_SAMPLE = 64;
+        std::vector<uint32_t> extractIndices;
+        for (size_t i = 0; i < std::min<size_t>(EXTRACT_SAMPLE, paths.size()); ++i)
+            extractIndices.push_back(zip.Find(paths[i * paths.size() / std::min<size_t>(EXTRACT_SAMPLE, paths.size())]));
+        const double entryBytes = (double)scenario.entrySize;
+
+        std::string buffer;
+        bool extracted = true;
+        next = 0;
+        Report(options, results, name + "/extract-string", Measure(options, [&]()
+        {
+            extracted &= zip.ExtractToString(extractIndices[next], buffer);
+            next = (next + 1) % extractIndices.size();
+        }), 1.0, entryBytes);
+
+        const std::string output = (folder / "extracted.h").u8string();
+        next = 0;
+        Report(options, results, name + "/extract-file", Measure(options, [&]()
+        {
+            extracted &= zip.ExtractToFile(extractIndices[next], output);
+            next = (next + 1) % extractIndices.size();
+        }), 1.0, entryBytes);
+
+        zip.Close();
+        std::error_code ec;
+        std::filesystem::remove(output, ec);
+        std::filesystem::remove(path, ec);
+        if (!extracted || walked == 0)
+        {
+            std::cout << "[ERR] Extraction failed in " << path << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--csv")
+            {
+                options.csv = true;
+            }
+            else if (arg == "--min-ms" && i + 1 < argc)
+            {
+                options.minSeconds = std::max(1, std::atoi(argv[++i])) / 1000.0;
+            }
+            else if (!arg.empty() && arg[0] != '-' && options.filter.empty())
+            {
+                options.filter = arg;
+            }
+            else
+            {
+                std::cout << "[ERR] Unknown argument: " << arg << "\n";
+                std::cout << "Usage: premake-gen-bench [filter] [--min-ms N] [--csv]\n";
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    std::error_code ec;
+    const std::filesystem::path folder = std::filesystem::temp_directory_path(ec) / "premake-gen-bench";
+    std::filesystem::create_directories(folder, ec);
+    if (ec)
+    {
+        std::cout << "[ERR] Could not create " << folder.u8string() << "\n";
+        return 1;
+    }
+
+    if (options.csv)
+        std::printf("name,ns_per_op,items_per_s,mb_per_s\n");
+    else
+        std::printf("%-44s %14s %14s %10s\n", "case", "ns/op", "entries/s", "MB/s");
+
+    std::vector<Result> results;
+    bool ok = true;
+    for (const Scenario& scenario : SCENARIOS)
+    {
+        for (const bool indexed : { false, true })
+        {
+            const std::string name = std::string(scenario.name) + (indexed ? "/packed" : "/plain");
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+                continue;
+            ok &= RunScenario(options, scenario, indexed, folder, results);
+        }
+    }
+
+    std::filesystem::remove_all(folder, ec);
+    return ok ? 0 : 1;
+}
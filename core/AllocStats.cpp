@@ -0,0 +1,192 @@
+#include "AllocStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#define ALLOCATED_SIZE(p) _msize(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define ALLOCATED_SIZE(p) malloc_size(p)
+#else
+#include <malloc.h>
+#define ALLOCATED_SIZE(p) malloc_usable_size(p)
+#endif
+
+namespace
+{
+    constexpr size_t MAX_PHASES = 16;
+
+    struct Phase
+    {
+        const char* name = nullptr;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        int64_t peakLive = 0;
+    };
+
+    // Plain globals with constant initialization, so they are usable before any constructor runs
+    std::atomic<bool> enabled{ false };
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> requestedBytes{ 0 };
+    std::atomic<int64_t> liveBytes{ 0 };
+    std::atomic<int64_t> peakLiveBytes{ 0 };
+
+    std::mutex phaseMutex;
+    Phase phases[MAX_PHASES];
+    size_t phaseCount = 0;
+    Phase* currentPhase = nullptr;
+    uint64_t phaseStartAllocations = 0;
+    uint64_t phaseStartBytes = 0;
+
+    void RecordAllocation(void* p, size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        requestedBytes.fetch_add(size, std::memory_order_relaxed);
+        const int64_t live = liveBytes.fetch_add((int64_t)ALLOCATED_SIZE(p), std::memory_order_relaxed) + (int64_t)ALLOCATED_SIZE(p);
+        int64_t peak = peakLiveBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void* Allocate(size_t size)
+    {
+        if (size == 0)
+            size = 1;
+        void* p = nullptr;
+        while ((p = std::malloc(size)) == nullptr)
+        {
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+        if (enabled.load(std::memory_order_relaxed))
+            RecordAllocation(p, size);
+        return p;
+    }
+
+    void* AllocateNoThrow(size_t size) noexcept
+    {
+        try
+        {
+            return Allocate(size);
+        }
+        catch (std::bad_alloc&)
+        {
+            return nullptr;
+        }
+    }
+
+    void Free(void* p) noexcept
+    {
+        if (p == nullptr)
+            return;
+        if (enabled.load(std::memory_order_relaxed))
+            liveBytes.fetch_sub((int64_t)ALLOCATED_SIZE(p), std::memory_order_relaxed);
+        std::free(p);
+    }
+
+    // Folds the counters since the phase began into it; phaseMutex must be held
+    void EndPhase()
+    {
+        const uint64_t allocationsNow = allocations.load(std::memory_order_relaxed);
+        const uint64_t bytesNow = requestedBytes.load(std::memory_order_relaxed);
+        if (currentPhase != nullptr)
+        {
+            currentPhase->allocations += allocationsNow - phaseStartAllocations;
+            currentPhase->bytes += bytesNow - phaseStartBytes;
+            currentPhase->peakLive = std::max(currentPhase->peakLive, peakLiveBytes.load(std::memory_order_relaxed));
+        }
+        phaseStartAllocations = allocationsNow;
+        phaseStartBytes = bytesNow;
+        peakLiveBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size); }
+void operator delete(void* p) noexcept { Free(p); }
+void operator delete[](void* p) noexcept { Free(p); }
+void operator delete(void* p, size_t) noexcept { Free(p); }
+void operator delete[](void* p, size_t) noexcept { Free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { Free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { Free(p); }
+
+void EnableAllocStats()
+{
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    enabled.store(true, std::memory_order_relaxed);
+    EndPhase();
+}
+
+bool AllocStatsEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void BeginAllocPhase(const char* phase)
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    EndPhase();
+    currentPhase = nullptr;
+    for (size_t i = 0; i < phaseCount; ++i)
+    {
+        if (std::strcmp(phases[i].name, phase) == 0)
+            currentPhase = &phases[i];
+    }
+    if (currentPhase == nullptr && phaseCount < MAX_PHASES)
+    {
+        currentPhase = &phases[phaseCount++];
+        currentPhase->name = phase;
+    }
+}
+
+void PrintAllocStats()
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    // Copied out first, so printing doesn't count towards the last phase
+    Phase results[MAX_PHASES];
+    size_t resultCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(phaseMutex);
+        EndPhase();
+        currentPhase = nullptr;
+        resultCount = phaseCount;
+        std::copy(phases, phases + phaseCount, results);
+    }
+
+    Phase total;
+    std::cout << "\nAllocations by phase:\n";
+    std::cout << std::left << std::setw(16) << "phase" << std::right << std::setw(12) << "allocs"
+        << std::setw(16) << "bytes" << std::setw(16) << "peak live" << "\n";
+    std::cout << "------------------------------------------------------------\n";
+    for (size_t i = 0; i < resultCount; ++i)
+    {
+        const Phase& phase = results[i];
+        std::cout << std::left << std::setw(16) << phase.name << std::right << std::setw(12) << phase.allocations
+            << std::setw(16) << phase.bytes << std::setw(16) << std::max<int64_t>(0, phase.peakLive) << "\n";
+        total.allocations += phase.allocations;
+        total.bytes += phase.bytes;
+        total.peakLive = std::max(total.peakLive, phase.peakLive);
+    }
+    std::cout << "------------------------------------------------------------\n";
+    std::cout << std::left << std::setw(16) << "total" << std::right << std::setw(12) << total.allocations
+        << std::setw(16) << total.bytes << std::setw(16) << std::max<int64_t>(0, total.peakLive) << std::endl;
+}
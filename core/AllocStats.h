@@ -0,0 +1,14 @@
+#pragma once
+
+// Heap accounting for --alloc-stats. AllocStats.cpp replaces the global operator new/delete with
+// malloc/free forwarders; until EnableAllocStats() is called they only add one relaxed atomic load.
+// Allocations are attributed to the current phase, and a phase that is entered again keeps adding up.
+
+void EnableAllocStats();
+bool AllocStatsEnabled();
+
+// Ends the current phase and attributes everything from here on to phase (a string literal)
+void BeginAllocPhase(const char* phase);
+
+// Allocation count, requested bytes and peak live heap of each phase, in the order they were first entered
+void PrintAllocStats();
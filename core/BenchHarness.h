@@ -0,0 +1,240 @@
+#pragma once
+
+// Sources written into the generated "<Project>Bench" project when "-bench" is used.
+// Bench.h is owned by premake-gen and rewritten on every run, Main.cpp belongs to the user.
+
+#define BENCH_PROJECT_SUFFIX "Bench"
+
+const char* BENCH_HARNESS_HEADER = R"BENCH(#pragma once
+
+// Self-contained micro-benchmark harness generated by premake-gen.
+// Each benchmark is warmed up, calibrated so a single sample lasts at least
+// minSampleMs, then measured over a number of samples. Results are reported
+// per operation (min / median / mean / stddev / max).
+//
+// Command line: <exe> [filter] [--samples N] [--warmup-ms N] [--min-sample-ms N] [--csv]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    // Keeps the compiler from optimizing away a computed value
+    template <typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(_MSC_VER)
+        static const volatile void* sink = nullptr;
+        sink = static_cast<const volatile void*>(&value);
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    // Prevents the compiler from reordering memory operations across this point
+    inline void ClobberMemory()
+    {
+#if defined(_MSC_VER)
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+#else
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    struct Config
+    {
+        std::string filter;
+        size_t samples = 30;
+        double warmupMs = 100.0;
+        double minSampleMs = 10.0;
+        bool csv = false;
+    };
+
+    struct Stats
+    {
+        std::string name;
+        uint64_t iterations = 0;    // iterations per sample
+        size_t samples = 0;
+        double min = 0.0;           // all values in ns per operation
+        double max = 0.0;
+        double mean = 0.0;
+        double median = 0.0;
+        double stddev = 0.0;
+    };
+
+    class Runner
+    {
+        using Clock = std::chrono::steady_clock;
+
+    public:
+        Runner() = default;
+        Runner(int argc, char* argv[])
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string arg = argv[i];
+                if (arg == "--samples" && i + 1 < argc)
+                    m_config.samples = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+                else if (arg == "--warmup-ms" && i + 1 < argc)
+                    m_config.warmupMs = std::atof(argv[++i]);
+                else if (arg == "--min-sample-ms" && i + 1 < argc)
+                    m_config.minSampleMs = std::atof(argv[++i]);
+                else if (arg == "--csv")
+                    m_config.csv = true;
+                else
+                    m_config.filter = arg;
+            }
+        }
+        Runner(const Config& config) : m_config(config) {}
+
+        template <typename Func>
+        void Run(const std::string& name, Func&& func)
+        {
+            if (!m_config.filter.empty() && name.find(m_config.filter) == std::string::npos)
+                return;
+
+            PrintHeader();
+
+            // Warm-up: caches, branch predictors, lazy initialization, CPU clocks
+            const Clock::time_point warmupEnd = Clock::now() + ToDuration(m_config.warmupMs);
+            do
+            {
+                func();
+            } while (Clock::now() < warmupEnd);
+
+            // Calibration: grow the batch until one sample is long enough to time reliably
+            uint64_t iterations = 1;
+            for (;;)
+            {
+                const double ns = TimeBatch(func, iterations);
+                if (ns >= m_config.minSampleMs * 1e6 || iterations >= (uint64_t(1) << 40))
+                    break;
+                const double scale = (ns > 0.0) ? (m_config.minSampleMs * 1e6 * 1.2) / ns : 10.0;
+                iterations = std::max(iterations + 1, uint64_t(double(iterations) * std::min(scale, 10.0)));
+            }
+
+            std::vector<double> samples(m_config.samples);
+            for (double& sample : samples)
+                sample = TimeBatch(func, iterations) / double(iterations);
+
+            m_results.push_back(Summarize(name, iterations, samples));
+            PrintStats(m_results.back());
+        }
+
+        const std::vector<Stats>& Results() const { return m_results; }
+
+        int Finish() const
+        {
+            if (m_results.empty())
+                std::printf("No benchmarks matched filter '%s'\n", m_config.filter.c_str());
+            return 0;
+        }
+
+    private:
+        Config m_config;
+        std::vector<Stats> m_results;
+        bool m_headerPrinted = false;
+
+        static Clock::duration ToDuration(double ms)
+        {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+        }
+
+        template <typename Func>
+        static double TimeBatch(Func& func, uint64_t iterations)
+        {
+            ClobberMemory();
+            const Clock::time_point start = Clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+                func();
+            const Clock::time_point end = Clock::now();
+            ClobberMemory();
+            return std::chrono::duration<double, std::nano>(end - start).count();
+        }
+
+        static Stats Summarize(const std::string& name, uint64_t iterations, std::vector<double>& samples)
+        {
+            Stats stats;
+            stats.name = name;
+            stats.iterations = iterations;
+            stats.samples = samples.size();
+
+            std::sort(samples.begin(), samples.end());
+            stats.min = samples.front();
+            stats.max = samples.back();
+            const size_t mid = samples.size() / 2;
+            stats.median = (samples.size() % 2 == 0) ? (samples[mid - 1] + samples[mid]) * 0.5 : samples[mid];
+
+            double sum = 0.0;
+            for (const double s : samples)
+                sum += s;
+            stats.mean = sum / double(samples.size());
+
+            double variance = 0.0;
+            for (const double s : samples)
+                variance += (s - stats.mean) * (s - stats.mean);
+            stats.stddev = (samples.size() > 1) ? std::sqrt(variance / double(samples.size() - 1)) : 0.0;
+            return stats;
+        }
+
+        void PrintHeader()
+        {
+            if (m_headerPrinted)
+                return;
+            m_headerPrinted = true;
+
+            if (m_config.csv)
+            {
+                std::printf("name,iterations,samples,min_ns,median_ns,mean_ns,stddev_ns,max_ns\n");
+                return;
+            }
+            std::printf("%-40s %14s %14s %14s %9s %14s\n", "Benchmark", "median ns/op", "min ns/op", "mean ns/op", "stddev", "iterations");
+            std::printf("%s\n", std::string(110, '-').c_str());
+        }
+
+        void PrintStats(const Stats& stats) const
+        {
+            if (m_config.csv)
+            {
+                std::printf("%s,%llu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n", stats.name.c_str(),
+                    (unsigned long long)stats.iterations, stats.samples,
+                    stats.min, stats.median, stats.mean, stats.stddev, stats.max);
+                return;
+            }
+            const double relative = (stats.mean > 0.0) ? stats.stddev / stats.mean * 100.0 : 0.0;
+            std::printf("%-40s %14.2f %14.2f %14.2f %8.2f%% %9llux%zu\n", stats.name.c_str(),
+                stats.median, stats.min, stats.mean, relative,
+                (unsigned long long)stats.iterations, stats.samples);
+        }
+    };
+}
+)BENCH";
+
+const char* BENCH_MAIN_SOURCE = R"BENCH(#include "Bench.h"
+
+#include <numeric>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    bench::Runner runner(argc, argv);
+
+    std::vector<int> data(4096);
+    std::iota(data.begin(), data.end(), 0);
+
+    runner.Run("example/accumulate-4096", [&]()
+        {
+            bench::DoNotOptimize(std::accumulate(data.begin(), data.end(), 0LL));
+        });
+
+    return runner.Finish();
+}
+)BENCH";
@@ -0,0 +1,74 @@
+#pragma once
+
+// Shell completion scripts printed by "premake-gen --completion <bash|zsh>".
+// Both ask "premake-gen --complete <word>" for candidates, which a running server answers from memory.
+
+const char* COMPLETION_FLAGS[] = {
+	"--help", "--version", "--list", "--setup", "--libdir", "--appdata", "--pack", "--update", "--verify",
+	"--serve", "--ninja", "--complete", "--completion", "--io-buffer", "--max-memory", "--embed-premake",
+	"--prune-links", "--apply", "--dry-run", "--alloc-stats", "--quiet", "--verbose", "--details", "--sort", "--json", "-dialect", "-isa", "-windowed", "-example", "-bench", "-ninja", "-modules", "-merge-includes", "-prune-dlls", "-verify"
+};
+
+const char* BASH_COMPLETION_SCRIPT = R"COMPLETION(# bash completion for premake-gen
+# Install: premake-gen --completion bash > /etc/bash_completion.d/premake-gen
+#      or: source <(premake-gen --completion bash)
+
+_premake_gen()
+{
+    local cur="${COMP_WORDS[COMP_CWORD]}"
+    local prev="${COMP_WORDS[COMP_CWORD-1]}"
+    COMPREPLY=()
+
+    case "$prev" in
+        --libdir|-libdir|--pack|-pack)
+            COMPREPLY=( $(compgen -f -- "$cur") )
+            return ;;
+        --io-buffer|-io-buffer|--max-memory|-max-memory|-dialect|--completion)
+            return ;;
+    esac
+
+    # The solution and project names of a generation are free text
+    if [[ "$cur" != -* && "${COMP_WORDS[1]}" != -* && $COMP_CWORD -le 2 ]]; then
+        return
+    fi
+
+    local IFS=$'\n'
+    COMPREPLY=( $(premake-gen --complete "$cur" 2>/dev/null) )
+}
+complete -o default -F _premake_gen premake-gen
+)COMPLETION";
+
+const char* ZSH_COMPLETION_SCRIPT = R"COMPLETION(#compdef premake-gen
+# zsh completion for premake-gen
+# Install: premake-gen --completion zsh > "${fpath[1]}/_premake-gen"
+#      or: source <(premake-gen --completion zsh)
+
+_premake_gen()
+{
+    local cur="${words[CURRENT]}"
+    local prev="${words[CURRENT-1]}"
+
+    case "$prev" in
+        --libdir|-libdir|--pack|-pack)
+            _files
+            return ;;
+        --io-buffer|-io-buffer|--max-memory|-max-memory|-dialect|--completion)
+            return ;;
+    esac
+
+    # The solution and project names of a generation are free text
+    if [[ "$cur" != -* && "${words[2]}" != -* && $CURRENT -le 3 ]]; then
+        return
+    fi
+
+    local -a candidates
+    candidates=( ${(f)"$(premake-gen --complete "$cur" 2>/dev/null)"} )
+    compadd -Q -- $candidates
+}
+
+if [[ "$funcstack[1]" == "_premake-gen" ]]; then
+    _premake_gen "$@"
+else
+    compdef _premake_gen premake-gen
+fi
+)COMPLETION";
@@ -0,0 +1,300 @@
+#include "Console.h"
+
+#include "Json.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#define STDOUT_IS_TERMINAL() (_isatty(_fileno(stdout)) != 0)
+#else
+#include <unistd.h>
+#define STDOUT_IS_TERMINAL() (isatty(STDOUT_FILENO) != 0)
+#endif
+
+namespace
+{
+    constexpr int64_t TERMINAL_INTERVAL_MS = 100;
+    constexpr int64_t LOG_INTERVAL_MS = 2000;
+
+    Verbosity verbosity = Verbosity::Normal;
+    bool json = false;
+    bool filtered = true; // false while the command's output is its result
+
+    // Serializes whole lines from worker threads, whatever std::cout currently writes to
+    std::mutex outputMutex;
+
+    int64_t NowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool StartsWith(const std::string& str, const char* prefix)
+    {
+        return str.compare(0, std::char_traits<char>::length(prefix), prefix) == 0;
+    }
+
+    // Collects whole lines and forwards the ones the verbosity keeps to the real stdout
+    class ConsoleBuffer : public std::streambuf
+    {
+    public:
+        ConsoleBuffer(std::streambuf* target, bool terminal)
+            : m_target(target), m_terminal(terminal)
+        {
+        }
+
+        ~ConsoleBuffer() override
+        {
+            if (!m_line.empty())
+                EmitLine();
+            ClearStatus();
+            m_target->pubsync();
+        }
+
+        bool IsTerminal() const { return m_terminal; }
+        std::streambuf* Target() const { return m_target; }
+
+        // Redraws the progress line in place; the next message erases it first
+        void DrawStatus(const std::string& text)
+        {
+            std::string out = "\r" + text;
+            if (text.size() < m_statusWidth)
+                out.append(m_statusWidth - text.size(), ' ');
+            m_statusWidth = text.size();
+            m_target->sputn(out.data(), (std::streamsize)out.size());
+            m_target->pubsync();
+        }
+
+        void ClearStatus()
+        {
+            if (m_statusWidth == 0)
+                return;
+            const std::string out = "\r" + std::string(m_statusWidth, ' ') + "\r";
+            m_target->sputn(out.data(), (std::streamsize)out.size());
+            m_statusWidth = 0;
+        }
+
+    protected:
+        int overflow(int c) override
+        {
+            if (c == traits_type::eof())
+                return traits_type::not_eof(c);
+            const char ch = (char)c;
+            xsputn(&ch, 1);
+            return c;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            for (std::streamsize i = 0; i < n; ++i)
+            {
+                if (s[i] == '\n')
+                    EmitLine();
+                else
+                    m_line.push_back(s[i]);
+            }
+            return n;
+        }
+
+        // std::endl lands here; only a terminal is flushed
+        int sync() override
+        {
+            return m_terminal ? m_target->pubsync() : 0;
+        }
+
+    private:
+        std::streambuf* m_target;
+        bool m_terminal;
+        std::string m_line;
+        size_t m_statusWidth = 0;
+
+        void EmitLine()
+        {
+            const bool isError = StartsWith(m_line, "[ERR]");
+            const bool isWarning = StartsWith(m_line, "[WARNING]");
+            if (filtered && verbosity == Verbosity::Quiet && !isError && !isWarning)
+            {
+                m_line.clear();
+                return;
+            }
+
+            ClearStatus();
+            std::string out;
+            if (filtered && json && !StartsWith(m_line, "{\"event\":"))
+            {
+                out = "{\"event\":\"message\",\"level\":\"";
+                out += isError ? "error" : isWarning ? "warning" : "info";
+                out += "\",\"text\":" + JsonString(m_line) + "}\n";
+            }
+            else
+            {
+                out = m_line + "\n";
+            }
+            m_target->sputn(out.data(), (std::streamsize)out.size());
+            m_line.clear();
+        }
+    };
+
+    ConsoleBuffer* console = nullptr;
+
+    // The filter, if std::cout writes to it right now (a server request captures std::cout instead)
+    ConsoleBuffer* ActiveConsole()
+    {
+        return (console != nullptr && std::cout.rdbuf() == console) ? console : nullptr;
+    }
+
+    std::string FormatMB(uint64_t bytes)
+    {
+        std::ostringstream text;
+        text.setf(std::ios::fixed);
+        text.precision(1);
+        text << bytes / (1024.0 * 1024.0);
+        return text.str();
+    }
+}
+
+void ParseConsoleOptions(std::vector<std::string>& args)
+{
+    verbosity = Verbosity::Normal;
+    json = false;
+    const bool isList = !args.empty() && (args[0] == "-list" || args[0] == "--list");
+    // "--update -q" removes a library named q, so only the long forms are options there
+    const bool isUpdate = !args.empty() && (args[0] == "-update" || args[0] == "--update");
+    for (size_t i = 0; i < args.size();)
+    {
+        if (args[i] == "--quiet" || (!isUpdate && args[i] == "-q"))
+            verbosity = Verbosity::Quiet;
+        else if (args[i] == "--verbose" || (!isUpdate && args[i] == "-v"))
+            verbosity = Verbosity::Verbose;
+        else if (!isList && (args[i] == "--json" || (!isUpdate && args[i] == "-json")))
+            json = true;
+        else
+        {
+            ++i;
+            continue;
+        }
+        args.erase(args.begin() + i);
+    }
+
+    static const char* const results[] = { "-list", "--list", "-help", "--help", "-version", "--version",
+        "-setup", "--setup", "-complete", "--complete", "-completion", "--completion" };
+    filtered = !args.empty();
+    for (const char* result : results)
+    {
+        if (filtered && args[0] == result)
+            filtered = false;
+    }
+}
+
+void InstallConsoleFilter()
+{
+    static ConsoleBuffer buffer(std::cout.rdbuf(), STDOUT_IS_TERMINAL());
+    if (console != nullptr)
+        return;
+
+    console = &buffer;
+    std::cout.rdbuf(console);
+
+    // Restores std::cout before the buffer goes away at exit
+    static struct Restore
+    {
+        ~Restore() { std::cout.rdbuf(console->Target()); }
+    } restore;
+}
+
+Verbosity ConsoleVerbosity()
+{
+    return verbosity;
+}
+
+bool ConsoleJson()
+{
+    return json;
+}
+
+void VerboseLine(const std::string& line)
+{
+    if (verbosity != Verbosity::Verbose)
+        return;
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line + "\n";
+}
+
+Progress::Progress(const char* phase, uint64_t totalFiles, uint64_t totalBytes)
+    : m_phase(phase), m_totalFiles(totalFiles), m_totalBytes(totalBytes), m_start(NowMs())
+{
+    const ConsoleBuffer* active = ActiveConsole();
+    m_nextReport = m_start + ((active != nullptr && active->IsTerminal() && !json) ? TERMINAL_INTERVAL_MS : LOG_INTERVAL_MS);
+}
+
+Progress::~Progress()
+{
+    Finish();
+}
+
+void Progress::Advance(uint64_t bytes)
+{
+    m_files.fetch_add(1, std::memory_order_relaxed);
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    int64_t next = m_nextReport.load(std::memory_order_relaxed);
+    const int64_t now = NowMs();
+    if (now < next)
+        return;
+
+    // One thread reports, the others carry on copying
+    const ConsoleBuffer* active = ActiveConsole();
+    const int64_t interval = (active != nullptr && active->IsTerminal() && !json) ? TERMINAL_INTERVAL_MS : LOG_INTERVAL_MS;
+    if (m_nextReport.compare_exchange_strong(next, now + interval, std::memory_order_relaxed))
+        Report(false);
+}
+
+void Progress::Finish()
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    if (m_totalFiles > 0)
+        Report(true);
+}
+
+void Progress::Report(bool final)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (verbosity == Verbosity::Quiet && !json)
+        return;
+
+    const uint64_t files = m_files.load(std::memory_order_relaxed);
+    const uint64_t bytes = m_bytes.load(std::memory_order_relaxed);
+    const double seconds = std::max<int64_t>(1, NowMs() - m_start) / 1000.0;
+    const double rate = bytes / (1024.0 * 1024.0) / seconds;
+    const double eta = (bytes > 0 && m_totalBytes > bytes) ? (m_totalBytes - bytes) / (bytes / seconds) : 0.0;
+
+    std::ostringstream text;
+    text.setf(std::ios::fixed);
+    text.precision(1);
+    if (json)
+    {
+        text << "{\"event\":\"progress\",\"phase\":" << JsonString(m_phase) << ",\"files\":" << files << ",\"totalFiles\":" << m_totalFiles
+            << ",\"bytes\":" << bytes << ",\"totalBytes\":" << m_totalBytes << ",\"mbPerSecond\":" << rate
+            << ",\"etaSeconds\":" << eta << ",\"done\":" << (final ? "true" : "false") << "}\n";
+        std::cout << text.str();
+        return;
+    }
+
+    if (final)
+        text << "[" << m_phase << "] " << files << " files, " << FormatMB(bytes) << " MB in " << seconds << "s (" << rate << " MB/s)";
+    else
+        text << "[" << m_phase << "] " << files << "/" << m_totalFiles << " files, " << FormatMB(bytes) << "/" << FormatMB(m_totalBytes)
+            << " MB, " << rate << " MB/s, ETA " << eta << "s";
+
+    ConsoleBuffer* active = ActiveConsole();
+    if (!final && active != nullptr && active->IsTerminal())
+        active->DrawStatus(text.str());
+    else
+        std::cout << text.str() + "\n";
+}
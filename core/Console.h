@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Console output layer. Messages keep going through std::cout; InstallConsoleFilter() puts a line filter
+// in front of stdout that
+//  - applies the verbosity: -q keeps only [WARNING] and [ERR] lines, -v adds the VerboseLine() lines
+//  - turns every line into a JSON event with --json ({"event":"message","level":...,"text":...})
+//  - only flushes a terminal, so std::endl costs nothing when output goes to a file or CI log
+// Commands whose output is the result (--list, --help, --complete, ...) are never filtered.
+
+enum class Verbosity
+{
+	Quiet,
+	Normal,
+	Verbose
+};
+
+// Removes -q/--quiet, -v/--verbose and --json (unless it belongs to --list) from args and applies them.
+// After --update only the long forms count, since "-<Lib>" removes a library there.
+// Called once per command, so a server resets them for every request.
+void ParseConsoleOptions(std::vector<std::string>& args);
+void InstallConsoleFilter();
+
+Verbosity ConsoleVerbosity();
+bool ConsoleJson();
+
+// Writes line (without '\n') if -v is on. Thread-safe: the line is written whole and never interleaves
+// with a progress report.
+void VerboseLine(const std::string& line);
+
+// Progress of one phase, e.g. copying library files. On a terminal it redraws a single line
+// (files, bytes, MB/s, ETA) at most ten times a second; otherwise it logs a line every few seconds,
+// as a JSON event with --json. Advance() is thread-safe and costs two atomic adds between redraws.
+class Progress
+{
+public:
+	Progress(const char* phase, uint64_t totalFiles, uint64_t totalBytes);
+	~Progress();
+
+	Progress(const Progress&) = delete;
+	Progress& operator=(const Progress&) = delete;
+
+	// One file of the given size is done
+	void Advance(uint64_t bytes);
+	// Prints the summary line; called by the destructor if not before
+	void Finish();
+
+private:
+	const char* m_phase;
+	uint64_t m_totalFiles;
+	uint64_t m_totalBytes;
+	int64_t m_start;
+	std::atomic<uint64_t> m_files{ 0 };
+	std::atomic<uint64_t> m_bytes{ 0 };
+	std::atomic<int64_t> m_nextReport;
+	std::mutex m_mutex;
+	bool m_finished = false;
+
+	void Report(bool final);
+};
@@ -0,0 +1,426 @@
+#include "CopyPlan.h"
+
+#include "Console.h"
+#include "Crc32.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    constexpr const char* PARTIAL_SUFFIX = ".pg-partial";
+    constexpr const char* JOURNAL_HEADER = "premake-gen journal v1";
+
+    struct JournalEntry
+    {
+        uint64_t size = 0;
+        uint64_t check = 0;
+    };
+
+    // Files an interrupted run completed, by destination. False if there is no journal to resume from.
+    bool ReadJournal(const std::string& path, std::unordered_map<std::string, JournalEntry>& entries)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string line;
+        if (!std::getline(file, line) || line != JOURNAL_HEADER)
+            return false;
+
+        // "<size> <check> <destination>" per line
+        while (std::getline(file, line))
+        {
+            // The interruption can cut the last line short
+            if (file.eof())
+                break;
+
+            std::istringstream stream(line);
+            JournalEntry entry;
+            std::string destination;
+            if (!(stream >> entry.size >> std::hex >> entry.check) || stream.get() != ' ' || !std::getline(stream, destination))
+                continue;
+            entries[destination] = entry;
+        }
+        return true;
+    }
+}
+
+CopyPlan::CopyPlan(size_t bufferSize)
+    : m_bufferSize(bufferSize)
+{
+}
+
+uint32_t CopyPlan::AddLibrary(const std::string& name, const std::vector<std::string>& presentFiles)
+{
+    m_libraries.push_back({ name, { presentFiles.begin(), presentFiles.end() } });
+    return (uint32_t)m_libraries.size() - 1;
+}
+
+bool CopyPlan::AddZip(ZipArchive& zip, uint32_t root, const std::string& destination)
+{
+    std::string relativePath;
+    for (const uint32_t entry : zip.Subtree(root))
+    {
+        zip.RelativePath(entry, root, relativePath);
+        const ZipArchive::Entry& info = zip[entry];
+        if (!info.isFile)
+        {
+            m_directories.push_back(destination + "/" + relativePath);
+            continue;
+        }
+
+        File file;
+        file.destination = destination + "/" + relativePath;
+        file.archive = &zip;
+        file.entry = entry;
+        file.size = info.uncompressedSize;
+        file.crc32 = info.crc32;
+        file.hasCrc32 = true;
+        Add(std::move(file));
+    }
+    return true;
+}
+
+bool CopyPlan::AddFolder(const std::filesystem::path& root, const std::string& destination)
+{
+    try
+    {
+        for (const std::filesystem::directory_entry& dirEntry : std::filesystem::recursive_directory_iterator(root))
+        {
+            const std::string target = destination + "/" + dirEntry.path().lexically_relative(root).generic_u8string();
+            if (dirEntry.is_directory())
+            {
+                m_directories.push_back(target);
+                continue;
+            }
+
+            File file;
+            file.destination = target;
+            file.source = dirEntry.path().u8string();
+            file.size = dirEntry.file_size();
+            Add(std::move(file));
+        }
+    }
+    catch (std::exception&)
+    {
+        std::cout << "[ERR] Could not read files from: " << root << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CopyPlan::Add(File&& file)
+{
+    const uint32_t library = (uint32_t)m_libraries.size() - 1;
+    file.owners.push_back(library);
+    file.present = m_libraries[library].presentFiles.count(file.destination) > 0;
+
+    auto [iter, inserted] = m_byDestination.emplace(file.destination, m_files.size());
+    if (inserted)
+    {
+        m_files.push_back(std::move(file));
+        return;
+    }
+
+    File& existing = m_files[iter->second];
+    if (existing.size == file.size && Checksum(existing) && Checksum(file) && existing.crc32 == file.crc32)
+    {
+        if (std::find(existing.owners.begin(), existing.owners.end(), library) == existing.owners.end())
+            existing.owners.push_back(library);
+        existing.present = existing.present || file.present;
+        ++m_duplicates;
+        return;
+    }
+
+    // Same behavior as copying library after library: the later one wins
+    m_conflicts.push_back(file.destination + " differs between '" + m_libraries[existing.owners.front()].name +
+        "' and '" + m_libraries[library].name + "', using '" + m_libraries[library].name + "'");
+    existing = std::move(file);
+}
+
+bool CopyPlan::Checksum(File& file)
+{
+    if (file.hasCrc32)
+        return true;
+
+    std::ifstream input(file.source, std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    m_buffer.resize(m_bufferSize);
+    uint32_t crc = 0;
+    while (input)
+    {
+        input.read(m_buffer.data(), m_buffer.size());
+        const size_t got = (size_t)input.gcount();
+        if (got == 0)
+            break;
+        crc = Crc32(m_buffer.data(), got, crc);
+    }
+    if (input.bad())
+        return false;
+
+    file.crc32 = crc;
+    file.hasCrc32 = true;
+    return true;
+}
+
+const CopyPlan::File* CopyPlan::Find(const std::string& destination) const
+{
+    const auto found = m_byDestination.find(destination);
+    return found != m_byDestination.end() ? &m_files[found->second] : nullptr;
+}
+
+bool CopyPlan::ReadSource(const File& file, InflateSink sink, void* userData)
+{
+    if (file.archive != nullptr)
+        return file.archive->ExtractToSink(file.entry, sink, userData);
+
+    std::ifstream input(std::filesystem::u8path(file.source), std::ios::binary);
+    if (!input.is_open())
+        return false;
+    m_buffer.resize(m_bufferSize);
+    while (input)
+    {
+        input.read(m_buffer.data(), m_buffer.size());
+        const size_t got = (size_t)input.gcount();
+        if (got > 0 && !sink(reinterpret_cast<const uint8_t*>(m_buffer.data()), got, userData))
+            return false;
+    }
+    return !input.bad();
+}
+
+void CopyPlan::Remove(const std::unordered_set<std::string>& destinations)
+{
+    m_files.erase(std::remove_if(m_files.begin(), m_files.end(), [&](const File& file) { return destinations.count(file.destination) > 0; }), m_files.end());
+    m_byDestination.clear();
+    for (size_t i = 0; i < m_files.size(); ++i)
+        m_byDestination.emplace(m_files[i].destination, i);
+}
+
+std::vector<const CopyPlan::File*> CopyPlan::Schedule() const
+{
+    std::vector<const File*> files;
+    for (const File& file : m_files)
+    {
+        if (!file.present)
+            files.push_back(&file);
+    }
+    std::stable_sort(files.begin(), files.end(), [](const File* a, const File* b) { return a->size > b->size; });
+    return files;
+}
+
+uint64_t CopyPlan::JournalCheck(const File& file) const
+{
+    if (file.archive != nullptr)
+        return file.crc32;
+
+    std::error_code ec;
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(std::filesystem::u8path(file.source), ec);
+    return ec ? 0 : (uint64_t)time.time_since_epoch().count();
+}
+
+bool CopyPlan::Execute(const IoLimits& limits, const std::string& journalPath)
+{
+    std::unordered_map<std::string, JournalEntry> journaled;
+    const bool resuming = !journalPath.empty() && ReadJournal(journalPath, journaled);
+
+    // Files an interrupted run finished are kept as long as they are intact; its partial files are deleted
+    std::vector<const File*> files;
+    size_t resumed = 0;
+    for (const File* file : Schedule())
+    {
+        if (resuming)
+        {
+            std::error_code ec;
+            std::filesystem::remove(file->destination + PARTIAL_SUFFIX, ec);
+            const auto found = journaled.find(file->destination);
+            if (found != journaled.end() && found->second.size == file->size && found->second.check == JournalCheck(*file) &&
+                std::filesystem::file_size(file->destination, ec) == file->size && !ec)
+            {
+                ++resumed;
+                continue;
+            }
+        }
+        files.push_back(file);
+    }
+    if (resumed > 0)
+        std::cout << "Resuming an interrupted copy: " << resumed << " files are already in place\n";
+
+    std::ofstream journal;
+    std::mutex journalMutex;
+    if (!journalPath.empty())
+    {
+        journal.open(journalPath, std::ios::binary | (resuming ? std::ios::app : std::ios::trunc));
+        if (!resuming)
+            journal << JOURNAL_HEADER << '\n' << std::flush;
+        if (!journal)
+        {
+            std::cout << "[ERR] Could not write the copy journal: " << journalPath << std::endl;
+            return false;
+        }
+    }
+
+    // Create every directory up front, so workers only write files
+    std::vector<std::string> directories = m_directories;
+    for (const File* file : files)
+        directories.push_back(std::filesystem::path(file->destination).parent_path().generic_u8string());
+    std::sort(directories.begin(), directories.end());
+    directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+    for (const std::string& directory : directories)
+    {
+        std::error_code ec;
+        if (!directory.empty() && !std::filesystem::create_directories(directory, ec) && ec)
+        {
+            std::cout << "[ERR] Could not create directory: " << directory << std::endl;
+            return false;
+        }
+    }
+
+    // The calling thread extracts through the planned archives, every other worker opens its own handles
+    std::vector<char> failed(files.size(), 0);
+    std::atomic<size_t> next{ 0 };
+    uint64_t totalBytes = 0;
+    for (const File* file : files)
+        totalBytes += file->size;
+    Progress progress("copy", files.size(), totalBytes);
+    const bool verbose = ConsoleVerbosity() == Verbosity::Verbose;
+
+    // With a journal a file only appears under its name once it is complete, and is recorded right after
+    auto finish = [&](const File& file)
+    {
+        progress.Advance(file.size);
+        if (verbose)
+            VerboseLine("  " + file.destination + " (" + std::to_string(file.size) + " bytes)");
+        if (!journal.is_open())
+            return true;
+
+        std::error_code ec;
+        std::filesystem::rename(file.destination + PARTIAL_SUFFIX, file.destination, ec);
+        if (ec)
+            return false;
+        std::lock_guard<std::mutex> lock(journalMutex);
+        journal << file.size << ' ' << std::hex << JournalCheck(file) << std::dec << ' ' << file.destination << '\n' << std::flush;
+        return (bool)journal;
+    };
+
+    auto worker = [&](bool ownArchives)
+    {
+        std::unordered_map<const ZipArchive*, std::unique_ptr<ZipArchive>> archives;
+        for (size_t i = next++; i < files.size(); i = next++)
+        {
+            const File& file = *files[i];
+            const std::string target = journal.is_open() ? file.destination + PARTIAL_SUFFIX : file.destination;
+            if (file.archive == nullptr)
+            {
+                std::error_code ec;
+                failed[i] = !std::filesystem::copy_file(file.source, target, std::filesystem::copy_options::overwrite_existing, ec) || !finish(file);
+                continue;
+            }
+
+            ZipArchive* archive = file.archive;
+            if (ownArchives)
+            {
+                std::unique_ptr<ZipArchive>& own = archives[file.archive];
+                if (own == nullptr)
+                {
+                    own = std::make_unique<ZipArchive>(file.archive->FilePath());
+                    own->SetBufferSize(limits.bufferSize);
+                }
+                archive = own.get();
+            }
+            failed[i] = !archive->ExtractToFile(file.entry, target) || !finish(file);
+        }
+    };
+
+    const size_t threadCount = std::max<size_t>(1, std::min({ (size_t)std::thread::hardware_concurrency(), files.size(), limits.MaxStreams() }));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker, true);
+    worker(false);
+    for (std::thread& thread : threads)
+        thread.join();
+    progress.Finish();
+
+    bool ok = true;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (!failed[i])
+            continue;
+        const File& file = *files[i];
+        std::error_code ec;
+        if (journal.is_open())
+            std::filesystem::remove(file.destination + PARTIAL_SUFFIX, ec);
+        std::cout << "[ERR] Could not copy " << ((file.archive != nullptr) ? file.archive->FilePath() + "/" + file.archive->PathOf(file.entry) : file.source)
+            << " to " << file.destination << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+void CopyPlan::PrintConflicts() const
+{
+    for (const std::string& conflict : m_conflicts)
+        std::cout << "[WARNING] " << conflict << '\n';
+}
+
+void CopyPlan::Print() const
+{
+    std::cout << "\nCopy plan, largest files first:\n";
+    std::cout << "----------------------------------------------------------------------\n";
+    for (const File* file : Schedule())
+        std::cout << std::setw(12) << file->size << "  " << file->destination << "  [" << m_libraries[file->owners.front()].name << "]\n";
+    std::cout << "----------------------------------------------------------------------\n";
+    std::cout << FileCount() << " files, " << TotalBytes() << " bytes (" << m_duplicates << " identical duplicates skipped, "
+        << m_conflicts.size() << " conflicts)\n";
+}
+
+std::vector<std::string> CopyPlan::FilesOf(uint32_t library) const
+{
+    std::vector<std::string> files;
+    for (const File& file : m_files)
+    {
+        if (std::find(file.owners.begin(), file.owners.end(), library) != file.owners.end())
+            files.push_back(file.destination);
+    }
+    return files;
+}
+
+void CopyPlan::VerifyJobs(std::vector<VerifyJob>& jobs) const
+{
+    for (const File& file : m_files)
+    {
+        VerifyJob& job = jobs.emplace_back();
+        job.destination = file.destination;
+        if (file.archive != nullptr)
+        {
+            job.crc32 = file.crc32;
+            job.size = file.size;
+        }
+        else
+        {
+            job.source = file.source;
+        }
+    }
+}
+
+size_t CopyPlan::FileCount() const
+{
+    size_t count = 0;
+    for (const File& file : m_files)
+        count += file.present ? 0 : 1;
+    return count;
+}
+
+uint64_t CopyPlan::TotalBytes() const
+{
+    uint64_t bytes = 0;
+    for (const File& file : m_files)
+        bytes += file.present ? 0 : file.size;
+    return bytes;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "IoLimits.h"
+#include "Verify.h"
+#include "ZipArchive.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Written next to premake-gen.lock while library files are copied, removed once the run completes
+#define COPY_JOURNAL_NAME "premake-gen.journal"
+
+// Every library file a generation or update copies, planned before anything is written.
+//
+// Libraries are added in command-line order. A destination provided by more than one library is
+// written once: byte-identical files (same size and CRC-32) are shared by those libraries, real
+// conflicts are reported and the later library wins. Execution copies the largest files first
+// across a pool of streams so a big .lib doesn't end up alone on the last thread.
+//
+// With a journal, each file is written to "<destination>.pg-partial" and renamed into place, then
+// recorded with its size and checksum (CRC-32 for ZIP entries, the source's modification time for
+// folder files). If a run is interrupted, the next Execute with the same journal skips every recorded
+// file that is still intact and deletes the partial files the interrupted run left behind.
+class CopyPlan
+{
+public:
+	struct File
+	{
+		std::string destination;
+		std::string source;                 // file path for folder libraries
+		ZipArchive* archive = nullptr;      // zip libraries: the archive and entry to extract
+		uint32_t entry = ZipArchive::npos;
+		uint64_t size = 0;
+		uint32_t crc32 = 0;
+		bool hasCrc32 = false;
+		std::vector<uint32_t> owners;       // libraries that ship this exact content, the first one is copied
+		bool present = false;               // already in the workspace with this content
+	};
+
+	explicit CopyPlan(size_t bufferSize = 256 * 1024);
+
+	// Following Add calls belong to this library. presentFiles were copied from it before and are
+	// not written again, but still take part in duplicate and conflict detection.
+	uint32_t AddLibrary(const std::string& name, const std::vector<std::string>& presentFiles = {});
+	bool AddZip(ZipArchive& zip, uint32_t root, const std::string& destination);
+	bool AddFolder(const std::filesystem::path& root, const std::string& destination);
+
+	bool Execute(const IoLimits& limits, const std::string& journalPath = "");
+	void PrintConflicts() const;
+	void Print() const; // the plan and its totals, for --dry-run
+
+	// Destinations the library owns, in plan order
+	std::vector<std::string> FilesOf(uint32_t library) const;
+	const std::vector<File>& Files() const { return m_files; }
+	const File* Find(const std::string& destination) const; // nullptr if nothing is planned there
+	const std::string& LibraryName(uint32_t library) const { return m_libraries[library].name; }
+	// Streams the source of a planned file through sink (see ZipArchive::ExtractToSink); also false
+	// if the sink stopped the read early
+	bool ReadSource(const File& file, InflateSink sink, void* userData);
+	// Leaves these destinations out, e.g. DLLs nothing imports
+	void Remove(const std::unordered_set<std::string>& destinations);
+	void VerifyJobs(std::vector<VerifyJob>& jobs) const;
+
+	size_t FileCount() const;   // files to write
+	uint64_t TotalBytes() const;
+
+private:
+	struct Library
+	{
+		std::string name;
+		std::unordered_set<std::string> presentFiles;
+	};
+
+	std::vector<Library> m_libraries;
+	std::vector<File> m_files;
+	std::vector<std::string> m_directories;
+	std::unordered_map<std::string, size_t> m_byDestination;
+	std::vector<char> m_buffer;
+	std::vector<std::string> m_conflicts;
+	size_t m_bufferSize;
+	size_t m_duplicates = 0;
+
+	void Add(File&& file);
+	uint64_t JournalCheck(const File& file) const;
+	bool Checksum(File& file);
+	std::vector<const File*> Schedule() const;
+};
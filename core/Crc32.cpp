@@ -0,0 +1,201 @@
+#include "Crc32.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CRC32_PCLMUL
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CRC32_TARGET
+#else
+#include <cpuid.h>
+#define CRC32_TARGET __attribute__((target("sse2,pclmul")))
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define CRC32_ARM
+#include <arm_acle.h>
+#include <cstring>
+#endif
+
+namespace
+{
+    // Slice-by-8 tables: table[k][i] is the CRC of byte i followed by k zero bytes
+    struct Crc32Tables
+    {
+        uint32_t table[8][256];
+
+        Crc32Tables()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+                table[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                for (int k = 1; k < 8; ++k)
+                    table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    };
+
+    const Crc32Tables tables;
+
+    // All kernels work on the inverted CRC register
+    uint32_t Crc32Slice8(const uint8_t* p, size_t size, uint32_t crc)
+    {
+        while (size >= 8)
+        {
+            const uint32_t low = (uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24)) ^ crc;
+            crc = tables.table[7][low & 0xFF] ^
+                tables.table[6][(low >> 8) & 0xFF] ^
+                tables.table[5][(low >> 16) & 0xFF] ^
+                tables.table[4][low >> 24] ^
+                tables.table[3][p[4]] ^
+                tables.table[2][p[5]] ^
+                tables.table[1][p[6]] ^
+                tables.table[0][p[7]];
+            p += 8;
+            size -= 8;
+        }
+        while (size-- > 0)
+            crc = (crc >> 8) ^ tables.table[0][(crc ^ *p++) & 0xFF];
+        return crc;
+    }
+
+#ifdef CRC32_PCLMUL
+    bool HasPclmul()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 1)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL) != 0;
+#endif
+    }
+
+    // Carry-less multiply folding ("Fast CRC Computation for Generic Polynomials Using PCLMULQDQ",
+    // Intel 2009) with the bit-reflected constants for the ZIP polynomial. size must be a
+    // multiple of 16 and at least 64.
+    CRC32_TARGET uint32_t Crc32Pclmul(const uint8_t* p, size_t size, uint32_t crc)
+    {
+        alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+        alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+        alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+        alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+        __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+        __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+        __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+        __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+        __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+        p += 64;
+        size -= 64;
+
+        // Four independent 128-bit lanes hide the multiply latency
+        while (size >= 64)
+        {
+            const __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+            const __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+            const __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+            const __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00)));
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10)));
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20)));
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30)));
+            p += 64;
+            size -= 64;
+        }
+
+        // Fold the lanes into one, then any remaining 16 byte blocks
+        k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+        __m128i low = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x2), low);
+        low = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x3), low);
+        low = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x4), low);
+        while (size >= 16)
+        {
+            low = _mm_clmulepi64_si128(x1, k, 0x00);
+            x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), low);
+            p += 16;
+            size -= 16;
+        }
+
+        // 128 -> 64 bits
+        const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+        k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2);
+
+        // Barrett reduction to 32 bits
+        k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+        x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), k, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+        return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+    }
+
+    const bool hasPclmul = HasPclmul();
+#endif // CRC32_PCLMUL
+
+#ifdef CRC32_ARM
+    uint32_t Crc32Arm(const uint8_t* p, size_t size, uint32_t crc)
+    {
+        while (size >= 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            crc = __crc32d(crc, word);
+            p += 8;
+            size -= 8;
+        }
+        while (size-- > 0)
+            crc = __crc32b(crc, *p++);
+        return crc;
+    }
+#endif // CRC32_ARM
+}
+
+uint32_t Crc32(const void* data, size_t size, uint32_t crc)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+#if defined(CRC32_PCLMUL)
+    if (hasPclmul && size >= 64)
+    {
+        const size_t blocks = size & ~size_t(15);
+        crc = Crc32Pclmul(p, blocks, crc);
+        p += blocks;
+        size -= blocks;
+    }
+#elif defined(CRC32_ARM)
+    return ~Crc32Arm(p, size, crc);
+#endif
+
+    return ~Crc32Slice8(p, size, crc);
+}
+
+const char* Crc32Implementation()
+{
+#if defined(CRC32_PCLMUL)
+    return hasPclmul ? "pclmul" : "slice-by-8";
+#elif defined(CRC32_ARM)
+    return "armv8-crc";
+#else
+    return "slice-by-8";
+#endif
+}
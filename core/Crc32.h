@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (ISO-HDLC, as used by ZIP). Pass the previous result as crc to continue a running checksum.
+// Uses carry-less multiplication (PCLMULQDQ) or the ARMv8 CRC instructions when available and
+// falls back to slice-by-8 tables.
+uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// Name of the implementation Crc32() dispatches to on this machine
+const char* Crc32Implementation();
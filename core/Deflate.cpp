@@ -0,0 +1,548 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <queue>
+
+namespace
+{
+    constexpr size_t WINDOW_SIZE = 32768;
+    constexpr size_t BUFFER_SIZE = WINDOW_SIZE * 8;
+    constexpr uint32_t MIN_MATCH = 3;
+    constexpr uint32_t MAX_MATCH = 258;
+    constexpr uint32_t HASH_BITS = 15;
+    constexpr uint32_t HASH_SIZE = 1u << HASH_BITS;
+    constexpr uint32_t MAX_CHAIN = 128;
+    constexpr uint32_t NICE_LENGTH = 128;
+    constexpr uint32_t LAZY_LENGTH = 32;
+    constexpr size_t MAX_TOKENS = 16384;
+    constexpr size_t OUTPUT_SIZE = 64 * 1024;
+
+    const uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    const uint8_t CODE_LENGTH_ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    struct SymbolTables
+    {
+        uint8_t lengthSymbol[MAX_MATCH + 1];        // match length -> length code - 257
+        uint8_t distanceSymbol[WINDOW_SIZE + 1];    // distance -> distance code
+        uint8_t fixedLiteralLengths[288];
+        uint8_t fixedDistanceLengths[30];
+
+        SymbolTables()
+        {
+            for (uint32_t code = 0; code < 29; ++code)
+            {
+                const uint32_t end = (code == 28) ? MAX_MATCH + 1 : LENGTH_BASE[code + 1];
+                for (uint32_t len = LENGTH_BASE[code]; len < end; ++len)
+                    lengthSymbol[len] = (uint8_t)code;
+            }
+
+            for (uint32_t code = 0; code < 30; ++code)
+            {
+                const uint32_t end = (code == 29) ? WINDOW_SIZE + 1 : DIST_BASE[code + 1];
+                for (uint32_t dist = DIST_BASE[code]; dist < end; ++dist)
+                    distanceSymbol[dist] = (uint8_t)code;
+            }
+
+            std::fill(fixedLiteralLengths, fixedLiteralLengths + 144, (uint8_t)8);
+            std::fill(fixedLiteralLengths + 144, fixedLiteralLengths + 256, (uint8_t)9);
+            std::fill(fixedLiteralLengths + 256, fixedLiteralLengths + 280, (uint8_t)7);
+            std::fill(fixedLiteralLengths + 280, fixedLiteralLengths + 288, (uint8_t)8);
+            std::fill(fixedDistanceLengths, fixedDistanceLengths + 30, (uint8_t)5);
+        }
+    };
+
+    const SymbolTables& Tables()
+    {
+        static const SymbolTables tables;
+        return tables;
+    }
+
+    // Huffman code lengths limited to maxLength. Frequencies are flattened until the tree fits.
+    void BuildLengths(const uint32_t* frequencies, uint32_t count, uint32_t maxLength, uint8_t* lengths)
+    {
+        std::fill(lengths, lengths + count, (uint8_t)0);
+        std::vector<uint32_t> weights(frequencies, frequencies + count);
+
+        std::vector<uint32_t> symbols;
+        for (uint32_t s = 0; s < count; ++s)
+        {
+            if (weights[s] != 0)
+                symbols.push_back(s);
+        }
+        if (symbols.empty())
+            return;
+        if (symbols.size() == 1)
+        {
+            lengths[symbols[0]] = 1;
+            return;
+        }
+
+        using Item = std::pair<uint64_t, uint32_t>;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> depth;
+        for (;;)
+        {
+            const uint32_t leaves = (uint32_t)symbols.size();
+            parent.assign(leaves * 2 - 1, 0);
+            std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+            for (uint32_t i = 0; i < leaves; ++i)
+                heap.push({ weights[symbols[i]], i });
+
+            uint32_t next = leaves;
+            while (heap.size() > 1)
+            {
+                const Item a = heap.top();
+                heap.pop();
+                const Item b = heap.top();
+                heap.pop();
+                parent[a.second] = next;
+                parent[b.second] = next;
+                heap.push({ a.first + b.first, next++ });
+            }
+
+            // Parents are always created after their children, so walk from the root down
+            depth.assign(next, 0);
+            uint32_t deepest = 0;
+            for (uint32_t i = next - 1; i-- > 0;)
+            {
+                depth[i] = depth[parent[i]] + 1;
+                deepest = std::max(deepest, depth[i]);
+            }
+
+            if (deepest <= maxLength)
+            {
+                for (uint32_t i = 0; i < leaves; ++i)
+                    lengths[symbols[i]] = (uint8_t)depth[i];
+                return;
+            }
+            for (const uint32_t s : symbols)
+                weights[s] = (weights[s] >> 1) | 1;
+        }
+    }
+
+    // Canonical codes, bit-reversed so they can be written least significant bit first
+    void BuildCodes(const uint8_t* lengths, uint32_t count, uint16_t* codes)
+    {
+        uint32_t lengthCount[16] = {};
+        for (uint32_t s = 0; s < count; ++s)
+            ++lengthCount[lengths[s]];
+        lengthCount[0] = 0;
+
+        uint32_t nextCode[16] = {};
+        uint32_t code = 0;
+        for (uint32_t len = 1; len < 16; ++len)
+        {
+            code = (code + lengthCount[len - 1]) << 1;
+            nextCode[len] = code;
+        }
+        for (uint32_t s = 0; s < count; ++s)
+        {
+            const uint32_t len = lengths[s];
+            codes[s] = 0;
+            if (len == 0)
+                continue;
+            const uint32_t c = nextCode[len]++;
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < len; ++i)
+                reversed |= ((c >> i) & 1) << (len - 1 - i);
+            codes[s] = (uint16_t)reversed;
+        }
+    }
+
+    struct CodeLengthSymbol
+    {
+        uint8_t symbol;
+        uint8_t extra;
+    };
+
+    // Run-length encodes the literal/length and distance code lengths with symbols 16, 17 and 18
+    void EncodeCodeLengths(const uint8_t* lengths, uint32_t count, std::vector<CodeLengthSymbol>& out)
+    {
+        out.clear();
+        uint32_t i = 0;
+        while (i < count)
+        {
+            const uint8_t current = lengths[i];
+            uint32_t run = 1;
+            while (i + run < count && lengths[i + run] == current)
+                ++run;
+            i += run;
+
+            if (current == 0)
+            {
+                while (run >= 11)
+                {
+                    const uint32_t r = std::min<uint32_t>(run, 138);
+                    out.push_back({ 18, (uint8_t)(r - 11) });
+                    run -= r;
+                }
+                if (run >= 3)
+                {
+                    out.push_back({ 17, (uint8_t)(run - 3) });
+                    run = 0;
+                }
+            }
+            else
+            {
+                out.push_back({ current, 0 });
+                --run;
+                while (run >= 3)
+                {
+                    const uint32_t r = std::min<uint32_t>(run, 6);
+                    out.push_back({ 16, (uint8_t)(r - 3) });
+                    run -= r;
+                }
+            }
+            while (run-- > 0)
+                out.push_back({ current, 0 });
+        }
+    }
+
+    uint32_t CodeLengthExtraBits(uint8_t symbol)
+    {
+        return (symbol == 16) ? 2 : (symbol == 17) ? 3 : (symbol == 18) ? 7 : 0;
+    }
+}
+
+Deflater::Deflater()
+    : m_buffer(BUFFER_SIZE)
+    , m_head(HASH_SIZE)
+    , m_prev(BUFFER_SIZE)
+{
+    m_tokens.reserve(MAX_TOKENS);
+    m_output.reserve(OUTPUT_SIZE);
+}
+
+void Deflater::Begin(InflateSink sink, void* userData)
+{
+    std::fill(m_head.begin(), m_head.end(), -1);
+    m_tokens.clear();
+    m_output.clear();
+    m_end = 0;
+    m_pos = 0;
+    m_hashPos = 0;
+    m_blockStart = 0;
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+    m_totalIn = 0;
+    m_totalOut = 0;
+    m_sink = sink;
+    m_userData = userData;
+    m_failed = false;
+}
+
+bool Deflater::Write(const uint8_t* data, size_t size)
+{
+    while (size > 0 && !m_failed)
+    {
+        if (m_end == BUFFER_SIZE)
+        {
+            Compress(false);
+            Slide();
+        }
+        const size_t chunk = std::min(size, BUFFER_SIZE - m_end);
+        std::memcpy(m_buffer.data() + m_end, data, chunk);
+        m_end += chunk;
+        m_totalIn += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return !m_failed;
+}
+
+bool Deflater::Finish()
+{
+    Compress(true);
+    EmitBlock(true);
+    AlignToByte();
+    FlushOutput();
+    return !m_failed;
+}
+
+void Deflater::Compress(bool finishing)
+{
+    const size_t limit = finishing ? m_end : (m_end > MAX_MATCH ? m_end - MAX_MATCH : 0);
+    while (m_pos < limit && !m_failed)
+    {
+        uint32_t distance = 0;
+        const uint32_t length = FindMatch(m_pos, m_end, distance);
+
+        bool deferred = false;
+        if (length >= MIN_MATCH && length < LAZY_LENGTH && m_pos + 1 < limit)
+        {
+            uint32_t nextDistance = 0;
+            deferred = FindMatch(m_pos + 1, m_end, nextDistance) > length;
+        }
+
+        if (length >= MIN_MATCH && !deferred)
+        {
+            m_tokens.push_back({ (uint16_t)length, (uint16_t)distance });
+            m_pos += length;
+        }
+        else
+        {
+            m_tokens.push_back({ m_buffer[m_pos], 0 });
+            ++m_pos;
+        }
+
+        if (m_tokens.size() >= MAX_TOKENS)
+            EmitBlock(false);
+    }
+}
+
+void Deflater::InsertUpTo(size_t pos)
+{
+    for (; m_hashPos < pos; ++m_hashPos)
+    {
+        if (m_hashPos + MIN_MATCH > m_end)
+            continue;
+        const uint8_t* p = m_buffer.data() + m_hashPos;
+        const uint32_t hash = ((uint32_t(p[0]) << 10) ^ (uint32_t(p[1]) << 5) ^ p[2]) & (HASH_SIZE - 1);
+        m_prev[m_hashPos] = m_head[hash];
+        m_head[hash] = (int32_t)m_hashPos;
+    }
+}
+
+uint32_t Deflater::FindMatch(size_t pos, size_t limit, uint32_t& distance)
+{
+    InsertUpTo(pos);
+    if (pos + MIN_MATCH > limit)
+        return 0;
+
+    const uint8_t* data = m_buffer.data();
+    const uint32_t maxLength = (uint32_t)std::min<size_t>(MAX_MATCH, limit - pos);
+    const uint32_t hash = ((uint32_t(data[pos]) << 10) ^ (uint32_t(data[pos + 1]) << 5) ^ data[pos + 2]) & (HASH_SIZE - 1);
+
+    uint32_t best = 0;
+    uint32_t chain = MAX_CHAIN;
+    for (int32_t candidate = m_head[hash]; candidate >= 0 && chain-- > 0; candidate = m_prev[candidate])
+    {
+        if (pos - (size_t)candidate > WINDOW_SIZE)
+            break;
+        if (data[candidate + best] != data[pos + best])
+            continue;
+
+        uint32_t length = 0;
+        while (length < maxLength && data[candidate + length] == data[pos + length])
+            ++length;
+        if (length > best)
+        {
+            best = length;
+            distance = (uint32_t)(pos - candidate);
+            if (length >= NICE_LENGTH || length == maxLength)
+                break;
+        }
+    }
+    return best;
+}
+
+void Deflater::Slide()
+{
+    if (!m_tokens.empty())
+        EmitBlock(false);
+
+    const size_t shift = m_pos - WINDOW_SIZE;
+    std::memmove(m_buffer.data(), m_buffer.data() + shift, m_end - shift);
+    m_end -= shift;
+    m_pos -= shift;
+    m_blockStart -= shift;
+    m_hashPos = (m_hashPos > shift) ? m_hashPos - shift : 0;
+
+    for (int32_t& head : m_head)
+        head = (head >= (int32_t)shift) ? head - (int32_t)shift : -1;
+    for (size_t i = 0; i < m_end; ++i)
+    {
+        const int32_t prev = m_prev[i + shift];
+        m_prev[i] = (prev >= (int32_t)shift) ? prev - (int32_t)shift : -1;
+    }
+}
+
+void Deflater::EmitBlock(bool last)
+{
+    const SymbolTables& tables = Tables();
+
+    uint32_t literalFrequencies[286] = {};
+    uint32_t distanceFrequencies[30] = {};
+    uint64_t extraBits = 0;
+    for (const Token& token : m_tokens)
+    {
+        if (token.distance == 0)
+        {
+            ++literalFrequencies[token.value];
+            continue;
+        }
+        const uint8_t lengthCode = tables.lengthSymbol[token.value];
+        const uint8_t distanceCode = tables.distanceSymbol[token.distance];
+        ++literalFrequencies[257 + lengthCode];
+        ++distanceFrequencies[distanceCode];
+        extraBits += LENGTH_EXTRA[lengthCode] + DIST_EXTRA[distanceCode];
+    }
+    literalFrequencies[256] = 1;
+
+    uint8_t lengths[286 + 30];
+    uint8_t* literalLengths = lengths;
+    uint8_t* distanceLengths = lengths + 286;
+    BuildLengths(literalFrequencies, 286, 15, literalLengths);
+    BuildLengths(distanceFrequencies, 30, 15, distanceLengths);
+    if (std::all_of(distanceLengths, distanceLengths + 30, [](uint8_t l) { return l == 0; }))
+        distanceLengths[0] = 1;
+
+    uint32_t literalCount = 286;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0)
+        --literalCount;
+    uint32_t distanceCount = 30;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0)
+        --distanceCount;
+
+    // Code lengths are sent back to back, so pack them before run-length encoding
+    uint8_t packed[286 + 30];
+    std::memcpy(packed, literalLengths, literalCount);
+    std::memcpy(packed + literalCount, distanceLengths, distanceCount);
+    std::vector<CodeLengthSymbol> codeLengthSymbols;
+    EncodeCodeLengths(packed, literalCount + distanceCount, codeLengthSymbols);
+
+    uint32_t codeLengthFrequencies[19] = {};
+    for (const CodeLengthSymbol& s : codeLengthSymbols)
+        ++codeLengthFrequencies[s.symbol];
+    uint8_t codeLengthLengths[19];
+    BuildLengths(codeLengthFrequencies, 19, 7, codeLengthLengths);
+    uint32_t codeLengthCount = 19;
+    while (codeLengthCount > 4 && codeLengthLengths[CODE_LENGTH_ORDER[codeLengthCount - 1]] == 0)
+        --codeLengthCount;
+
+    // Pick the cheapest encoding for this block
+    uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount + extraBits;
+    for (const CodeLengthSymbol& s : codeLengthSymbols)
+        dynamicBits += codeLengthLengths[s.symbol] + CodeLengthExtraBits(s.symbol);
+    uint64_t fixedBits = 3 + extraBits;
+    for (uint32_t s = 0; s < 286; ++s)
+    {
+        dynamicBits += uint64_t(literalFrequencies[s]) * literalLengths[s];
+        fixedBits += uint64_t(literalFrequencies[s]) * tables.fixedLiteralLengths[s];
+    }
+    for (uint32_t s = 0; s < 30; ++s)
+    {
+        dynamicBits += uint64_t(distanceFrequencies[s]) * distanceLengths[s];
+        fixedBits += uint64_t(distanceFrequencies[s]) * tables.fixedDistanceLengths[s];
+    }
+    const uint64_t rawBytes = m_pos - m_blockStart;
+    const uint64_t storedBits = (rawBytes + 5 * (rawBytes / 65535 + 1)) * 8 + 7;
+
+    if (storedBits <= std::min(dynamicBits, fixedBits))
+    {
+        EmitStored(last);
+    }
+    else
+    {
+        const bool useFixed = fixedBits <= dynamicBits;
+        const uint8_t* useLiteralLengths = useFixed ? tables.fixedLiteralLengths : literalLengths;
+        const uint8_t* useDistanceLengths = useFixed ? tables.fixedDistanceLengths : distanceLengths;
+        uint16_t literalCodes[288];
+        uint16_t distanceCodes[30];
+        BuildCodes(useLiteralLengths, useFixed ? 288 : 286, literalCodes);
+        BuildCodes(useDistanceLengths, 30, distanceCodes);
+
+        PutBits(last ? 1 : 0, 1);
+        PutBits(useFixed ? 1 : 2, 2);
+        if (!useFixed)
+        {
+            uint16_t codeLengthCodes[19];
+            BuildCodes(codeLengthLengths, 19, codeLengthCodes);
+            PutBits(literalCount - 257, 5);
+            PutBits(distanceCount - 1, 5);
+            PutBits(codeLengthCount - 4, 4);
+            for (uint32_t i = 0; i < codeLengthCount; ++i)
+                PutBits(codeLengthLengths[CODE_LENGTH_ORDER[i]], 3);
+            for (const CodeLengthSymbol& s : codeLengthSymbols)
+            {
+                PutBits(codeLengthCodes[s.symbol], codeLengthLengths[s.symbol]);
+                PutBits(s.extra, CodeLengthExtraBits(s.symbol));
+            }
+        }
+
+        for (const Token& token : m_tokens)
+        {
+            if (token.distance == 0)
+            {
+                PutBits(literalCodes[token.value], useLiteralLengths[token.value]);
+                continue;
+            }
+            const uint8_t lengthCode = tables.lengthSymbol[token.value];
+            PutBits(literalCodes[257 + lengthCode], useLiteralLengths[257 + lengthCode]);
+            PutBits(token.value - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+            const uint8_t distanceCode = tables.distanceSymbol[token.distance];
+            PutBits(distanceCodes[distanceCode], useDistanceLengths[distanceCode]);
+            PutBits(token.distance - DIST_BASE[distanceCode], DIST_EXTRA[distanceCode]);
+        }
+        PutBits(literalCodes[256], useLiteralLengths[256]);
+    }
+
+    m_tokens.clear();
+    m_blockStart = m_pos;
+}
+
+void Deflater::EmitStored(bool last)
+{
+    size_t pos = m_blockStart;
+    do
+    {
+        const size_t chunk = std::min<size_t>(m_pos - pos, 65535);
+        const bool final = last && (pos + chunk == m_pos);
+        PutBits(final ? 1 : 0, 1);
+        PutBits(0, 2);
+        AlignToByte();
+        PutBits((uint32_t)chunk, 16);
+        PutBits((uint32_t)(~chunk & 0xFFFF), 16);
+        for (size_t i = 0; i < chunk; ++i)
+        {
+            m_output.push_back(m_buffer[pos + i]);
+            if (m_output.size() >= OUTPUT_SIZE)
+                FlushOutput();
+        }
+        pos += chunk;
+    } while (pos < m_pos);
+}
+
+void Deflater::PutBits(uint32_t value, uint32_t count)
+{
+    m_bitBuffer |= uint64_t(value) << m_bitCount;
+    m_bitCount += count;
+    while (m_bitCount >= 8)
+    {
+        m_output.push_back((uint8_t)m_bitBuffer);
+        m_bitBuffer >>= 8;
+        m_bitCount -= 8;
+    }
+    if (m_output.size() >= OUTPUT_SIZE)
+        FlushOutput();
+}
+
+void Deflater::AlignToByte()
+{
+    if (m_bitCount % 8 != 0)
+        PutBits(0, 8 - m_bitCount % 8);
+}
+
+void Deflater::FlushOutput()
+{
+    if (m_output.empty())
+        return;
+    if (!m_failed && !m_sink(m_output.data(), m_output.size(), m_userData))
+        m_failed = true;
+    m_totalOut += m_output.size();
+    m_output.clear();
+}
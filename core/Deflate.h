@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Inflate.h"
+
+#include <cstdint>
+#include <vector>
+
+// Streaming raw DEFLATE (RFC 1951) encoder.
+// Uses hash-chain LZ77 with one step of lazy matching and picks the cheapest of
+// stored, fixed and dynamic Huffman coding for every block.
+class Deflater
+{
+public:
+	Deflater();
+
+	void Begin(InflateSink sink, void* userData = nullptr);
+	bool Write(const uint8_t* data, size_t size);
+	bool Finish();
+
+	uint64_t TotalIn() const { return m_totalIn; }
+	uint64_t TotalOut() const { return m_totalOut; }
+
+private:
+	struct Token
+	{
+		uint16_t value;     // literal byte, or match length when distance != 0
+		uint16_t distance;
+	};
+
+	std::vector<uint8_t> m_buffer;  // 32KB history followed by pending input
+	std::vector<int32_t> m_head;
+	std::vector<int32_t> m_prev;
+	std::vector<Token> m_tokens;
+	std::vector<uint8_t> m_output;
+
+	size_t m_end = 0;           // end of valid data in m_buffer
+	size_t m_pos = 0;           // next position to encode
+	size_t m_hashPos = 0;       // next position to insert into the hash chains
+	size_t m_blockStart = 0;    // first byte covered by m_tokens
+
+	uint64_t m_bitBuffer = 0;
+	uint32_t m_bitCount = 0;
+	uint64_t m_totalIn = 0;
+	uint64_t m_totalOut = 0;
+	InflateSink m_sink = nullptr;
+	void* m_userData = nullptr;
+	bool m_failed = false;
+
+	void Compress(bool finishing);
+	void InsertUpTo(size_t pos);
+	uint32_t FindMatch(size_t pos, size_t limit, uint32_t& distance);
+	void Slide();
+
+	void EmitBlock(bool last);
+	void EmitStored(bool last);
+	void PutBits(uint32_t value, uint32_t count);
+	void AlignToByte();
+	void FlushOutput();
+};
@@ -5,8 +5,8 @@ void HowTo()
     std::cout << R"(
 Premake Generator -- How to Setup a Library
 ----------------------------------------------------------------------
-1. Build your libraries - This tool only works with built
-   Static (.lib) and Dynamic (.dll) Libraries
+1. Build your libraries - This tool works with built Static (.lib)
+   and Dynamic (.dll) Libraries, or with library sources (see 9.)
 2. If using for the first time, Set a location for your libraies using 
    the  "--libdir <directory>" flag.
    Example > premake-gen --libdir "C:\premake-gen\libraries"
@@ -34,8 +34,14 @@ Premake Generator -- How to Setup a Library
        sub-directories that are not %{prj.name}/include
     e. @additionalLibDirs - list library file directories/
        sub-directories that are not %{prj.name}/lib
+    f. @modules - public headers (relative to "include") that the
+       library's C++20 module re-exports with "-modules"
 8. Place an example main file into the library folder/ZIP file named
    "main.cpp"
+9. Libraries in source form: place their sources into a "src" folder
+   (public headers still go into "include"). They are copied to
+   "libs/<LibName>/src" and built as a separate static library
+   project that the main project links.
 ----------------------------------------------------------------------
 )";
 }
\ No newline at end of file
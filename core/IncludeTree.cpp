@@ -0,0 +1,108 @@
+#include "IncludeTree.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    bool SameContent(const std::filesystem::path& a, const std::filesystem::path& b)
+    {
+        std::error_code ec;
+        if (std::filesystem::equivalent(a, b, ec))
+            return true;
+        if (std::filesystem::file_size(a, ec) != std::filesystem::file_size(b, ec) || ec)
+            return false;
+
+        std::ifstream fileA(a, std::ios::binary);
+        std::ifstream fileB(b, std::ios::binary);
+        char bufferA[4096];
+        char bufferB[4096];
+        while (fileA && fileB)
+        {
+            fileA.read(bufferA, sizeof(bufferA));
+            fileB.read(bufferB, sizeof(bufferB));
+            if (fileA.gcount() != fileB.gcount() || !std::equal(bufferA, bufferA + fileA.gcount(), bufferB))
+                return false;
+        }
+        return fileA.eof() && fileB.eof();
+    }
+
+    bool LinkOrCopy(const std::filesystem::path& source, const std::filesystem::path& destination)
+    {
+        std::error_code ec;
+        if (std::filesystem::exists(destination, ec))
+        {
+            if (std::filesystem::equivalent(source, destination, ec))
+                return true;
+            // A copy from an earlier run (no hard links on this drive) that still matches
+            if (std::filesystem::file_size(source, ec) == std::filesystem::file_size(destination, ec) && !ec &&
+                std::filesystem::last_write_time(source, ec) == std::filesystem::last_write_time(destination, ec) && !ec)
+                return true;
+            std::filesystem::remove(destination, ec);
+        }
+
+        std::filesystem::create_directories(destination.parent_path(), ec);
+        std::filesystem::create_hard_link(source, destination, ec);
+        if (!ec)
+            return true;
+
+        ec.clear();
+        std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec)
+            return false;
+        std::filesystem::last_write_time(destination, std::filesystem::last_write_time(source, ec), ec);
+        return true;
+    }
+}
+
+bool BuildIncludeTree(const std::vector<std::string>& sources, const std::string& root, std::vector<IncludeCollision>& collisions)
+{
+    struct Provider
+    {
+        size_t source;
+        std::filesystem::path file;
+    };
+
+    // First source wins, like the compiler's search
+    std::unordered_map<std::string, Provider> files;
+    std::vector<std::string> order;
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        const std::filesystem::path source = std::filesystem::u8path(sources[i]);
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator iter(source, ec), end; !ec && iter != end; iter.increment(ec))
+        {
+            if (!iter->is_regular_file(ec))
+                continue;
+
+            const std::string path = iter->path().lexically_relative(source).generic_u8string();
+            const auto [found, inserted] = files.try_emplace(path, Provider{ i, iter->path() });
+            if (inserted)
+                order.push_back(path);
+            else if (found->second.source != i && !SameContent(found->second.file, iter->path()))
+                collisions.push_back({ path, sources[found->second.source], sources[i] });
+        }
+    }
+
+    const std::filesystem::path rootPath = std::filesystem::u8path(root);
+    for (const std::string& path : order)
+    {
+        if (!LinkOrCopy(files.at(path).file, rootPath / std::filesystem::u8path(path)))
+            return false;
+    }
+
+    // Headers a library no longer ships would otherwise stay includable
+    std::error_code ec;
+    std::vector<std::filesystem::path> stale;
+    for (std::filesystem::recursive_directory_iterator iter(rootPath, ec), end; !ec && iter != end; iter.increment(ec))
+    {
+        if (iter->is_regular_file(ec) && files.find(iter->path().lexically_relative(rootPath).generic_u8string()) == files.end())
+            stale.push_back(iter->path());
+    }
+    for (const std::filesystem::path& file : stale)
+        std::filesystem::remove(file, ec);
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A header path that more than one include directory provides with different content
+struct IncludeCollision
+{
+	std::string path;       // '/' separated, relative to the include directories
+	std::string winner;     // directory the compiler finds it in first
+	std::string shadowed;   // directory whose copy is hidden
+};
+
+// Mirrors the files of sources into root so that the single directory root resolves every path the way
+// searching sources in order did: the first source that has a path wins. Files are hard linked where the
+// file system allows it and copied otherwise; links and unchanged copies already in root are kept, and
+// files no source provides any more are removed. Paths provided by several sources with different
+// content are reported in collisions.
+bool BuildIncludeTree(const std::vector<std::string>& sources, const std::string& root, std::vector<IncludeCollision>& collisions);
@@ -0,0 +1,445 @@
+#include "Inflate.h"
+
+#include <algorithm>
+#include <cstring>
+
+struct Inflater::Huffman
+{
+    static constexpr uint32_t FAST_BITS = 10;
+    static constexpr uint32_t FAST_MASK = (1u << FAST_BITS) - 1;
+
+    uint16_t count[16];             // number of codes of each length
+    uint16_t symbol[320];           // symbols ordered by code length, then value
+    uint16_t fast[1 << FAST_BITS];  // (symbol << 4) | length for short codes, 0 = use slow path
+
+    // Builds canonical codes from code lengths. Incomplete codes are allowed, over-subscribed are not.
+    bool Build(const uint8_t* lengths, uint32_t n)
+    {
+        std::memset(count, 0, sizeof(count));
+        std::memset(fast, 0, sizeof(fast));
+        for (uint32_t s = 0; s < n; ++s)
+            ++count[lengths[s]];
+        if (count[0] == n)
+            return true;
+
+        int left = 1;
+        for (uint32_t len = 1; len < 16; ++len)
+        {
+            left <<= 1;
+            left -= count[len];
+            if (left < 0)
+                return false;
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for (uint32_t len = 1; len < 15; ++len)
+            offsets[len + 1] = offsets[len] + count[len];
+        for (uint32_t s = 0; s < n; ++s)
+        {
+            if (lengths[s] != 0)
+                symbol[offsets[lengths[s]]++] = (uint16_t)s;
+        }
+
+        uint32_t nextCode[16];
+        uint32_t code = 0;
+        nextCode[0] = 0;
+        for (uint32_t len = 1; len < 16; ++len)
+        {
+            code = (code + ((len > 1) ? count[len - 1] : 0)) << 1;
+            nextCode[len] = code;
+        }
+        for (uint32_t s = 0; s < n; ++s)
+        {
+            const uint32_t len = lengths[s];
+            if (len == 0)
+                continue;
+            const uint32_t c = nextCode[len]++;
+            if (len > FAST_BITS)
+                continue;
+
+            // Deflate stores Huffman codes most significant bit first
+            uint32_t reversed = 0;
+            for (uint32_t i = 0; i < len; ++i)
+                reversed |= ((c >> i) & 1) << (len - 1 - i);
+            for (uint32_t j = reversed; j <= FAST_MASK; j += (1u << len))
+                fast[j] = (uint16_t)((s << 4) | len);
+        }
+        return true;
+    }
+};
+
+namespace
+{
+    const uint16_t LENGTH_BASE[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t LENGTH_EXTRA[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t DIST_BASE[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t DIST_EXTRA[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    const uint8_t CODE_LENGTH_ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+}
+
+Inflater::Inflater(size_t inputBufferSize)
+    : m_inputSize(std::max<size_t>(inputBufferSize, 1024))
+{
+}
+
+void Inflater::SetInputBufferSize(size_t inputBufferSize)
+{
+    inputBufferSize = std::max<size_t>(inputBufferSize, 1024);
+    if (inputBufferSize == m_inputSize)
+        return;
+    m_inputSize = inputBufferSize;
+    Release();
+}
+
+void Inflater::Release()
+{
+    m_input.clear();
+    m_input.shrink_to_fit();
+    m_window.clear();
+    m_window.shrink_to_fit();
+}
+
+void Inflater::Allocate()
+{
+    if (m_input.size() != m_inputSize)
+        m_input.resize(m_inputSize);
+    if (m_window.size() != WINDOW_SIZE)
+        m_window.resize(WINDOW_SIZE);
+}
+
+bool Inflater::Inflate(std::istream& input, uint64_t compressedSize, InflateSink sink, void* userData)
+{
+    struct FixedTables
+    {
+        Huffman lengths;
+        Huffman distances;
+        FixedTables()
+        {
+            uint8_t codeLengths[288];
+            std::fill(codeLengths, codeLengths + 144, (uint8_t)8);
+            std::fill(codeLengths + 144, codeLengths + 256, (uint8_t)9);
+            std::fill(codeLengths + 256, codeLengths + 280, (uint8_t)7);
+            std::fill(codeLengths + 280, codeLengths + 288, (uint8_t)8);
+            lengths.Build(codeLengths, 288);
+            std::fill(codeLengths, codeLengths + 30, (uint8_t)5);
+            distances.Build(codeLengths, 30);
+        }
+    };
+    static const FixedTables fixed;
+
+    Allocate();
+    m_stream = &input;
+    m_remaining = compressedSize;
+    m_inPos = m_inEnd = 0;
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+    m_outPos = 0;
+    m_totalOut = 0;
+    m_sink = sink;
+    m_userData = userData;
+
+    uint32_t last = 0;
+    do
+    {
+        uint32_t type = 0;
+        if (!Bits(1, last) || !Bits(2, type))
+            return false;
+
+        bool ok = false;
+        switch (type)
+        {
+        case 0:
+            ok = Stored();
+            break;
+        case 1:
+            ok = Codes(fixed.lengths, fixed.distances);
+            break;
+        case 2:
+            ok = Dynamic();
+            break;
+        default:
+            break;
+        }
+        if (!ok)
+            return false;
+    } while (!last);
+
+    return Flush();
+}
+
+bool Inflater::Copy(std::istream& input, uint64_t size, InflateSink sink, void* userData)
+{
+    Allocate();
+    m_stream = &input;
+    m_remaining = size;
+    while (m_remaining > 0)
+    {
+        if (!FillInput())
+            return false;
+        if (!sink(m_input.data(), m_inEnd, userData))
+            return false;
+    }
+    return true;
+}
+
+bool Inflater::FillInput()
+{
+    if (m_remaining == 0)
+        return false;
+
+    const size_t request = (size_t)std::min<uint64_t>(m_input.size(), m_remaining);
+    m_stream->read(reinterpret_cast<char*>(m_input.data()), request);
+    const size_t got = (size_t)m_stream->gcount();
+    if (got == 0)
+        return false;
+
+    m_remaining -= got;
+    m_inPos = 0;
+    m_inEnd = got;
+    return true;
+}
+
+void Inflater::Refill()
+{
+    while (m_bitCount <= 56)
+    {
+        if (m_inPos == m_inEnd && !FillInput())
+            return;
+        m_bitBuffer |= uint64_t(m_input[m_inPos++]) << m_bitCount;
+        m_bitCount += 8;
+    }
+}
+
+bool Inflater::Bits(uint32_t count, uint32_t& value)
+{
+    if (m_bitCount < count)
+    {
+        Refill();
+        if (m_bitCount < count)
+            return false;
+    }
+    value = (uint32_t)(m_bitBuffer & ((uint64_t(1) << count) - 1));
+    m_bitBuffer >>= count;
+    m_bitCount -= count;
+    return true;
+}
+
+int Inflater::Decode(const Huffman& huffman)
+{
+    if (m_bitCount < 15)
+        Refill();
+
+    const uint32_t entry = huffman.fast[m_bitBuffer & Huffman::FAST_MASK];
+    if (entry != 0 && (entry & 15) <= m_bitCount)
+    {
+        m_bitBuffer >>= (entry & 15);
+        m_bitCount -= (entry & 15);
+        return (int)(entry >> 4);
+    }
+
+    // Long (or truncated) codes: canonical decode one bit at a time
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (uint32_t len = 1; len < 16; ++len)
+    {
+        uint32_t bit = 0;
+        if (!Bits(1, bit))
+            return -1;
+        code |= (int)bit;
+        const int count = huffman.count[len];
+        if (code - count < first)
+            return huffman.symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+bool Inflater::Put(uint8_t byte)
+{
+    m_window[m_outPos++] = byte;
+    ++m_totalOut;
+    if (m_outPos == WINDOW_SIZE)
+        return Flush();
+    return true;
+}
+
+bool Inflater::Flush()
+{
+    if (m_outPos == 0)
+        return true;
+    const bool ok = m_sink(m_window.data(), m_outPos, m_userData);
+    m_outPos = 0;
+    return ok;
+}
+
+bool Inflater::Stored()
+{
+    // Stored blocks start on a byte boundary
+    const uint32_t skip = m_bitCount & 7;
+    m_bitBuffer >>= skip;
+    m_bitCount -= skip;
+
+    uint32_t length = 0;
+    uint32_t inverse = 0;
+    if (!Bits(16, length) || !Bits(16, inverse) || length != (~inverse & 0xFFFF))
+        return false;
+
+    while (length > 0 && m_bitCount >= 8)
+    {
+        if (!Put((uint8_t)m_bitBuffer))
+            return false;
+        m_bitBuffer >>= 8;
+        m_bitCount -= 8;
+        --length;
+    }
+    while (length > 0)
+    {
+        if (m_inPos == m_inEnd && !FillInput())
+            return false;
+        size_t chunk = std::min<size_t>(length, m_inEnd - m_inPos);
+        length -= (uint32_t)chunk;
+        while (chunk > 0)
+        {
+            const size_t space = std::min(chunk, WINDOW_SIZE - m_outPos);
+            std::memcpy(m_window.data() + m_outPos, m_input.data() + m_inPos, space);
+            m_outPos += space;
+            m_inPos += space;
+            m_totalOut += space;
+            chunk -= space;
+            if (m_outPos == WINDOW_SIZE && !Flush())
+                return false;
+        }
+    }
+    return true;
+}
+
+bool Inflater::Codes(const Huffman& lengths, const Huffman& distances)
+{
+    for (;;)
+    {
+        int symbol = Decode(lengths);
+        if (symbol < 0)
+            return false;
+        if (symbol < 256)
+        {
+            if (!Put((uint8_t)symbol))
+                return false;
+            continue;
+        }
+        if (symbol == 256)
+            return true;
+
+        symbol -= 257;
+        if (symbol >= 29)
+            return false;
+        uint32_t extra = 0;
+        if (!Bits(LENGTH_EXTRA[symbol], extra))
+            return false;
+        uint32_t length = LENGTH_BASE[symbol] + extra;
+
+        symbol = Decode(distances);
+        if (symbol < 0 || symbol >= 30)
+            return false;
+        if (!Bits(DIST_EXTRA[symbol], extra))
+            return false;
+        const uint32_t distance = DIST_BASE[symbol] + extra;
+        if (distance > m_totalOut)
+            return false;
+
+        while (length-- > 0)
+        {
+            if (!Put(m_window[(m_outPos - distance) & (WINDOW_SIZE - 1)]))
+                return false;
+        }
+    }
+}
+
+bool Inflater::Dynamic()
+{
+    uint32_t literalCount = 0;
+    uint32_t distanceCount = 0;
+    uint32_t codeCount = 0;
+    if (!Bits(5, literalCount) || !Bits(5, distanceCount) || !Bits(4, codeCount))
+        return false;
+    literalCount += 257;
+    distanceCount += 1;
+    codeCount += 4;
+    if (literalCount > 286 || distanceCount > 30)
+        return false;
+
+    uint8_t lengths[320] = {};
+    for (uint32_t i = 0; i < codeCount; ++i)
+    {
+        uint32_t value = 0;
+        if (!Bits(3, value))
+            return false;
+        lengths[CODE_LENGTH_ORDER[i]] = (uint8_t)value;
+    }
+
+    Huffman codeLengths;
+    if (!codeLengths.Build(lengths, 19))
+        return false;
+
+    uint32_t index = 0;
+    while (index < literalCount + distanceCount)
+    {
+        int symbol = Decode(codeLengths);
+        if (symbol < 0)
+            return false;
+        if (symbol < 16)
+        {
+            lengths[index++] = (uint8_t)symbol;
+            continue;
+        }
+
+        uint8_t repeatLength = 0;
+        uint32_t repeat = 0;
+        if (symbol == 16)
+        {
+            if (index == 0 || !Bits(2, repeat))
+                return false;
+            repeatLength = lengths[index - 1];
+            repeat += 3;
+        }
+        else if (symbol == 17)
+        {
+            if (!Bits(3, repeat))
+                return false;
+            repeat += 3;
+        }
+        else
+        {
+            if (!Bits(7, repeat))
+                return false;
+            repeat += 11;
+        }
+        if (index + repeat > literalCount + distanceCount)
+            return false;
+        while (repeat-- > 0)
+            lengths[index++] = repeatLength;
+    }
+
+    if (lengths[256] == 0)
+        return false;
+
+    Huffman literals;
+    Huffman distances;
+    if (!literals.Build(lengths, literalCount) || !distances.Build(lengths + literalCount, distanceCount))
+        return false;
+
+    return Codes(literals, distances);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+// Receives decompressed data. Return false to abort decompression.
+using InflateSink = bool(*)(const uint8_t* data, size_t size, void* userData);
+
+// Streaming raw DEFLATE (RFC 1951) decoder.
+// Memory use is fixed: one input buffer and the 32KB history window, allocated on first use and
+// reused between calls until Release().
+class Inflater
+{
+public:
+	static constexpr size_t WINDOW_SIZE = 32768;
+
+	Inflater(size_t inputBufferSize = 64 * 1024);
+
+	void SetInputBufferSize(size_t inputBufferSize);
+	// Frees both buffers while idle
+	void Release();
+
+	// Decodes exactly one deflate stream of compressedSize bytes read from input
+	bool Inflate(std::istream& input, uint64_t compressedSize, InflateSink sink, void* userData = nullptr);
+
+	// Copies compressedSize bytes unchanged (ZIP "stored" method) through the same buffers
+	bool Copy(std::istream& input, uint64_t size, InflateSink sink, void* userData = nullptr);
+
+private:
+	struct Huffman;
+
+	size_t m_inputSize;
+	std::vector<uint8_t> m_input;
+	std::vector<uint8_t> m_window;
+
+	// Per-call state
+	std::istream* m_stream = nullptr;
+	uint64_t m_remaining = 0;
+	size_t m_inPos = 0;
+	size_t m_inEnd = 0;
+	uint64_t m_bitBuffer = 0;
+	uint32_t m_bitCount = 0;
+	size_t m_outPos = 0;
+	uint64_t m_totalOut = 0;
+	InflateSink m_sink = nullptr;
+	void* m_userData = nullptr;
+
+	void Allocate();
+	bool FillInput();
+	void Refill();
+	bool Bits(uint32_t count, uint32_t& value);
+	int Decode(const Huffman& huffman);
+	bool Put(uint8_t byte);
+	bool Flush();
+
+	bool Stored();
+	bool Codes(const Huffman& lengths, const Huffman& distances);
+	bool Dynamic();
+};
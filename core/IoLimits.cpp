@@ -0,0 +1,84 @@
+#include "IoLimits.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+size_t IoLimits::MaxStreams(size_t buffersPerStream) const
+{
+    const size_t perStream = std::max<size_t>(1, bufferSize * std::max<size_t>(1, buffersPerStream));
+    return std::max<size_t>(1, memoryCap / perStream);
+}
+
+bool ParseByteSize(const std::string& text, size_t& size)
+{
+    if (text.empty() || !std::isdigit((unsigned char)text[0]))
+        return false;
+
+    size_t end = 0;
+    unsigned long long value = 0;
+    try
+    {
+        value = std::stoull(text, &end);
+    }
+    catch (std::exception&)
+    {
+        return false;
+    }
+
+    unsigned long long scale = 1;
+    if (end < text.size())
+    {
+        switch (std::toupper((unsigned char)text[end]))
+        {
+        case 'K':
+            scale = 1024ull;
+            break;
+        case 'M':
+            scale = 1024ull * 1024;
+            break;
+        case 'G':
+            scale = 1024ull * 1024 * 1024;
+            break;
+        default:
+            return false;
+        }
+        ++end;
+        if (end < text.size() && std::toupper((unsigned char)text[end]) == 'B')
+            ++end;
+    }
+    if (end != text.size() || value > SIZE_MAX / scale)
+        return false;
+
+    size = (size_t)(value * scale);
+    return true;
+}
+
+size_t PeakResidentMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Streaming I/O limits. Every copy, extraction, pack and verify stream reads through buffers of
+// bufferSize bytes (--io-buffer); memoryCap (--max-memory) bounds all of them together, which
+// caps how many streams run at once. Memory use is independent of entry sizes.
+struct IoLimits
+{
+	size_t bufferSize = 256 * 1024;
+	size_t memoryCap = 64 * 1024 * 1024;
+
+	// How many streams that each hold buffersPerStream buffers fit under the cap (at least one)
+	size_t MaxStreams(size_t buffersPerStream = 1) const;
+};
+
+// Accepts a byte count with an optional K, M or G suffix ("256K", "4M")
+bool ParseByteSize(const std::string& text, size_t& size);
+
+// Peak resident set size of this process in bytes, 0 if the platform doesn't report it
+size_t PeakResidentMemory();
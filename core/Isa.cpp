@@ -0,0 +1,233 @@
+#include "Isa.h"
+
+#include <iostream>
+#include <sstream>
+
+const std::vector<IsaVariant>& IsaVariants()
+{
+    // MSVC has no switch below AVX on x64, SSE4 intrinsics are always available there
+    static const std::vector<IsaVariant> variants = {
+        { "sse2", {}, {} },
+        { "sse4", {}, { "-msse4.2", "-mpopcnt" } },
+        { "avx", { "/arch:AVX" }, { "-mavx", "-mpopcnt" } },
+        { "avx2", { "/arch:AVX2" }, { "-mavx2", "-mfma", "-mbmi", "-mbmi2", "-mpopcnt" } },
+        { "avx512", { "/arch:AVX512" }, { "-mavx512f", "-mavx512cd", "-mavx512bw", "-mavx512dq", "-mavx512vl", "-mfma", "-mbmi", "-mbmi2", "-mpopcnt" } },
+    };
+    return variants;
+}
+
+const IsaVariant* FindIsaVariant(const std::string& name)
+{
+    for (const IsaVariant& variant : IsaVariants())
+    {
+        if (variant.name == name)
+            return &variant;
+    }
+    return nullptr;
+}
+
+bool ParseIsaList(const std::string& text, std::vector<std::string>& isas)
+{
+    std::vector<bool> selected(IsaVariants().size(), false);
+    selected[0] = true;
+
+    std::stringstream stream(text);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        if (name.empty())
+            continue;
+        const IsaVariant* variant = FindIsaVariant(name);
+        if (variant == nullptr)
+        {
+            std::cout << "[ERR] Unknown instruction set '" << name << "'. Available:";
+            for (const IsaVariant& known : IsaVariants())
+                std::cout << ' ' << known.name;
+            std::cout << std::endl;
+            return false;
+        }
+        selected[variant - IsaVariants().data()] = true;
+    }
+
+    isas.clear();
+    for (size_t i = 0; i < selected.size(); ++i)
+    {
+        if (selected[i])
+            isas.push_back(IsaVariants()[i].name);
+    }
+    return true;
+}
+
+namespace
+{
+    // CPUID/XGETBV checks for each variant; leaf1/leaf7 are {eax, ebx, ecx, edx}
+    std::string SupportCheck(const std::string& name)
+    {
+        const std::string sse4 = "(leaf1[2] & (1u << 19)) && (leaf1[2] & (1u << 20)) && (leaf1[2] & (1u << 23))";
+        const std::string avx = sse4 + " && osAvx && (leaf1[2] & (1u << 28))";
+        const std::string avx2 = avx + " && (leaf1[2] & (1u << 12)) && (leaf7[1] & (1u << 3)) && (leaf7[1] & (1u << 5)) && (leaf7[1] & (1u << 8))";
+        if (name == "sse4")
+            return sse4;
+        if (name == "avx")
+            return avx;
+        if (name == "avx2")
+            return avx2;
+        if (name == "avx512")
+            return avx2 + " && osAvx512 && (leaf7[1] & (1u << 16)) && (leaf7[1] & (1u << 17)) && (leaf7[1] & (1u << 28)) && (leaf7[1] & (1u << 30)) && (leaf7[1] & (1u << 31))";
+        return "true";
+    }
+}
+
+std::string DispatchHeader(const std::vector<std::string>& isas)
+{
+    std::ostringstream file;
+    file << R"(#pragma once
+
+// Runtime instruction set dispatch generated by premake-gen (-isa). Rewritten on every run.
+//
+// Every source in kernels/ is compiled once per variant below, with PG_ISA defined to the variant's
+// namespace. Declare each kernel once, in a header of your own:
+//
+//     PG_DECLARE_KERNEL(void, Scale, float* data, size_t count, float factor)
+//
+// define it inside "namespace PG_ISA { ... }" in a kernels/ source, and call kernels::Scale(...) from
+// the rest of the project. The best variant the CPU supports is selected during static initialization.
+// Set PREMAKE_GEN_ISA=<variant> to cap the selection, e.g. to test the baseline on a newer machine.
+//
+// Kernel sources are compiled for wider instruction sets, so keep inline functions and templates they
+// share with the rest of the program to a minimum: the linker may keep the kernel's copy of them.
+
+)";
+    file << "// Variants:";
+    for (const std::string& isa : isas)
+        file << ' ' << isa;
+    file << "\n\n";
+
+    file << "#define PG_DECLARE_KERNEL(ret, name, ...) \\\n";
+    for (const std::string& isa : isas)
+        file << "    namespace isa_" << isa << " { ret name(__VA_ARGS__); } \\\n";
+    file << "    PG_KERNEL_DISPATCHER(name";
+    for (const std::string& isa : isas)
+        file << ", isa_" << isa << "::name";
+    file << ")\n\n";
+
+    file << R"(#ifdef PG_ISA
+// Kernel sources only need the declarations
+#define PG_KERNEL_DISPATCHER(name, ...)
+#else
+#include <cstdlib>
+#include <cstring>
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace pg_dispatch
+{
+    enum class Isa
+    {
+)";
+    for (const std::string& isa : isas)
+        file << "        " << isa << ",\n";
+    file << "    };\n\n";
+    file << "    constexpr const char* ISA_NAMES[] = {";
+    for (size_t i = 0; i < isas.size(); ++i)
+        file << (i == 0 ? " \"" : ", \"") << isas[i] << '"';
+    file << " };\n";
+    file << "    constexpr int ISA_COUNT = " << isas.size() << ";\n";
+
+    file << R"(
+    inline void CpuId(unsigned leaf, unsigned subleaf, unsigned regs[4])
+    {
+#ifdef _MSC_VER
+        int values[4];
+        __cpuidex(values, (int)leaf, (int)subleaf);
+        for (int i = 0; i < 4; ++i)
+            regs[i] = (unsigned)values[i];
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    // Register state the OS saves on context switches
+    inline unsigned long long XGetBv()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned lo = 0, hi = 0;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((unsigned long long)hi << 32) | lo;
+#endif
+    }
+
+    inline bool Supports(Isa isa)
+    {
+        unsigned leaf0[4] = {};
+        unsigned leaf1[4] = {};
+        unsigned leaf7[4] = {};
+        CpuId(0, 0, leaf0);
+        if (leaf0[0] >= 1)
+            CpuId(1, 0, leaf1);
+        if (leaf0[0] >= 7)
+            CpuId(7, 0, leaf7);
+        const unsigned long long xcr0 = (leaf1[2] & (1u << 27)) ? XGetBv() : 0;
+        const bool osAvx = (xcr0 & 0x6) == 0x6;
+        const bool osAvx512 = (xcr0 & 0xE6) == 0xE6;
+        (void)osAvx;
+        (void)osAvx512;
+
+        switch (isa)
+        {
+)";
+    for (const std::string& isa : isas)
+        file << "        case Isa::" << isa << ": return " << SupportCheck(isa) << ";\n";
+    file << R"(        }
+        return false;
+    }
+
+    inline Isa Best()
+    {
+        static const Isa best = []()
+        {
+            int cap = ISA_COUNT - 1;
+            if (const char* forced = std::getenv("PREMAKE_GEN_ISA"))
+            {
+                for (int i = 0; i < ISA_COUNT; ++i)
+                {
+                    if (std::strcmp(forced, ISA_NAMES[i]) == 0)
+                        cap = i;
+                }
+            }
+            for (int i = cap; i > 0; --i)
+            {
+                if (Supports((Isa)i))
+                    return (Isa)i;
+            }
+            return (Isa)0;
+        }();
+        return best;
+    }
+
+    inline const char* Name(Isa isa)
+    {
+        return ISA_NAMES[(int)isa];
+    }
+
+    // One function per variant, in variant order
+    template <typename Fn, typename... Fns>
+    Fn Select(Fn baseline, Fns... others)
+    {
+        const Fn variants[] = { baseline, others... };
+        return variants[(int)Best()];
+    }
+}
+
+#define PG_KERNEL_DISPATCHER(name, ...) \
+    namespace kernels { inline const auto name = ::pg_dispatch::Select(__VA_ARGS__); }
+#endif
+)";
+    return file.str();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Instruction set variants for "-isa". The sources in a project's kernels/ folder are built once per
+// variant, each in a namespace named after it (isa_avx2, ...), and a generated dispatcher header
+// selects the best variant the CPU supports at startup.
+#define KERNEL_FOLDER "kernels"
+#define DISPATCH_HEADER_NAME "Dispatch.h"
+
+struct IsaVariant
+{
+	std::string name;
+	std::vector<std::string> msvcFlags;
+	std::vector<std::string> gccFlags;
+};
+
+// Every known variant, the x64 baseline (sse2) first, then from oldest to newest
+const std::vector<IsaVariant>& IsaVariants();
+const IsaVariant* FindIsaVariant(const std::string& name);
+
+// Parses a comma separated list ("sse4,avx2,avx512") into variant names in IsaVariants() order,
+// always starting with the baseline
+bool ParseIsaList(const std::string& text, std::vector<std::string>& isas);
+
+// Contents of kernels/Dispatch.h for these variants
+std::string DispatchHeader(const std::vector<std::string>& isas);
@@ -0,0 +1,18 @@
+#include "Json.h"
+
+std::string JsonString(std::string_view value)
+{
+    std::string escaped = "\"";
+    for (const char c : value)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if ((unsigned char)c < 0x20)
+        {
+            escaped += ' ';
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
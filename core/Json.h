@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// value as a quoted JSON string; control characters become spaces
+std::string JsonString(std::string_view value);
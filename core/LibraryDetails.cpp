@@ -0,0 +1,236 @@
+#include "LibraryDetails.h"
+
+#include "Json.h"
+#include "ProjectSettings.h"
+#include "ZipArchive.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    // Same limit premake-gen applies when it reads library.info for a project
+    constexpr size_t MAX_INFO_SIZE = 1024 * 1024;
+
+    uint32_t& FolderCount(LibraryDetails& details, const std::string& folder)
+    {
+        if (folder == "include")
+            return details.includeFiles;
+        if (folder == "lib")
+            return details.libFiles;
+        if (folder == "bin")
+            return details.binFiles;
+        if (folder == "src")
+            return details.srcFiles;
+        return details.otherFiles;
+    }
+
+    void CheckInfo(LibraryDetails& details, std::istream& info)
+    {
+        details.infoValid = CheckLibInfo(info, details.error);
+    }
+
+    void InspectZip(const std::string& path, LibraryDetails& details, size_t bufferSize)
+    {
+        std::error_code ec;
+        details.compressedSize = std::filesystem::file_size(path, ec);
+
+        ZipArchive zip;
+        zip.SetBufferSize(bufferSize);
+        if (!zip.Open(path))
+        {
+            details.error = "Could not read the ZIP file";
+            return;
+        }
+
+        for (const uint32_t child : zip.Children(zip.Root()))
+        {
+            const std::string name(zip.Name(child));
+            if (!zip[child].isFile)
+            {
+                uint32_t& count = FolderCount(details, name);
+                for (const uint32_t entry : zip.Subtree(child))
+                {
+                    if (!zip[entry].isFile)
+                        continue;
+                    ++count;
+                    details.totalSize += zip[entry].uncompressedSize;
+                }
+                continue;
+            }
+
+            details.totalSize += zip[child].uncompressedSize;
+            if (name == "main.cpp")
+                details.hasMain = true;
+            else if (name != "library.info" && name != ZipArchive::INDEX_ENTRY_NAME)
+                ++details.otherFiles;
+        }
+
+        const uint32_t info = zip.Find("library.info");
+        std::string data;
+        if (info == ZipArchive::npos)
+        {
+            details.error = "No library.info";
+        }
+        else if (!zip.ExtractToString(info, data, MAX_INFO_SIZE))
+        {
+            details.error = "Could not read library.info";
+        }
+        else
+        {
+            std::istringstream stream(data);
+            CheckInfo(details, stream);
+        }
+    }
+
+    void InspectFolder(const std::filesystem::path& root, LibraryDetails& details)
+    {
+        std::error_code ec;
+        for (std::filesystem::directory_iterator iter(root, ec), end; !ec && iter != end; iter.increment(ec))
+        {
+            const std::string name = iter->path().filename().u8string();
+            if (iter->is_directory(ec))
+            {
+                uint32_t& count = FolderCount(details, name);
+                for (std::filesystem::recursive_directory_iterator file(iter->path(), ec), fileEnd; !ec && file != fileEnd; file.increment(ec))
+                {
+                    if (!file->is_regular_file(ec))
+                        continue;
+                    ++count;
+                    details.totalSize += file->file_size(ec);
+                }
+                continue;
+            }
+
+            details.totalSize += iter->file_size(ec);
+            if (name == "main.cpp")
+                details.hasMain = true;
+            else if (name != "library.info")
+                ++details.otherFiles;
+        }
+        if (ec)
+            details.error = "Could not read the folder";
+        details.compressedSize = details.totalSize;
+
+        std::ifstream info(root / "library.info");
+        if (!info.is_open())
+        {
+            details.error = "No library.info";
+            return;
+        }
+        CheckInfo(details, info);
+    }
+
+    uint32_t FileCount(const LibraryDetails& details)
+    {
+        return details.includeFiles + details.libFiles + details.binFiles + details.srcFiles + details.otherFiles;
+    }
+}
+
+void InspectLibraries(const std::string& libDirectory, std::vector<LibraryDetails>& libraries, const IoLimits& limits)
+{
+    // Libraries are mostly metadata reads, so small buffers let many run at once
+    const size_t bufferSize = std::min<size_t>(limits.bufferSize, 64 * 1024);
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]()
+    {
+        for (size_t i = next++; i < libraries.size(); i = next++)
+        {
+            LibraryDetails& details = libraries[i];
+            if (details.isCompressed)
+                InspectZip(libDirectory + "/" + details.name + ".zip", details, bufferSize);
+            else
+                InspectFolder(std::filesystem::u8path(libDirectory + "/" + details.name), details);
+        }
+    };
+
+    IoLimits workerLimits = limits;
+    workerLimits.bufferSize = bufferSize;
+    const size_t threadCount = std::max<size_t>(1, std::min({ (size_t)std::thread::hardware_concurrency(), libraries.size(), workerLimits.MaxStreams(2) }));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+bool SortLibraryDetails(std::vector<LibraryDetails>& libraries, const std::string& key)
+{
+    auto byName = [](const LibraryDetails& a, const LibraryDetails& b) { return a.name < b.name; };
+    auto byDescending = [&](auto value)
+    {
+        std::stable_sort(libraries.begin(), libraries.end(), [&](const LibraryDetails& a, const LibraryDetails& b) { return value(a) > value(b); });
+    };
+
+    std::sort(libraries.begin(), libraries.end(), byName);
+    if (key == "name")
+        return true;
+    if (key == "size")
+        byDescending([](const LibraryDetails& details) { return details.totalSize; });
+    else if (key == "compressed")
+        byDescending([](const LibraryDetails& details) { return details.compressedSize; });
+    else if (key == "files")
+        byDescending([](const LibraryDetails& details) { return FileCount(details); });
+    else
+        return false;
+    return true;
+}
+
+void PrintLibraryDetails(const std::vector<LibraryDetails>& libraries)
+{
+    uint64_t totalSize = 0;
+    uint64_t compressedSize = 0;
+    size_t broken = 0;
+
+    std::cout << "\nPremake Generator -- Library Details:\n";
+    std::cout << std::left << std::setw(28) << "Library" << std::right << std::setw(14) << "Size" << std::setw(14) << "On Disk"
+        << std::setw(9) << "include" << std::setw(6) << "lib" << std::setw(6) << "bin" << std::setw(6) << "src"
+        << std::setw(6) << "main" << "  info\n";
+    std::cout << "--------------------------------------------------------------------------------------------\n";
+    for (const LibraryDetails& details : libraries)
+    {
+        std::cout << std::left << std::setw(28) << (details.isCompressed ? details.name + " [*]" : details.name) << std::right
+            << std::setw(14) << details.totalSize << std::setw(14) << details.compressedSize
+            << std::setw(9) << details.includeFiles << std::setw(6) << details.libFiles << std::setw(6) << details.binFiles
+            << std::setw(6) << details.srcFiles << std::setw(6) << (details.hasMain ? "yes" : "-") << "  "
+            << (details.infoValid ? "ok" : "[ERR] " + details.error) << "\n";
+        totalSize += details.totalSize;
+        compressedSize += details.compressedSize;
+        broken += details.infoValid ? 0 : 1;
+    }
+    std::cout << "--------------------------------------------------------------------------------------------\n";
+    std::cout << libraries.size() << " libraries, " << totalSize << " bytes (" << compressedSize << " on disk), "
+        << broken << " with a missing or broken library.info\n";
+    std::cout << "[*] = Compressed in ZIP file\n\n";
+}
+
+std::string LibraryDetailsJson(const std::vector<LibraryDetails>& libraries)
+{
+    std::ostringstream json;
+    json << "[";
+    for (size_t i = 0; i < libraries.size(); ++i)
+    {
+        const LibraryDetails& details = libraries[i];
+        json << (i == 0 ? "\n" : ",\n") << "  {\n";
+        json << "    \"name\": " << JsonString(details.name) << ",\n";
+        json << "    \"compressed\": " << (details.isCompressed ? "true" : "false") << ",\n";
+        json << "    \"size\": " << details.totalSize << ",\n";
+        json << "    \"sizeOnDisk\": " << details.compressedSize << ",\n";
+        json << "    \"files\": { \"include\": " << details.includeFiles << ", \"lib\": " << details.libFiles
+            << ", \"bin\": " << details.binFiles << ", \"src\": " << details.srcFiles << ", \"other\": " << details.otherFiles << " },\n";
+        json << "    \"main\": " << (details.hasMain ? "true" : "false") << ",\n";
+        json << "    \"infoValid\": " << (details.infoValid ? "true" : "false");
+        if (!details.error.empty())
+            json << ",\n    \"error\": " << JsonString(details.error);
+        json << "\n  }";
+    }
+    json << "\n]\n";
+    return json.str();
+}
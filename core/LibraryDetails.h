@@ -0,0 +1,36 @@
+#pragma once
+
+#include "IoLimits.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// What "--list --details" reports for one library folder or ZIP
+struct LibraryDetails
+{
+	std::string name;
+	bool isCompressed = false;
+
+	uint64_t totalSize = 0;         // bytes of all files once extracted
+	uint64_t compressedSize = 0;    // bytes on disk: the ZIP itself, or totalSize for folders
+	uint32_t includeFiles = 0;
+	uint32_t libFiles = 0;
+	uint32_t binFiles = 0;
+	uint32_t srcFiles = 0;
+	uint32_t otherFiles = 0;
+	bool hasMain = false;           // main.cpp example
+	bool infoValid = false;         // library.info exists and parses
+	std::string error;              // why infoValid is false, or why the library could not be read
+};
+
+// Fills in the details of every library (name and isCompressed set) on a pool of worker threads.
+// Each worker opens its own archives, so nothing here touches the caches of a running server.
+void InspectLibraries(const std::string& libDirectory, std::vector<LibraryDetails>& libraries, const IoLimits& limits);
+
+// Orders by "name" (default), "size", "compressed" or "files", largest first for the numeric keys.
+// False for an unknown key.
+bool SortLibraryDetails(std::vector<LibraryDetails>& libraries, const std::string& key);
+
+void PrintLibraryDetails(const std::vector<LibraryDetails>& libraries);
+std::string LibraryDetailsJson(const std::vector<LibraryDetails>& libraries);
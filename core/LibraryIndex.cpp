@@ -0,0 +1,119 @@
+#include "LibraryIndex.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    std::string Lower(std::string_view str)
+    {
+        std::string lower(str);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return lower;
+    }
+
+    // Optimal string alignment distance (Levenshtein plus adjacent transpositions)
+    size_t EditDistance(const std::string& a, const std::string& b, std::vector<size_t>& rows)
+    {
+        const size_t width = b.size() + 1;
+        rows.assign(3 * width, 0);
+        size_t* previous2 = rows.data();
+        size_t* previous = previous2 + width;
+        size_t* current = previous + width;
+        for (size_t j = 0; j < width; ++j)
+            previous[j] = j;
+
+        for (size_t i = 1; i <= a.size(); ++i)
+        {
+            current[0] = i;
+            for (size_t j = 1; j < width; ++j)
+            {
+                const size_t cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+                current[j] = std::min({ previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost });
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                    current[j] = std::min(current[j], previous2[j - 2] + 1);
+            }
+            std::swap(previous2, previous);
+            std::swap(previous, current);
+        }
+        return previous[b.size()];
+    }
+}
+
+void LibraryIndex::Build(const std::vector<std::string>& names)
+{
+    m_keys.clear();
+    m_keys.reserve(names.size());
+    for (uint32_t i = 0; i < (uint32_t)names.size(); ++i)
+        m_keys.push_back({ Lower(names[i]), names[i], i });
+
+    std::sort(m_keys.begin(), m_keys.end(), [](const Key& a, const Key& b)
+        {
+            return (a.lower != b.lower) ? a.lower < b.lower : a.name < b.name;
+        });
+}
+
+void LibraryIndex::Clear()
+{
+    m_keys.clear();
+}
+
+size_t LibraryIndex::LowerBound(std::string_view lower) const
+{
+    return std::lower_bound(m_keys.begin(), m_keys.end(), lower, [](const Key& key, std::string_view value)
+        {
+            return std::string_view(key.lower) < value;
+        }) - m_keys.begin();
+}
+
+uint32_t LibraryIndex::Find(std::string_view name) const
+{
+    const std::string lower = Lower(name);
+    for (size_t i = LowerBound(lower); i < m_keys.size() && m_keys[i].lower == lower; ++i)
+    {
+        if (m_keys[i].name == name)
+            return m_keys[i].id;
+    }
+    return npos;
+}
+
+void LibraryIndex::Complete(std::string_view prefix, std::vector<uint32_t>& ids) const
+{
+    const std::string lower = Lower(prefix);
+    for (size_t i = LowerBound(lower); i < m_keys.size(); ++i)
+    {
+        if (m_keys[i].lower.compare(0, lower.size(), lower) != 0)
+            break;
+        ids.push_back(m_keys[i].id);
+    }
+}
+
+void LibraryIndex::Suggest(std::string_view name, size_t maxCount, std::vector<uint32_t>& ids) const
+{
+    // Close spellings first, then names the input is a prefix of
+    const std::string lower = Lower(name);
+    const size_t maxDistance = std::max<size_t>(1, lower.size() / 3);
+    std::vector<std::pair<size_t, size_t>> candidates; // distance, key position
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < m_keys.size(); ++i)
+    {
+        const std::string& key = m_keys[i].lower;
+        if (key.size() > lower.size() + maxDistance && key.compare(0, lower.size(), lower) != 0)
+            continue;
+        if (key.size() + maxDistance < lower.size())
+            continue;
+
+        size_t distance = EditDistance(lower, key, rows);
+        if (distance > maxDistance)
+        {
+            if (lower.size() < 2 || key.compare(0, lower.size(), lower) != 0)
+                continue;
+            distance = maxDistance + 1;
+        }
+        candidates.emplace_back(distance, i);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (size_t i = 0; i < candidates.size() && i < maxCount; ++i)
+        ids.push_back(m_keys[candidates[i].second].id);
+}
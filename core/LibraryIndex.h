@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sorted, case-insensitive index over library names for exact lookup, prefix completion and
+// "did you mean" suggestions. Ids are the positions in the list passed to Build().
+class LibraryIndex
+{
+public:
+	static constexpr uint32_t npos = UINT32_MAX;
+
+	void Build(const std::vector<std::string>& names);
+	void Clear();
+
+	uint32_t Find(std::string_view name) const; // exact, case-sensitive match
+	void Complete(std::string_view prefix, std::vector<uint32_t>& ids) const; // in name order
+	void Suggest(std::string_view name, size_t maxCount, std::vector<uint32_t>& ids) const;
+
+private:
+	struct Key
+	{
+		std::string lower;
+		std::string name;
+		uint32_t id;
+	};
+
+	std::vector<Key> m_keys; // sorted by lower, then name
+
+	size_t LowerBound(std::string_view lower) const;
+};
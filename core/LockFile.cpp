@@ -0,0 +1,223 @@
+#include "LockFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    ProjectKind KindFromName(const std::string& name)
+    {
+        for (const ProjectKind kind : { ProjectKind::ConsoleApp, ProjectKind::WindowedApp, ProjectKind::StaticLib, ProjectKind::SharedLib })
+        {
+            if (name == KindString(kind))
+                return kind;
+        }
+        return ProjectKind::ConsoleApp;
+    }
+
+    template <typename List>
+    void WriteList(std::ofstream& file, const char* tag, const List& list)
+    {
+        file << '@' << tag << '\n';
+        for (const std::string& str : list)
+            file << str << '\n';
+    }
+
+    uint64_t Fnv1a(uint64_t hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        return hash;
+    }
+
+    uint64_t HashFile(uint64_t hash, const std::string& name, const std::filesystem::path& file)
+    {
+        std::error_code ec;
+        const uint64_t size = std::filesystem::file_size(file, ec);
+        const int64_t time = (int64_t)std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+        hash = Fnv1a(hash, name.data(), name.size() + 1);
+        hash = Fnv1a(hash, &size, sizeof(size));
+        return Fnv1a(hash, &time, sizeof(time));
+    }
+}
+
+LockedLibrary* LockFile::Find(const std::string& name)
+{
+    auto iter = std::find_if(libraries.begin(), libraries.end(), [&](const LockedLibrary& lib) { return lib.name == name; });
+    return (iter != libraries.end()) ? &*iter : nullptr;
+}
+
+const LockedLibrary* LockFile::Find(const std::string& name) const
+{
+    return const_cast<LockFile*>(this)->Find(name);
+}
+
+bool ReadLockFile(const std::string& path, LockFile& lock)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    lock = LockFile();
+    std::string tag;
+    std::string line;
+    size_t libraryLine = 0;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+        if (line[0] == '@')
+        {
+            tag = line.substr(1);
+            if (tag == "library")
+            {
+                lock.libraries.emplace_back();
+                libraryLine = 0;
+            }
+            continue;
+        }
+
+        if (tag == "premake-gen")
+            lock.version = line;
+        else if (tag == "solution")
+            lock.solution = line;
+        else if (tag == "project")
+            lock.settings.name = line;
+        else if (tag == "kind")
+            lock.settings.kind = KindFromName(line);
+        else if (tag == "targetName")
+            lock.settings.targetName = line;
+        else if (tag == "dialect")
+            lock.settings.dialect = (uint8_t)std::atoi(line.c_str());
+        else if (tag == "options")
+        {
+            lock.includeExamples |= line == "-example";
+            lock.includeBench |= line == "-bench";
+            lock.includeNinja |= line == "-ninja";
+            lock.includeModules |= line == "-modules";
+            lock.mergeIncludes |= line == "-merge-includes";
+            lock.pruneDlls |= line == "-prune-dlls";
+        }
+        else if (tag == "defines")
+            lock.settings.defines.Insert(line);
+        else if (tag == "additionalIncludeDirs")
+            lock.settings.additionalIncludeDirs.Insert(line);
+        else if (tag == "additionalLibDirs")
+            lock.settings.additionalLibDirs.Insert(line);
+        else if (tag == "globalLinks")
+            lock.settings.globalLinks.Insert(line);
+        else if (tag == "debugLinks")
+            lock.settings.debugLinks.Insert(line);
+        else if (tag == "releaseLinks")
+            lock.settings.releaseLinks.Insert(line);
+        else if (tag == "sourceLibraries")
+            lock.settings.sourceLibraries.Insert(line);
+        else if (tag == "modules")
+            lock.settings.modules.Insert(line);
+        else if (tag == "isa")
+            lock.isas.push_back(line);
+        else if (tag == "prunedLinks")
+            lock.prunedLinks.Insert(line);
+        else if (tag == "library")
+        {
+            // name, source kind and fingerprint, then one materialized file per line
+            LockedLibrary& lib = lock.libraries.back();
+            if (libraryLine == 0)
+                lib.name = line;
+            else if (libraryLine == 1)
+                lib.isCompressed = line == "zip";
+            else if (libraryLine == 2)
+                lib.fingerprint = line;
+            else
+                lib.files.push_back(line);
+            ++libraryLine;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !lock.solution.empty();
+}
+
+bool WriteLockFile(const std::string& path, const LockFile& lock)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    file << "@premake-gen\n" << lock.version << '\n';
+    file << "@solution\n" << lock.solution << '\n';
+    file << "@project\n" << lock.settings.name << '\n';
+    file << "@kind\n" << KindString(lock.settings.kind) << '\n';
+    file << "@targetName\n" << lock.settings.targetName << '\n';
+    file << "@dialect\n" << (int)lock.settings.dialect << '\n';
+    file << "@options\n";
+    if (lock.includeExamples)
+        file << "-example\n";
+    if (lock.includeBench)
+        file << "-bench\n";
+    if (lock.includeNinja)
+        file << "-ninja\n";
+    if (lock.includeModules)
+        file << "-modules\n";
+    if (lock.mergeIncludes)
+        file << "-merge-includes\n";
+    if (lock.pruneDlls)
+        file << "-prune-dlls\n";
+
+    WriteList(file, "defines", lock.settings.defines);
+    WriteList(file, "additionalIncludeDirs", lock.settings.additionalIncludeDirs);
+    WriteList(file, "additionalLibDirs", lock.settings.additionalLibDirs);
+    WriteList(file, "globalLinks", lock.settings.globalLinks);
+    WriteList(file, "debugLinks", lock.settings.debugLinks);
+    WriteList(file, "releaseLinks", lock.settings.releaseLinks);
+    if (!lock.settings.sourceLibraries.empty())
+        WriteList(file, "sourceLibraries", lock.settings.sourceLibraries);
+    if (!lock.settings.modules.empty())
+        WriteList(file, "modules", lock.settings.modules);
+    if (!lock.isas.empty())
+        WriteList(file, "isa", lock.isas);
+    if (!lock.prunedLinks.empty())
+        WriteList(file, "prunedLinks", lock.prunedLinks);
+
+    for (const LockedLibrary& lib : lock.libraries)
+    {
+        file << "@library\n" << lib.name << '\n' << (lib.isCompressed ? "zip" : "folder") << '\n' << lib.fingerprint << '\n';
+        for (const std::string& libFile : lib.files)
+            file << libFile << '\n';
+    }
+    return (bool)file;
+}
+
+std::string LibraryFingerprint(const std::string& path, bool isCompressed)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    if (isCompressed)
+    {
+        hash = HashFile(hash, "", path);
+    }
+    else
+    {
+        // Sorted so the fingerprint doesn't depend on directory iteration order
+        std::vector<std::pair<std::string, std::filesystem::path>> files;
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator iter(path, ec), end; !ec && iter != end; iter.increment(ec))
+        {
+            if (iter->is_regular_file(ec))
+                files.emplace_back(iter->path().lexically_relative(path).generic_u8string(), iter->path());
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& [name, file] : files)
+            hash = HashFile(hash, name, file);
+    }
+
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+    return text;
+}
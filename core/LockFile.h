@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ProjectSettings.h"
+
+#include <string>
+#include <vector>
+
+#define LOCK_FILE_NAME "premake-gen.lock"
+
+struct LockedLibrary
+{
+	std::string name;
+	bool isCompressed = false;
+	std::string fingerprint;
+	std::vector<std::string> files; // workspace relative, '/' separated
+};
+
+// What a generation resolved and materialized, so --update can apply only the delta.
+// Written in the same @-tagged text format as settings.info and library.info.
+struct LockFile
+{
+	std::string version;
+	std::string solution;
+	ProjectSettings settings; // merged over all libraries
+	bool includeExamples = false;
+	bool includeBench = false;
+	bool includeNinja = false;
+	bool includeModules = false;
+	bool mergeIncludes = false;
+	bool pruneDlls = false;
+	std::vector<std::string> isas; // "-isa" variants, baseline first
+	StringSet prunedLinks; // entries of the settings links that --prune-links found unused; left out when generating
+	std::vector<LockedLibrary> libraries;
+
+	LockedLibrary* Find(const std::string& name);
+	const LockedLibrary* Find(const std::string& name) const;
+};
+
+bool ReadLockFile(const std::string& path, LockFile& lock);
+bool WriteLockFile(const std::string& path, const LockFile& lock);
+
+// Changes whenever the library's archive or any file in its folder is replaced, resized or touched
+std::string LibraryFingerprint(const std::string& path, bool isCompressed);
@@ -1,21 +1,53 @@
-#include <zipp/ZipReader.h>
-
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <sstream>
-#include <conio.h>
+#include <stdexcept>
+#include <chrono>
 
 #include "AppData.h"
 #include "ProjectSettings.h"
+#include "ZipArchive.h"
 #include "HowTo.h"
+#include "BenchHarness.h"
+#include "Pack.h"
+#include "Server.h"
+#include "LockFile.h"
+#include "Verify.h"
+#include "IoLimits.h"
+#include "LibraryIndex.h"
+#include "Completion.h"
+#include "CopyPlan.h"
+#include "Ninja.h"
+#include "Isa.h"
+#include "AllocStats.h"
+#include "LibraryDetails.h"
+#include "Payload.h"
+#include "IncludeTree.h"
+#include "Console.h"
+#include "SymbolIndex.h"
+#include "PeImports.h"
 
 #define TAB std::string("    ")
 
 #define PREMAKE_GEN_VERSION "v1.1.0"
 
+// Sources of libraries that ship a "src" tree are copied to <folder>/<LibName>/src
+#define SOURCE_LIBRARY_FOLDER "libs"
+
+// "-modules" writes one module interface unit per library to <Project>/modules/<LibName>.ixx
+#define MODULE_FOLDER "modules"
+
+// "-merge-includes" mirrors the library include directories into this one folder of the project
+#define MERGED_INCLUDE_FOLDER "int/include"
+
+// library.info is read into memory whole, so anything larger is rejected
+#define MAX_LIB_INFO_SIZE (1024 * 1024)
+
 #ifdef _DEBUG
 //#define DBG_ARGS {"test", "prj", "SFML", "zipp", "yaml-cpp", "-example"}
 #define DBG_ARGS {"--list"}
@@ -31,41 +63,140 @@ std::string path;
 std::string libDirectory;
 std::vector<std::string> args;
 std::vector<LibDirectoryInfo> libManifest;
+LibraryIndex libIndex; // over libManifest names, rebuilt with it
 std::vector<std::string> fileManifest;
 
+// Kept between requests while serving; a one-shot run fills each of them at most once
+bool manifestLoaded = false;
+std::unordered_map<std::string, ProjectSettings> libInfoCache;
+std::unordered_map<std::string, std::unique_ptr<ZipArchive>> libZipCache;
+
+IoLimits ioLimits;
+
+// Premake files copied into every workspace: the extracted payload of this executable, or the AppData folder
+std::string premakeFolder;
+
 void GenerateLibDir();
 bool CheckPremakeFolder();
 void ParseArgs(int argc, char* argv[]);
 void PrintHelp();
+bool ParseIoOptions();
+void PrintPeakMemory();
+
+int Run();
+int Update();
+bool VerifyWorkspace(const LockFile& lock);
+int PruneLinks();
+ProjectSettings LinkedSettings(const LockFile& lock);
+bool PruneDlls(CopyPlan& plan, const ProjectSettings& settings, const LockFile& lock);
+int Serve();
+bool IsServedCommand();
+void InvalidateAll();
+void InvalidateLibrary(const std::string& name);
+int Complete();
+bool PrintCompletionScript(const std::string& shell);
 
 void PopulateManifest();
+const LibDirectoryInfo* FindLibrary(const std::string& name);
+void PrintSuggestions(const std::string& name);
 void SetLibDir(const std::string& path);
 bool CheckLibDir();
 void PrintList();
+int ListDetails();
 
 bool ReadLibInfo(ProjectSettings& settings, const LibDirectoryInfo& lib);
 bool ReadLibInfo_Zip(ProjectSettings& settings, const std::string& lib);
 bool ReadLibInfo_Folder(ProjectSettings& settings, const std::string& lib);
-
-bool GeneratePremakeFile(const ProjectSettings& settings, const std::string& solution);
-
-bool CopyFiles(const std::string& project, const std::vector<LibDirectoryInfo>& libraries, bool useExamples);
-bool CopyFiles_Zip(const std::string& project, const std::string& lib, bool useExamples, bool& firstExample);
-bool CopyFiles_Folder(const std::string& project, const std::string& lib, bool useExamples, bool& firstExample);
+ZipArchive* OpenLibZip(const std::string& lib);
+
+bool WriteIfChanged(const std::string& path, const std::string& content);
+bool GeneratePremakeFile(const ProjectSettings& settings, const std::string& solution, bool includeBench, const std::vector<std::string>& isas, bool includeModules, bool mergeIncludes);
+void GenerateBenchProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::vector<std::string>& isas);
+void GenerateKernelProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::string& isa);
+void GenerateSourceLibraryProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::string& lib);
+void GenerateModuleProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs);
+std::vector<std::string> LibraryIncludeDirs(const ProjectSettings& settings, bool mergeIncludes);
+bool GenerateIncludeTree(const ProjectSettings& settings);
+std::vector<std::string> ProjectLinks(const ProjectSettings& settings, const std::vector<std::string>& isas);
+void WriteStringList(std::ostream& file, const std::string& indent, const std::string& name, const std::vector<std::string>& list, const std::string& project);
+void GenerateLinuxFilter(std::ostream& file, const ProjectSettings& settings, const std::string& project);
+void GenerateConfigurationLinks(std::ostream& file, const StringSet& links, const std::string& configuration, const std::string& project);
+bool GenerateLinuxScript();
+bool GenerateNinjaFiles(const ProjectSettings& settings, bool includeBench, const std::vector<std::string>& isas, bool mergeIncludes);
+bool GenerateKernelFiles(const std::string& project, const std::vector<std::string>& isas);
+bool GenerateModuleFiles(const LockFile& lock);
+
+bool CopyFiles(const std::string& project, const std::vector<LibDirectoryInfo>& libraries, bool useExamples, bool dryRun, LockFile& lock);
+bool PlanLibrary(CopyPlan& plan, const std::string& project, const LibDirectoryInfo& lib);
+bool CopyExample(const std::string& project, const LibDirectoryInfo& lib, bool& firstExample);
+bool GenerateBenchFiles(const std::string& project);
+void CollectLibFiles(const LockFile& lock);
 bool GenerateGitignore();
 
 
 int main(int argc, char* argv[])
 {
-    if (!CheckPremakeFolder())
-    {
-        return 0;
-    }
 #ifdef _DEBUG
     args = DBG_ARGS;
 #else //_DEBUG
     ParseArgs(argc, argv);
 #endif // else _DEBUG
+
+    // Heap accounting is about this process, so such runs are never forwarded to a server
+    const auto allocStatsFlag = std::find_if(args.begin(), args.end(), [](const std::string& arg) { return arg == "-alloc-stats" || arg == "--alloc-stats"; });
+    if (allocStatsFlag != args.end())
+    {
+        args.erase(allocStatsFlag);
+        EnableAllocStats();
+        BeginAllocPhase("startup");
+    }
+
+    // A server applies the console options of each request itself
+    const std::vector<std::string> requestArgs = args;
+    ParseConsoleOptions(args);
+    InstallConsoleFilter();
+
+    // Thin client: a running server answers from its warm caches
+    if (!AllocStatsEnabled() && IsServedCommand())
+    {
+        int exitCode = 0;
+        std::string output;
+        if (ForwardToServer(requestArgs, exitCode, output))
+        {
+            std::cout << output << std::flush;
+            return exitCode;
+        }
+    }
+
+    if (!ParseIoOptions())
+    {
+        return 1;
+    }
+
+    // Completion runs on every <TAB>, so it skips the setup checks and never prints anything else
+    if (!args.empty() && (args[0] == "-complete" || args[0] == "--complete"))
+    {
+        return Complete();
+    }
+    if (!args.empty() && (args[0] == "-completion" || args[0] == "--completion"))
+    {
+        return PrintCompletionScript((args.size() >= 2) ? args[1] : "") ? 0 : 1;
+    }
+
+    if (!args.empty() && (args[0] == "-embed-premake" || args[0] == "--embed-premake"))
+    {
+        if (args.size() < 3)
+        {
+            std::cout << "[ERR] Usage: premake-gen --embed-premake <premake folder> <output executable>\n";
+            return 1;
+        }
+        return EmbedPremakePayload(std::filesystem::u8path(args[1]), args[2], ioLimits) ? 0 : 1;
+    }
+
+    if (!CheckPremakeFolder())
+    {
+        return 0;
+    }
     if (args.empty() || args[0] == "-help" || args[0] == "--help")
     {
         PrintHelp();
@@ -104,21 +235,131 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    if (!CheckLibDir())
+    if (args[0] == "-pack" || args[0] == "--pack")
     {
-        return 1;
+        if (args.size() < 2)
+        {
+            std::cout << "[ERR] Usage: premake-gen --pack <folder> [output.zip]\n";
+            return 1;
+        }
+        std::string folder = args[1];
+        while (folder.size() > 1 && (folder.back() == '/' || folder.back() == '\\'))
+            folder.pop_back();
+        const std::string output = (args.size() >= 3) ? args[2] : folder + ".zip";
+        BeginAllocPhase("pack");
+        const bool packed = PackLibrary(folder, output, ioLimits);
+        PrintAllocStats();
+        PrintPeakMemory();
+        return packed ? 0 : 1;
+    }
+
+    if (args[0] == "-serve" || args[0] == "--serve")
+    {
+        if (args.size() >= 2 && args[1] == "stop")
+        {
+            int exitCode = 0;
+            std::string output;
+            if (!ForwardToServer(args, exitCode, output))
+            {
+                std::cout << "No server running\n";
+                return 1;
+            }
+            std::cout << output;
+            return exitCode;
+        }
+        return Serve();
     }
 
-    PopulateManifest();
+    const int result = Run();
+    PrintAllocStats();
+    if (args[0] != "-list" && args[0] != "--list" && args[0] != "-ninja" && args[0] != "--ninja")
+        PrintPeakMemory();
+    return result;
+}
 
-    GenerateLibDir();
+int Run()
+{
+    if (args[0] == "-complete" || args[0] == "--complete")
+    {
+        return Complete();
+    }
 
-    if (args[0] == "-list" || args[0] == "--list")
+    // Rerun by build.ninja itself, so it only needs the lockfile
+    if (args[0] == "-ninja" || args[0] == "--ninja")
     {
-        PrintList();
+        LockFile lock;
+        if (!ReadLockFile(LOCK_FILE_NAME, lock))
+        {
+            std::cout << "[ERR] Could not read " << LOCK_FILE_NAME << ". Generate the workspace in this directory first." << std::endl;
+            return 1;
+        }
+        if (!GenerateNinjaFiles(LinkedSettings(lock), lock.includeBench, lock.isas, lock.mergeIncludes))
+            return 1;
+        if (!lock.includeNinja)
+        {
+            // Keep them in sync from now on
+            lock.includeNinja = true;
+            if (!WriteLockFile(LOCK_FILE_NAME, lock))
+            {
+                std::cout << "[ERR] Could not write " << LOCK_FILE_NAME << std::endl;
+                return 1;
+            }
+        }
         return 0;
     }
 
+    if (libDirectory.empty() && !CheckLibDir())
+    {
+        return 1;
+    }
+
+    // JSON has to be the only thing on stdout
+    const bool isList = args[0] == "-list" || args[0] == "--list";
+    const bool quiet = isList && (std::find(args.begin(), args.end(), "--json") != args.end() || std::find(args.begin(), args.end(), "-json") != args.end());
+    std::ostringstream discard;
+    std::streambuf* console = quiet ? std::cout.rdbuf(discard.rdbuf()) : nullptr;
+    if (!manifestLoaded)
+    {
+        BeginAllocPhase("manifest");
+        PopulateManifest();
+
+        GenerateLibDir();
+    }
+    BeginAllocPhase("other");
+    if (quiet)
+        std::cout.rdbuf(console);
+
+    if (isList)
+    {
+        if (args.size() == 1)
+        {
+            PrintList();
+            return 0;
+        }
+        return ListDetails();
+    }
+
+    if (args[0] == "-update" || args[0] == "--update")
+    {
+        return Update();
+    }
+
+    if (args[0] == "-verify" || args[0] == "--verify")
+    {
+        LockFile lock;
+        if (!ReadLockFile(LOCK_FILE_NAME, lock))
+        {
+            std::cout << "[ERR] Could not read " << LOCK_FILE_NAME << ". Generate the workspace in this directory first." << std::endl;
+            return 1;
+        }
+        return VerifyWorkspace(lock) ? 0 : 1;
+    }
+
+    if (args[0] == "-prune-links" || args[0] == "--prune-links")
+    {
+        return PruneLinks();
+    }
+
     if (args.size() < 2)
     {
         PrintHelp();
@@ -132,6 +373,15 @@ int main(int argc, char* argv[])
     settings.name = args[1];
 
     bool includeExamples = false;
+    bool includeBench = false;
+    bool includeNinja = false;
+    bool includeModules = false;
+    bool mergeIncludes = false;
+    bool pruneDlls = false;
+    std::vector<std::string> isas;
+    bool verify = false;
+    bool dryRun = false;
+    BeginAllocPhase("info parse");
     for (size_t i = 2; i < args.size(); ++i)
     {
         if (args[i] == "-dialect")
@@ -153,6 +403,18 @@ int main(int argc, char* argv[])
             ++i;
             continue;
         }
+        else if (args[i] == "-isa")
+        {
+            if (i + 1 >= args.size())
+            {
+                std::cout << "[ERR] No instruction sets supplied, e.g. -isa sse4,avx2,avx512" << std::endl;
+                return 1;
+            }
+            if (!ParseIsaList(args[i + 1], isas))
+                return 1;
+            ++i;
+            continue;
+        }
         else if (args[i] == "-windowed")
         {
             settings.kind = ProjectKind::WindowedApp;
@@ -163,705 +425,2371 @@ int main(int argc, char* argv[])
             includeExamples = true;
             continue;
         }
-        auto iter = std::find_if(libManifest.begin(), libManifest.end(),
-            [&](const LibDirectoryInfo& info) { return info.name == args[i]; });
-        if (iter != libManifest.end())
+        else if (args[i] == "-bench")
         {
-            LibDirectoryInfo& lib = libraries.emplace_back(*iter);
-            if (!ReadLibInfo(settings, lib))
-                return 1;
+            includeBench = true;
+            continue;
         }
-        else
+        else if (args[i] == "-ninja")
+        {
+            includeNinja = true;
+            continue;
+        }
+        else if (args[i] == "-modules")
+        {
+            includeModules = true;
+            continue;
+        }
+        else if (args[i] == "-merge-includes")
+        {
+            mergeIncludes = true;
+            continue;
+        }
+        else if (args[i] == "-prune-dlls")
+        {
+            pruneDlls = true;
+            continue;
+        }
+        else if (args[i] == "-verify")
+        {
+            verify = true;
+            continue;
+        }
+        else if (args[i] == "-dry-run" || args[i] == "--dry-run")
         {
-            std::cout << "[WARN] '" << args[i] << "' was not recognized as a library or argument. Would you like to continue without it? [y/n]: ";
-            char c = _getche();
-            if (c != 'y' && c != 'Y')
-                return 0;
+            dryRun = true;
+            continue;
+        }
+        const LibDirectoryInfo* found = FindLibrary(args[i]);
+        if (found == nullptr)
+        {
+            std::cout << "[ERR] '" << args[i] << "' was not recognized as a library or argument.";
+            PrintSuggestions(args[i]);
+            return 1;
         }
+        LibDirectoryInfo& lib = libraries.emplace_back(*found);
+        if (!ReadLibInfo(settings, lib))
+            return 1;
+    }
+    LockFile lock;
+    lock.version = PREMAKE_GEN_VERSION;
+    lock.solution = sln;
+    lock.settings = settings;
+    lock.includeExamples = includeExamples;
+    lock.includeBench = includeBench;
+    lock.includeNinja = includeNinja;
+    lock.includeModules = includeModules;
+    lock.mergeIncludes = mergeIncludes;
+    lock.pruneDlls = pruneDlls;
+    lock.isas = isas;
+    if (!isas.empty() && settings.dialect < 17)
+        std::cout << "[WARNING] The -isa dispatcher uses inline variables and needs C++17 or newer\n";
+    if (includeModules && settings.dialect < 20)
+    {
+        std::cout << "[ERR] -modules needs C++20 or newer, add -dialect 20" << std::endl;
+        return 1;
     }
-    if (!GeneratePremakeFile(settings, sln))
+    if (includeModules && includeNinja)
+        std::cout << "[WARNING] build.ninja includes the library headers directly; modules are only built by the premake projects\n";
+
+    if (dryRun)
+        return CopyFiles(settings.name, libraries, includeExamples, true, lock) ? 0 : 1;
+
+    BeginAllocPhase("premake emit");
+    if (!GeneratePremakeFile(settings, sln, includeBench, isas, includeModules, mergeIncludes))
+        return 1;
+
+    BeginAllocPhase("copy");
+    if (!CopyFiles(settings.name, libraries, includeExamples, false, lock))
+        return 1;
+    if (mergeIncludes && !GenerateIncludeTree(settings))
+        return 1;
+    BeginAllocPhase("other");
+
+    if (!isas.empty() && !GenerateKernelFiles(settings.name, isas))
+        return 1;
+
+    if (includeModules && !GenerateModuleFiles(lock))
+        return 1;
+
+    if (verify && !VerifyWorkspace(lock))
+        return 1;
+
+    if (includeBench && !GenerateBenchFiles(settings.name + BENCH_PROJECT_SUFFIX))
+        return 1;
+
+    if (!GenerateLinuxScript())
         return 1;
 
-    if (!CopyFiles(settings.name, libraries, includeExamples))
+    if (includeNinja && !GenerateNinjaFiles(settings, includeBench, isas, mergeIncludes))
         return 1;
 
+    BeginAllocPhase("gitignore");
+    CollectLibFiles(lock);
     if (!GenerateGitignore())
     {
         return 1;
     }
 
+    BeginAllocPhase("other");
+    if (!WriteLockFile(LOCK_FILE_NAME, lock))
+    {
+        std::cout << "[ERR] Could not write " << LOCK_FILE_NAME << std::endl;
+        return 1;
+    }
+    // The lockfile now records every copied file
+    std::error_code ec;
+    std::filesystem::remove(COPY_JOURNAL_NAME, ec);
+
     std::cout << "Done!" << std::endl;
     
     return 0;
 }
 
-void GenerateLibDir()
-{
-	if (std::filesystem::exists(libDirectory))
-		return;
-
-	std::cout << "Generating Library Directory...\n";
-	std::filesystem::create_directories(libDirectory);
-}
-
-bool CheckPremakeFolder()
+// Removes the directories file leaves empty, up to but not including root
+void RemoveEmptyParents(const std::filesystem::path& file, const std::filesystem::path& root)
 {
-    if (!std::filesystem::exists(_APPDATA_ + "/premake-gen/premake"))
+    std::error_code ec;
+    for (std::filesystem::path dir = file.parent_path(); !dir.empty() && dir != root; dir = dir.parent_path())
     {
-        std::filesystem::create_directories(_APPDATA_ + "/premake-gen/premake");
-        std::cout << "Copy files from provided \"premake\" folder to \"%APPDATA%\\premake-gen\\premake\"\n";
-        system(("explorer \"" + _APPDATA_ + "\\premake-gen\"").c_str());
-        return false;
+        if (!std::filesystem::is_directory(dir, ec) || !std::filesystem::is_empty(dir, ec))
+            break;
+        std::filesystem::remove(dir, ec);
     }
-    return true;
 }
 
-void ParseArgs(int argc, char* argv[])
+int Update()
 {
-    path = argv[0];
-    args.resize(argc - 1);
-    for (int i = 1; i < argc; ++i)
+    LockFile lock;
+    if (!ReadLockFile(LOCK_FILE_NAME, lock))
     {
-        args[i - 1] = argv[i];
+        std::cout << "[ERR] Could not read " << LOCK_FILE_NAME << ". Generate the workspace in this directory first." << std::endl;
+        return 1;
     }
-}
 
-void PrintHelp()
-{
-    std::cout << "\nPremake Generator -- Help\n";
-    std::cout << "--------------------------------------------------------------------------\n";
-    std::cout << "--help               | You're already here ;)\n";
-    std::cout << "--version            | See version number\n";
-    std::cout << "--list               | Lists all available library names\n";
-    std::cout << "--setup              | Instructions on how to setup a new library\n";
-    std::cout << "--libdir             | Open the set library directory\n";
-    std::cout << "--libdir <directory> | Set the library directory\n";
-    std::cout << "--appdata            | Open the AppData directory in File Explorer\n";
-    std::cout << "---------------------|----------------------------------------------------\n";
-    std::cout << "USAGE: premake-gen <Solution> <Project> <flags>\n\n";
-    std::cout << "-dialect <number>    | C++ version override (17 by default)\n";
-    std::cout << "-example             | includes the first library example file as Main.cpp\n";
-    std::cout << "                     |     with the rest in the 'examples' folder\n";
-    std::cout << "<LibName>            | includes that libarary\n";
-    std::cout << "--------------------------------------------------------------------------\n";
-}
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    bool dryRun = false;
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        if (args[i] == "-dry-run" || args[i] == "--dry-run")
+            dryRun = true;
+        else if (args[i].size() > 1 && args[i][0] == '-')
+            removed.push_back(args[i].substr(1));
+        else if (args[i].size() > 1 && args[i][0] == '+')
+            added.push_back(args[i].substr(1));
+        else
+            added.push_back(args[i]);
+    }
+    auto contains = [](const std::vector<std::string>& list, const std::string& name)
+    {
+        return std::find(list.begin(), list.end(), name) != list.end();
+    };
 
-void PopulateManifest()
-{
-    std::cout << "Finding available libraries...\n";
-    std::unordered_set<std::string> added;
-    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(libDirectory))
+    // Kept libraries stay in lock order and new ones are appended, as if generated in that order
+    std::vector<LibDirectoryInfo> libraries;
+    std::vector<std::string> stale;
+    for (const LockedLibrary& locked : lock.libraries)
     {
-        if (!entry.is_regular_file())
+        if (contains(removed, locked.name))
         {
-            std::string name = entry.path().filename().u8string();
-            if (added.find(name) != added.end())
-            {
-                auto iter = std::find_if(libManifest.begin(), libManifest.end(), [&](const LibDirectoryInfo& i) {return i.name == name; });
-                iter->isCompressed = false;
-
-                std::cout << "[WARNING] Duplicate library \"" + name + "\" found. premake-gen will use the folder version.\n";
-                continue;
-            }
-            added.insert(name);
-            libManifest.push_back({ name, false });
+            stale.push_back(locked.name);
             continue;
         }
-
-        if (!entry.path().has_extension() || entry.path().extension() != ".zip")
+        const LibDirectoryInfo* found = FindLibrary(locked.name);
+        if (found == nullptr)
         {
-            std::cout << "[WARNING] Incompatible file in library directory: \"" + entry.path().filename().u8string() + "\". Ignoring...\n";
+            std::cout << "[ERR] Library '" << locked.name << "' is no longer available. Remove it with -" << locked.name << std::endl;
+            return 1;
+        }
+        libraries.push_back(*found);
+    }
+    for (const std::string& name : removed)
+    {
+        if (lock.Find(name) == nullptr)
+            std::cout << "[WARNING] '" << name << "' is not part of this workspace\n";
+    }
+    for (const std::string& name : added)
+    {
+        if (std::find_if(libraries.begin(), libraries.end(), [&](const LibDirectoryInfo& lib) { return lib.name == name; }) != libraries.end())
+        {
+            std::cout << "[WARNING] '" << name << "' is already part of this workspace\n";
             continue;
         }
+        const LibDirectoryInfo* found = FindLibrary(name);
+        if (found == nullptr)
+        {
+            std::cout << "[ERR] '" << name << "' was not recognized as a library.";
+            PrintSuggestions(name);
+            return 1;
+        }
+        libraries.push_back(*found);
+    }
 
-        std::string name = entry.path().stem().u8string();
-        if (added.find(name) != added.end())
+    LockFile updated;
+    updated.version = PREMAKE_GEN_VERSION;
+    updated.solution = lock.solution;
+    updated.settings.name = lock.settings.name;
+    updated.settings.kind = lock.settings.kind;
+    updated.settings.targetName = lock.settings.targetName;
+    updated.settings.dialect = lock.settings.dialect;
+    updated.includeExamples = lock.includeExamples;
+    updated.includeBench = lock.includeBench;
+    updated.includeNinja = lock.includeNinja;
+    updated.includeModules = lock.includeModules;
+    updated.mergeIncludes = lock.mergeIncludes;
+    updated.pruneDlls = lock.pruneDlls;
+    updated.isas = lock.isas;
+
+    // Libraries whose source changed since they were copied are refreshed like new ones
+    BeginAllocPhase("info parse");
+    std::vector<const LibDirectoryInfo*> toCopy;
+    size_t refreshed = 0;
+    for (const LibDirectoryInfo& lib : libraries)
+    {
+        if (!ReadLibInfo(updated.settings, lib))
+            return 1;
+
+        const std::string fingerprint = LibraryFingerprint(libDirectory + "/" + lib.name + (lib.isCompressed ? ".zip" : ""), lib.isCompressed);
+        const LockedLibrary* locked = lock.Find(lib.name);
+        if (locked != nullptr && !contains(removed, lib.name) &&
+            locked->isCompressed == lib.isCompressed && locked->fingerprint == fingerprint)
         {
-            std::cout << "[WARNING] Duplicate library \"" + name + "\" found. premake-gen will use the folder version.\n";
+            updated.libraries.push_back(*locked);
             continue;
         }
-        added.insert(name);
-        libManifest.push_back({ name, true });
-    }
-}
 
-void SetLibDir(const std::string& path)
-{
-    if (!std::filesystem::exists(_APPDATA_ + "/premake-gen"))
-        std::filesystem::create_directories(_APPDATA_ + "/premake-gen");
-    if (!std::filesystem::exists(path))
-        std::filesystem::create_directories(path);
+        if (locked != nullptr)
+        {
+            ++refreshed;
+            if (!contains(stale, lib.name))
+                stale.push_back(lib.name);
+        }
+        toCopy.push_back(&lib);
+        LockedLibrary& fresh = updated.libraries.emplace_back();
+        fresh.name = lib.name;
+        fresh.isCompressed = lib.isCompressed;
+        fresh.fingerprint = fingerprint;
+    }
 
-    std::ofstream file(_APPDATA_ + "/premake-gen/settings.info");
-    file << "@libDirectory\n" << path << std::endl;
-}
+    // Dropped links stay dropped while a library still declares them
+    for (const std::string& link : lock.prunedLinks)
+    {
+        if (updated.settings.globalLinks.Contains(link) || updated.settings.debugLinks.Contains(link) || updated.settings.releaseLinks.Contains(link))
+            updated.prunedLinks.Insert(link);
+    }
 
-bool CheckLibDir()
-{
-    if (!std::filesystem::exists(_APPDATA_ + "/premake-gen/settings.info"))
+    BeginAllocPhase("copy");
+    // Plan every library so new files are checked against the ones already in the workspace.
+    // Kept libraries only skip the files they own in the lockfile; a file that lost a conflict is written again.
+    CopyPlan plan(ioLimits.bufferSize);
+    for (size_t i = 0; i < libraries.size(); ++i)
     {
-        std::cout << "No library directory specified. Use '--libdir <directory>' to specify one." << std::endl;
-        return false;
+        const bool kept = std::find(toCopy.begin(), toCopy.end(), &libraries[i]) == toCopy.end();
+        plan.AddLibrary(libraries[i].name, kept ? updated.libraries[i].files : std::vector<std::string>());
+        if (!PlanLibrary(plan, updated.settings.name, libraries[i]))
+            return 1;
     }
+    plan.PrintConflicts();
+    if (updated.pruneDlls && !PruneDlls(plan, LinkedSettings(updated), updated))
+        return 1;
+    for (size_t i = 0; i < libraries.size(); ++i)
+        updated.libraries[i].files = plan.FilesOf((uint32_t)i);
 
-    std::ifstream file(_APPDATA_ + "/premake-gen/settings.info");
+    // Delete what is no longer planned: files only stale libraries own, so files a library no longer
+    // ships don't linger, and DLLs -prune-dlls no longer deploys
+    std::unordered_set<std::string> keep;
+    for (const LockedLibrary& lib : updated.libraries)
+        keep.insert(lib.files.begin(), lib.files.end());
 
-    std::string tag;
-    std::string line;
-    while (std::getline(file, line))
+    std::vector<std::string> obsolete;
+    for (const LockedLibrary& old : lock.libraries)
     {
-        if (line.empty())
-            continue;
-        if (line[0] == '@')
+        for (const std::string& file : old.files)
         {
-            tag = line.substr(1);
-            continue;
+            if (keep.find(file) == keep.end())
+                obsolete.push_back(file);
         }
+    }
 
-        if (tag == "libDirectory")
-        {
-            libDirectory = line;
-        }
+    if (dryRun)
+    {
+        plan.Print();
+        std::cout << obsolete.size() << " stale files would be deleted\n";
+        return 0;
     }
-    return !libDirectory.empty();
-}
 
-void PrintList()
-{
-    std::cout << "\nPremake Generator -- Listing Available Libraries:\n";
-    std::cout << "----------------------------------------------------------------------\n";
-    for (const LibDirectoryInfo& lib : libManifest)
+    size_t deleted = 0;
+    for (const std::string& file : obsolete)
     {
-        std::cout << "- " << ((lib.isCompressed) ? lib.name + " [*]" : lib.name) << std::endl;
+        std::error_code ec;
+        if (std::filesystem::remove(file, ec))
+            ++deleted;
+        RemoveEmptyParents(file, updated.settings.name);
     }
-    std::cout << "----------------------------------------------------------------------\n";
-    std::cout << "[*] = Compressed in ZIP file\n\n";
+
+    std::cout << "Copying " << plan.FileCount() << " library files...\n";
+    if (!plan.Execute(ioLimits, COPY_JOURNAL_NAME))
+        return 1;
+    if (updated.mergeIncludes && !GenerateIncludeTree(updated.settings))
+        return 1;
+
+    // Refreshed libraries already have their example in the workspace, either as Main.cpp or in examples/
+    bool firstExample = !std::filesystem::exists(updated.settings.name + "/Main.cpp");
+    for (const LibDirectoryInfo* lib : toCopy)
+    {
+        if (updated.includeExamples && lock.Find(lib->name) == nullptr && !CopyExample(updated.settings.name, *lib, firstExample))
+            return 1;
+    }
+
+    BeginAllocPhase("premake emit");
+    const ProjectSettings linked = LinkedSettings(updated);
+    if (!GeneratePremakeFile(linked, updated.solution, updated.includeBench, updated.isas, updated.includeModules, updated.mergeIncludes))
+        return 1;
+
+    BeginAllocPhase("other");
+    if (!updated.isas.empty() && !GenerateKernelFiles(updated.settings.name, updated.isas))
+        return 1;
+
+    if (updated.includeModules && !GenerateModuleFiles(updated))
+        return 1;
+
+    if (updated.includeNinja && !GenerateNinjaFiles(linked, updated.includeBench, updated.isas, updated.mergeIncludes))
+        return 1;
+
+    BeginAllocPhase("gitignore");
+    CollectLibFiles(updated);
+    if (!GenerateGitignore())
+        return 1;
+
+    BeginAllocPhase("other");
+    if (!WriteLockFile(LOCK_FILE_NAME, updated))
+    {
+        std::cout << "[ERR] Could not write " << LOCK_FILE_NAME << std::endl;
+        return 1;
+    }
+    std::error_code ec;
+    std::filesystem::remove(COPY_JOURNAL_NAME, ec);
+
+    std::cout << "Updated: " << toCopy.size() - refreshed << " added, " << stale.size() - refreshed << " removed, "
+        << refreshed << " refreshed, " << deleted << " stale files deleted" << std::endl;
+    return 0;
 }
 
-bool IsWhiteSpace(const std::string& str)
+bool IsServedCommand()
 {
-    if (str.empty())
+    if (args.empty())
+        return false;
+    if (args[0] == "-list" || args[0] == "--list" || args[0] == "-update" || args[0] == "--update" ||
+        args[0] == "-verify" || args[0] == "--verify" || args[0] == "-complete" || args[0] == "--complete")
         return true;
-    for (const char c : str)
+    return args.size() >= 2 && args[0][0] != '-';
+}
+
+int Serve()
+{
+    ServerEndpoint endpoint;
+    if (!endpoint.Listen())
     {
-        if (c != ' ' &&
-            c != '\t' &&
-            c != '\n')
-            return false;
+        std::cout << "[ERR] Could not listen on " << ServerEndpoint::Address() << " (is a server already running?)\n";
+        return 1;
     }
-    return true;
+
+    const std::string settingsDirectory = _APPDATA_ + "/premake-gen";
+    const std::filesystem::path startDirectory = std::filesystem::current_path();
+    ChangeWatcher watcher;
+    std::string watchedLibDirectory;
+
+    // Watch before reading anything, so every change after the first scan is seen
+    auto watchLibraries = [&]()
+    {
+        if (!watcher.Watch(settingsDirectory, libDirectory))
+            std::cout << "[WARNING] Could not watch " << libDirectory << " for changes, caching is disabled\n";
+        watchedLibDirectory = libDirectory;
+        PopulateManifest();
+        for (const LibDirectoryInfo& lib : libManifest)
+        {
+            if (!lib.isCompressed)
+                watcher.WatchLibrary(lib.name);
+        }
+    };
+    if (CheckLibDir() && std::filesystem::exists(libDirectory))
+        watchLibraries();
+
+    std::cout << "Serving on " << ServerEndpoint::Address() << ". Stop with 'premake-gen --serve stop'" << std::endl;
+
+    ServerRequest request;
+    while (endpoint.Accept(request))
+    {
+        if (request.args.size() >= 2 && request.args[0] == "--serve" && request.args[1] == "stop")
+        {
+            endpoint.Respond(0, "Server stopped\n");
+            break;
+        }
+
+        std::vector<std::string> changed;
+        if (watcher.Poll(changed))
+            InvalidateAll();
+        for (const std::string& name : changed)
+            InvalidateLibrary(name);
+
+        std::ostringstream output;
+        std::streambuf* console = std::cout.rdbuf(output.rdbuf());
+        const bool hadManifest = manifestLoaded;
+        int exitCode = 1;
+        std::error_code ec;
+        std::filesystem::current_path(request.workingDirectory, ec);
+        if (ec)
+        {
+            std::cout << "[ERR] Could not enter working directory: " << request.workingDirectory << std::endl;
+        }
+        else
+        {
+            args = request.args;
+            ParseConsoleOptions(args);
+            ioLimits = IoLimits();
+            try
+            {
+                // Run expects a command, and a client can send a request without one
+                if (ParseIoOptions())
+                {
+                    if (args.empty())
+                        std::cout << "[ERR] Request has no command" << std::endl;
+                    else
+                        exitCode = Run();
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "[ERR] " << e.what() << std::endl;
+                InvalidateAll();
+            }
+        }
+        std::cout.rdbuf(console);
+        std::filesystem::current_path(startDirectory, ec);
+
+        // A new library directory was only read through this request, so rescan it under its watch.
+        // Folder libraries found by a rescan drop their library.info if it was read before their watch existed.
+        if (!libDirectory.empty() && libDirectory != watchedLibDirectory)
+        {
+            InvalidateAll();
+            if (CheckLibDir())
+                watchLibraries();
+        }
+        else if (!hadManifest && manifestLoaded)
+        {
+            for (const LibDirectoryInfo& lib : libManifest)
+            {
+                if (!lib.isCompressed && watcher.WatchLibrary(lib.name))
+                    libInfoCache.erase(lib.name);
+            }
+        }
+
+        // Don't keep library zips locked between requests
+        for (auto& [name, zipFile] : libZipCache)
+            zipFile->ReleaseFile();
+
+        endpoint.Respond(exitCode, output.str());
+    }
+    return 0;
 }
 
-void CheckAndPush(std::vector<std::string>& vec, const std::string& str)
+void InvalidateAll()
 {
-    if (std::find(vec.begin(), vec.end(), str) != vec.end())
-        return;
+    libDirectory.clear();
+    libManifest.clear();
+    libIndex.Clear();
+    manifestLoaded = false;
+    libInfoCache.clear();
+    libZipCache.clear();
+}
 
-    vec.push_back(str);
+void InvalidateLibrary(const std::string& name)
+{
+    libManifest.clear();
+    libIndex.Clear();
+    manifestLoaded = false;
+    libInfoCache.erase(name);
+    libZipCache.erase(name);
 }
 
-bool ReadLibInfo(ProjectSettings& settings, const LibDirectoryInfo& lib)
+void GenerateLibDir()
 {
-    std::cout << "Reading info for Library: " << lib.name << "\n";
-    
-    return (lib.isCompressed) ?
-        ReadLibInfo_Zip(settings, lib.name) :
-        ReadLibInfo_Folder(settings, lib.name);
+	if (std::filesystem::exists(libDirectory))
+		return;
+
+	std::cout << "Generating Library Directory...\n";
+	std::filesystem::create_directories(libDirectory);
 }
 
-bool ReadLibInfo_Zip(ProjectSettings& settings, const std::string& lib)
+bool CheckPremakeFolder()
 {
-    std::string activeMarker = "";
-    std::string line = "";
+    if (!premakeFolder.empty())
+        return true;
 
-    zipp::ZipReader zipFile(libDirectory + "/" + lib + ".zip");
-    if (!zipFile.IsOpen())
-    {
-        std::cout << "Could not find or read: " << libDirectory + "/" + lib + ".zip" << std::endl;
-        return false;
-    }
+    premakeFolder = PremakePayloadFolder(_APPDATA_ + "/premake-gen/cache");
+    if (!premakeFolder.empty())
+        return true;
 
-    if (!zipFile.Contains("library.info"))
+    const std::string folder = _APPDATA_ + "/premake-gen/premake";
+    if (!std::filesystem::exists(folder))
     {
-        std::cout << "Could not find or read: " << libDirectory + "/" + lib + ".zip/library.info" << std::endl;
+        std::filesystem::create_directories(folder);
+        std::cout << "Copy files from provided \"premake\" folder to \"%APPDATA%\\premake-gen\\premake\"\n";
+        std::cout << "(or build a premake-gen that carries them with \"premake-gen --embed-premake <premake folder> <output>\")\n";
+        system(("explorer \"" + _APPDATA_ + "\\premake-gen\"").c_str());
         return false;
     }
-    zipp::Entry libraryFile = zipFile["library.info"];
-    std::string infoData;
-    infoData.resize(libraryFile.UncompressedSize() + 1, 0);
-    zipFile.ExtractToString("library.info", infoData);
-
-    std::stringstream info(infoData);
+    premakeFolder = folder;
+    return true;
+}
 
-    while (std::getline(info, line))
+// Removes the I/O limit options from args, wherever they appear
+bool ParseIoOptions()
+{
+    for (size_t i = 0; i < args.size();)
     {
-        if (IsWhiteSpace(line))
-            continue;
-
-        if (line[0] == '@')
+        const bool isBuffer = args[i] == "-io-buffer" || args[i] == "--io-buffer";
+        const bool isCap = args[i] == "-max-memory" || args[i] == "--max-memory";
+        if (!isBuffer && !isCap)
         {
-            activeMarker = line.substr(1);
+            ++i;
             continue;
         }
 
-        if (activeMarker == "defines")
-            CheckAndPush(settings.defines, line);
-        else if (activeMarker == "additionalIncludeDirs")
-            CheckAndPush(settings.additionalIncludeDirs, line);
-        else if (activeMarker == "additionalLibDirs")
-            CheckAndPush(settings.additionalLibDirs, line);
-        else if (activeMarker == "debugLinks")
-            CheckAndPush(settings.debugLinks, line);
-        else if (activeMarker == "globalLinks")
-            CheckAndPush(settings.globalLinks, line);
-        else if (activeMarker == "releaseLinks")
-            CheckAndPush(settings.releaseLinks, line);
-        else
+        size_t size = 0;
+        if (i + 1 >= args.size() || !ParseByteSize(args[i + 1], size))
         {
-            std::cout << "[ERR] Unidentified marker '" << activeMarker << "'\n";
+            std::cout << "[ERR] " << args[i] << " needs a size such as 256K or 4M" << std::endl;
             return false;
         }
+        if (isBuffer)
+            ioLimits.bufferSize = size;
+        else
+            ioLimits.memoryCap = size;
+        args.erase(args.begin() + i, args.begin() + i + 2);
     }
 
+    if (ioLimits.bufferSize < 4 * 1024 || ioLimits.bufferSize > 256 * 1024 * 1024)
+    {
+        std::cout << "[ERR] --io-buffer must be between 4K and 256M" << std::endl;
+        return false;
+    }
+    if (ioLimits.memoryCap < ioLimits.bufferSize)
+    {
+        std::cout << "[ERR] --max-memory must be at least the --io-buffer size" << std::endl;
+        return false;
+    }
     return true;
 }
 
-bool ReadLibInfo_Folder(ProjectSettings& settings, const std::string& lib)
+void PrintPeakMemory()
 {
-    std::string activeMarker = "";
-    std::string line = "";
+    const size_t peak = PeakResidentMemory();
+    if (peak > 0)
+        std::cout << "Peak memory: " << (peak + 512 * 1024) / (1024 * 1024) << " MB" << std::endl;
+}
 
-    std::ifstream info(libDirectory + "/" + lib + "/library.info");
-    if (!info.is_open())
+void ParseArgs(int argc, char* argv[])
+{
+    path = argv[0];
+    args.resize(argc - 1);
+    for (int i = 1; i < argc; ++i)
     {
-        std::cout << "Could not find or read: " << libDirectory + "/" + lib + "/library.info" << std::endl;
-        return false;
+        args[i - 1] = argv[i];
     }
+}
+
+void PrintHelp()
+{
+    std::cout << "\nPremake Generator -- Help\n";
+    std::cout << "--------------------------------------------------------------------------\n";
+    std::cout << "--help               | You're already here ;)\n";
+    std::cout << "--version            | See version number\n";
+    std::cout << "--list               | Lists all available library names\n";
+    std::cout << "--list --details     | Size, file counts and library.info check of every library\n";
+    std::cout << "                     |     (--sort name|size|compressed|files, --json)\n";
+    std::cout << "--setup              | Instructions on how to setup a new library\n";
+    std::cout << "--libdir             | Open the set library directory\n";
+    std::cout << "--libdir <directory> | Set the library directory\n";
+    std::cout << "--appdata            | Open the AppData directory in File Explorer\n";
+    std::cout << "--pack <folder> [zip]| Validate a library folder and pack it into a zip\n";
+    std::cout << "                     |     optimized for extraction (<folder>.zip by default)\n";
+    std::cout << "--update +Lib -Lib   | Add/remove libraries in the workspace generated in this\n";
+    std::cout << "                     |     directory, copying and deleting only what changed\n";
+    std::cout << "--verify             | Check the library files of the workspace in this\n";
+    std::cout << "                     |     directory against the library zips/folders\n";
+    std::cout << "--prune-links [objs] | Report link entries the built objects (<Project>/int\n";
+    std::cout << "                     |     by default) don't need; --apply drops them\n";
+    std::cout << "--serve              | Keep library data in memory and answer --list and\n";
+    std::cout << "                     |     generation requests from other calls\n";
+    std::cout << "--serve stop         | Stop a running server\n";
+    std::cout << "--ninja              | (Re)generate build.ninja and compile_commands.json\n";
+    std::cout << "                     |     for the workspace in this directory\n";
+    std::cout << "--embed-premake <folder> <output>\n";
+    std::cout << "                     | Write a copy of premake-gen that carries the premake\n";
+    std::cout << "                     |     files of <folder>, so no AppData setup is needed\n";
+    std::cout << "--completion <shell> | Print the bash or zsh completion script\n";
+    std::cout << "--complete <word>    | Print completions for a partial argument\n";
+    std::cout << "---------------------|----------------------------------------------------\n";
+    std::cout << "USAGE: premake-gen <Solution> <Project> <flags>\n\n";
+    std::cout << "-dialect <number>    | C++ version override (17 by default)\n";
+    std::cout << "-example             | includes the first library example file as Main.cpp\n";
+    std::cout << "                     |     with the rest in the 'examples' folder\n";
+    std::cout << "-bench               | adds a '<Project>Bench' micro-benchmark project\n";
+    std::cout << "-verify              | checks every copied library file against its source\n";
+    std::cout << "-ninja               | also writes build.ninja and compile_commands.json\n";
+    std::cout << "-isa <list>          | builds '<Project>/kernels' once per instruction set,\n";
+    std::cout << "                     |     e.g. sse4,avx2,avx512, with a runtime dispatcher\n";
+    std::cout << "-modules             | wraps each library's public headers in a C++20 module\n";
+    std::cout << "                     |     built by '<Project>Modules' (needs -dialect 20)\n";
+    std::cout << "-merge-includes      | links the library include directories into one tree\n";
+    std::cout << "                     |     searched with a single include path\n";
+    std::cout << "-prune-dlls          | only copies the library DLLs the linked import libraries\n";
+    std::cout << "                     |     and built targets need, following their imports\n";
+    std::cout << "--dry-run            | prints the copy plan without writing anything\n";
+    std::cout << "<LibName>            | includes that libarary\n";
+    std::cout << "---------------------|----------------------------------------------------\n";
+    std::cout << "--io-buffer <size>   | Buffer size of every copy/extract stream (256K default)\n";
+    std::cout << "--max-memory <size>  | Cap on all stream buffers together (64M default)\n";
+    std::cout << "--alloc-stats        | Reports heap allocations and peak live heap per phase\n";
+    std::cout << "-q, --quiet          | Prints only warnings and errors\n";
+    std::cout << "-v, --verbose        | Also prints every copied file\n";
+    std::cout << "--json               | Prints messages and progress as JSON events\n";
+    std::cout << "--------------------------------------------------------------------------\n";
+}
 
-    while (std::getline(info, line))
+void PopulateManifest()
+{
+    std::cout << "Finding available libraries...\n";
+    std::unordered_set<std::string> added;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(libDirectory))
     {
-        if (IsWhiteSpace(line))
+        if (!entry.is_regular_file())
+        {
+            std::string name = entry.path().filename().u8string();
+            if (added.find(name) != added.end())
+            {
+                auto iter = std::find_if(libManifest.begin(), libManifest.end(), [&](const LibDirectoryInfo& i) {return i.name == name; });
+                iter->isCompressed = false;
+
+                std::cout << "[WARNING] Duplicate library \"" + name + "\" found. premake-gen will use the folder version.\n";
+                continue;
+            }
+            added.insert(name);
+            libManifest.push_back({ name, false });
             continue;
+        }
 
-        if (line[0] == '@')
+        if (!entry.path().has_extension() || entry.path().extension() != ".zip")
         {
-            activeMarker = line.substr(1);
+            std::cout << "[WARNING] Incompatible file in library directory: \"" + entry.path().filename().u8string() + "\". Ignoring...\n";
             continue;
         }
 
-        if (activeMarker == "defines")
-            CheckAndPush(settings.defines, line);
-        else if (activeMarker == "additionalIncludeDirs")
-            CheckAndPush(settings.additionalIncludeDirs, line);
-        else if (activeMarker == "additionalLibDirs")
-            CheckAndPush(settings.additionalLibDirs, line);
-        else if (activeMarker == "debugLinks")
-            CheckAndPush(settings.debugLinks, line);
-        else if (activeMarker == "globalLinks")
-            CheckAndPush(settings.globalLinks, line);
-        else if (activeMarker == "releaseLinks")
-            CheckAndPush(settings.releaseLinks, line);
-        else
+        std::string name = entry.path().stem().u8string();
+        if (added.find(name) != added.end())
         {
-            std::cout << "[ERR] Unidentified marker '" << activeMarker << "'\n";
-            return false;
+            std::cout << "[WARNING] Duplicate library \"" + name + "\" found. premake-gen will use the folder version.\n";
+            continue;
         }
+        added.insert(name);
+        libManifest.push_back({ name, true });
     }
 
-    return true;
+    std::vector<std::string> names;
+    names.reserve(libManifest.size());
+    for (const LibDirectoryInfo& lib : libManifest)
+        names.push_back(lib.name);
+    libIndex.Build(names);
+    manifestLoaded = true;
+}
+
+const LibDirectoryInfo* FindLibrary(const std::string& name)
+{
+    const uint32_t id = libIndex.Find(name);
+    return (id != LibraryIndex::npos) ? &libManifest[id] : nullptr;
+}
+
+// Ends the current error line with the closest library names, if any are close
+void PrintSuggestions(const std::string& name)
+{
+    std::vector<uint32_t> ids;
+    libIndex.Suggest(name, 3, ids);
+    for (size_t i = 0; i < ids.size(); ++i)
+        std::cout << ((i == 0) ? " Did you mean '" : (i + 1 == ids.size()) ? "' or '" : "', '") << libManifest[ids[i]].name;
+    std::cout << (ids.empty() ? "" : "'?") << std::endl;
 }
 
-std::string KindString(ProjectKind kind)
+// Prints the candidates for one command line word, one per line: flags for "-...", library names
+// otherwise ("+..." keeps its prefix for --update)
+int Complete()
 {
-    switch (kind)
+    const std::string word = (args.size() >= 2) ? args[1] : "";
+    if (!word.empty() && word[0] == '-')
     {
-    case ProjectKind::ConsoleApp:
-        return "ConsoleApp";
-    case ProjectKind::WindowedApp:
-        return "WindowedApp";
-    case ProjectKind::StaticLib:
-        return "StaticLib";
-    case ProjectKind::SharedLib:
-        return "SharedLib";
+        for (const char* flag : COMPLETION_FLAGS)
+        {
+            if (std::string_view(flag).compare(0, word.size(), word) == 0)
+                std::cout << flag << '\n';
+        }
+        return 0;
     }
-    return "ERR";
+
+    // Anything but candidates would end up on the shell's command line
+    std::ostringstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    if (!manifestLoaded && (!libDirectory.empty() || CheckLibDir()) && std::filesystem::exists(libDirectory))
+        PopulateManifest();
+    std::cout.rdbuf(console);
+
+    const bool isAddition = !word.empty() && word[0] == '+';
+    std::vector<uint32_t> ids;
+    libIndex.Complete(isAddition ? std::string_view(word).substr(1) : std::string_view(word), ids);
+    for (uint32_t id : ids)
+        std::cout << (isAddition ? "+" : "") << libManifest[id].name << '\n';
+    return 0;
 }
 
-bool GeneratePremakeFile(const ProjectSettings& settings, const std::string& solution)
+bool PrintCompletionScript(const std::string& shell)
 {
-    std::cout << "Generating premake5.lua\n";
+    if (shell == "bash")
+        std::cout << BASH_COMPLETION_SCRIPT;
+    else if (shell == "zsh")
+        std::cout << ZSH_COMPLETION_SCRIPT;
+    else
+    {
+        std::cout << "[ERR] Usage: premake-gen --completion <bash|zsh>\n";
+        return false;
+    }
+    return true;
+}
 
-    std::ofstream file("premake5.lua");
-    if (!file.is_open())
+void SetLibDir(const std::string& path)
+{
+    if (!std::filesystem::exists(_APPDATA_ + "/premake-gen"))
+        std::filesystem::create_directories(_APPDATA_ + "/premake-gen");
+    if (!std::filesystem::exists(path))
+        std::filesystem::create_directories(path);
+
+    std::ofstream file(_APPDATA_ + "/premake-gen/settings.info");
+    file << "@libDirectory\n" << path << std::endl;
+}
+
+bool CheckLibDir()
+{
+    if (!std::filesystem::exists(_APPDATA_ + "/premake-gen/settings.info"))
     {
-        std::cout << "[ERR] Could not create or open: " << "premake5.lua\n";
+        std::cout << "No library directory specified. Use '--libdir <directory>' to specify one." << std::endl;
         return false;
     }
 
-    // Workspace
-    file << "workspace \"" << solution << "\"\n";
-    file << R"(architecture "x64"
-    configurations { "Debug", "Release" }
-    outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
+    std::ifstream file(_APPDATA_ + "/premake-gen/settings.info");
 
-)";
-    // Project
-    file << "project \"" << settings.name << "\"\n";
-    file << TAB << "location \"%{prj.name}\"\n";
-    file << TAB << "kind \"" << KindString(settings.kind) << "\"\n";
-    file << TAB << "language \"C++\"\n";
-    file << TAB << "targetname \"" << settings.targetName << "\"\n";
-    file << TAB << "targetdir (\"bin/\".. outputdir)\n";
-    file << TAB << "objdir (\"%{prj.name}/int/\" .. outputdir)\n";
-    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
-    file << TAB << "staticruntime \"Off\"\n\n";
+    std::string tag;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty())
+            continue;
+        if (line[0] == '@')
+        {
+            tag = line.substr(1);
+            continue;
+        }
 
-    //File Types
-	file << TAB << "files\n" << TAB << "{\n";
-	file << TAB + TAB << "\"%{prj.name}/**.h\",\n";
-	file << TAB + TAB << "\"%{prj.name}/**.c\",\n";
-	file << TAB + TAB << "\"%{prj.name}/**.hpp\"\n,";
-	file << TAB + TAB << "\"%{prj.name}/**.cpp\"\n" + TAB << "}\n\n";
+        if (tag == "libDirectory")
+        {
+            libDirectory = line;
+        }
+    }
+    return !libDirectory.empty();
+}
+
+void PrintList()
+{
+    std::cout << "\nPremake Generator -- Listing Available Libraries:\n";
+    std::cout << "----------------------------------------------------------------------\n";
+    for (const LibDirectoryInfo& lib : libManifest)
+    {
+        std::cout << "- " << ((lib.isCompressed) ? lib.name + " [*]" : lib.name) << std::endl;
+    }
+    std::cout << "----------------------------------------------------------------------\n";
+    std::cout << "[*] = Compressed in ZIP file\n\n";
+}
+
+// --list [--details] [--sort name|size|compressed|files] [--json]
+int ListDetails()
+{
+    bool json = false;
+    std::string sortKey = "name";
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        if (args[i] == "-json" || args[i] == "--json")
+        {
+            json = true;
+        }
+        else if ((args[i] == "-sort" || args[i] == "--sort") && i + 1 < args.size())
+        {
+            sortKey = args[++i];
+        }
+        else if (args[i] != "-details" && args[i] != "--details")
+        {
+            std::cout << "[ERR] Unknown --list option: " << args[i] << "\n";
+            std::cout << "Usage: premake-gen --list [--details] [--sort name|size|compressed|files] [--json]\n";
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<LibraryDetails> libraries(libManifest.size());
+    for (size_t i = 0; i < libManifest.size(); ++i)
+    {
+        libraries[i].name = libManifest[i].name;
+        libraries[i].isCompressed = libManifest[i].isCompressed;
+    }
+    InspectLibraries(libDirectory, libraries, ioLimits);
+    if (!SortLibraryDetails(libraries, sortKey))
+    {
+        std::cout << "[ERR] Unknown sort key '" << sortKey << "'. Use name, size, compressed or files\n";
+        return 1;
+    }
+
+    if (json)
+    {
+        std::cout << LibraryDetailsJson(libraries) << std::flush;
+        return 0;
+    }
+    PrintLibraryDetails(libraries);
+    std::cout << "Inspected in " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s\n";
+    return 0;
+}
+
+bool ReadLibInfo(ProjectSettings& settings, const LibDirectoryInfo& lib)
+{
+    std::cout << "Reading info for Library: " << lib.name << "\n";
+
+    auto cached = libInfoCache.find(lib.name);
+    if (cached == libInfoCache.end())
+    {
+        ProjectSettings info;
+        const bool read = (lib.isCompressed) ?
+            ReadLibInfo_Zip(info, lib.name) :
+            ReadLibInfo_Folder(info, lib.name);
+        if (!read)
+            return false;
+
+        bool hasSources = false;
+        if (lib.isCompressed)
+        {
+            const ZipArchive* zipFile = OpenLibZip(lib.name);
+            const uint32_t src = zipFile->Find("src");
+            hasSources = src != ZipArchive::npos && !(*zipFile)[src].isFile;
+        }
+        else
+        {
+            std::error_code ec;
+            hasSources = std::filesystem::is_directory(libDirectory + "/" + lib.name + "/src", ec);
+        }
+        if (hasSources)
+            info.sourceLibraries.Insert(lib.name);
+        cached = libInfoCache.emplace(lib.name, std::move(info)).first;
+    }
+
+    MergeLibInfo(settings, cached->second);
+    return true;
+}
+
+ZipArchive* OpenLibZip(const std::string& lib)
+{
+    auto cached = libZipCache.find(lib);
+    if (cached != libZipCache.end())
+    {
+        cached->second->SetBufferSize(ioLimits.bufferSize);
+        return cached->second.get();
+    }
+
+    std::unique_ptr<ZipArchive> zipFile = std::make_unique<ZipArchive>(libDirectory + "/" + lib + ".zip");
+    if (!zipFile->IsOpen())
+        return nullptr;
+    zipFile->SetBufferSize(ioLimits.bufferSize);
+    return libZipCache.emplace(lib, std::move(zipFile)).first->second.get();
+}
+
+bool ReadLibInfo_Zip(ProjectSettings& settings, const std::string& lib)
+{
+    ZipArchive* openedZip = OpenLibZip(lib);
+    if (openedZip == nullptr)
+    {
+        std::cout << "Could not find or read: " << libDirectory + "/" + lib + ".zip" << std::endl;
+        return false;
+    }
+    ZipArchive& zipFile = *openedZip;
+
+    std::string infoData;
+    const uint32_t libraryFile = zipFile.Find("library.info");
+    if (libraryFile == ZipArchive::npos || !zipFile.ExtractToString(libraryFile, infoData, MAX_LIB_INFO_SIZE))
+    {
+        std::cout << "Could not find or read: " << libDirectory + "/" + lib + ".zip/library.info" << std::endl;
+        return false;
+    }
+
+    std::stringstream info(infoData);
+    return ParseLibInfo(settings, info);
+}
+
+bool ReadLibInfo_Folder(ProjectSettings& settings, const std::string& lib)
+{
+    std::ifstream info(libDirectory + "/" + lib + "/library.info");
+    if (!info.is_open())
+    {
+        std::cout << "Could not find or read: " << libDirectory + "/" + lib + "/library.info" << std::endl;
+        return false;
+    }
+
+    return ParseLibInfo(settings, info);
+}
+
+bool GeneratePremakeFile(const ProjectSettings& settings, const std::string& solution, bool includeBench, const std::vector<std::string>& isas, bool includeModules, bool mergeIncludes)
+{
+    std::cout << "Generating premake5.lua\n";
+
+    std::ostringstream file;
+
+    // Compiler cache lookup for Linux builds
+    file << R"(newoption
+{
+    trigger = "no-ccache",
+    description = "Do not wrap the compiler with ccache/sccache on Linux"
+}
+
+compilercache = nil
+if os.ishost("linux") and not _OPTIONS["no-ccache"] then
+    for _, tool in ipairs({ "ccache", "sccache" }) do
+        if os.pathsearch(tool, os.getenv("PATH")) then
+            compilercache = tool
+            break
+        end
+    end
+end
+
+)";
+    // Workspace
+    file << "workspace \"" << solution << "\"\n";
+    file << R"(architecture "x64"
+    configurations { "Debug", "Release" }
+    outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
+
+)";
+    // Project
+    file << "project \"" << settings.name << "\"\n";
+    file << TAB << "location \"%{prj.name}\"\n";
+    file << TAB << "kind \"" << KindString(settings.kind) << "\"\n";
+    file << TAB << "language \"C++\"\n";
+    file << TAB << "targetname \"" << settings.targetName << "\"\n";
+    file << TAB << "targetdir (\"bin/\".. outputdir)\n";
+    file << TAB << "objdir (\"%{prj.name}/int/\" .. outputdir)\n";
+    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
+    file << TAB << "staticruntime \"Off\"\n\n";
+
+    //File Types
+	file << TAB << "files\n" << TAB << "{\n";
+	file << TAB + TAB << "\"%{prj.name}/**.h\",\n";
+	file << TAB + TAB << "\"%{prj.name}/**.c\",\n";
+	file << TAB + TAB << "\"%{prj.name}/**.hpp\"\n,";
+	file << TAB + TAB << "\"%{prj.name}/**.cpp\"\n" + TAB << "}\n\n";
+
+    // Kernels are built by one project per instruction set instead
+    if (!isas.empty())
+        file << TAB << "removefiles \"%{prj.name}/" << KERNEL_FOLDER << "/**\"\n";
+    const std::vector<std::string> projectLinks = ProjectLinks(settings, isas);
+    if (!projectLinks.empty())
+    {
+        WriteStringList(file, TAB, "links", projectLinks, settings.name);
+        file << '\n';
+    }
+
+    //Include Directories
+    const std::vector<std::string> libraryIncludeDirs = LibraryIncludeDirs(settings, mergeIncludes);
+    file << TAB << "includedirs\n" << TAB << "{\n";
+    for (const std::string& str : libraryIncludeDirs)
+    {
+        file << TAB + TAB << "\"" << str << "\",\n";
+    }
+    file << TAB + TAB << "\"%{prj.name}/src\"\n" << TAB << "}\n\n";
+
+    //Defines
+    if (!settings.defines.empty())
+    {
+        file << TAB << "defines\n" << TAB << "{\n";
+        for (size_t i = 0; i < settings.defines.size(); ++i)
+        {
+            file << TAB + TAB << "\"" << settings.defines[i] << '\"';
+            if (i < settings.defines.size() - 1)
+                file << ',';
+            file << '\n';
+        }
+        file << TAB << "}\n\n";
+    }
+
+    // Library Directories
+    if (settings.additionalLibDirs.empty())
+    {
+        //Cleaner version
+        file << TAB << "libdirs \"%{prj.name}/lib\"\n\n";
+    }
+    else 
+    {
+        // Multiline Version
+        file << TAB << "libdirs\n" << TAB << "{\n";
+        for (const std::string& str : settings.additionalLibDirs)
+        {
+            file << TAB + TAB << "\"" << str << "\",\n";
+        }
+        file << TAB + TAB << "\"%{prj.name}/lib\"\n" << TAB << "}\n\n";
+    }
+
+    //Configurations
+    file << TAB << R"(filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+)";
+    // Modules are built by the Visual Studio projects only; PG_MODULES tells the code it may import them
+    if (includeModules)
+    {
+        file << TAB + TAB << "defines { \"PG_MODULES\" }\n";
+        file << TAB + TAB << "scanformoduledependencies \"true\"\n";
+        file << TAB + TAB << "links { \"" << settings.name << "Modules\" }\n";
+    }
+    //Global Links (platform specific names)
+    if (!settings.globalLinks.empty())
+    {
+        file << TAB + TAB << "links\n" << TAB + TAB << "{\n";
+        for (size_t i = 0; i < settings.globalLinks.size(); ++i)
+        {
+            file << TAB + TAB + TAB << "\"" << settings.globalLinks[i] << '\"';
+            if (i < settings.globalLinks.size() - 1)
+                file << ',';
+            file << '\n';
+        }
+        file << TAB + TAB << "}\n";
+    }
+    file << '\n';
+
+    GenerateLinuxFilter(file, settings, settings.name);
+
+    file << TAB << R"(filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+)";
+    file << '\n';
+    GenerateConfigurationLinks(file, settings.debugLinks, "Debug", settings.name);
+
+    file << TAB << R"(filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
+)";
+    file << '\n';
+    GenerateConfigurationLinks(file, settings.releaseLinks, "Release", settings.name);
+
+    for (const std::string& isa : isas)
+        GenerateKernelProject(file, settings, libraryIncludeDirs, isa);
+    for (const std::string& lib : settings.sourceLibraries)
+        GenerateSourceLibraryProject(file, settings, libraryIncludeDirs, lib);
+    if (includeModules)
+        GenerateModuleProject(file, settings, libraryIncludeDirs);
+
+    if (includeBench)
+        GenerateBenchProject(file, settings, libraryIncludeDirs, isas);
+
+    if (!WriteIfChanged("premake5.lua", file.str()))
+    {
+        std::cout << "[ERR] Could not create or open: " << "premake5.lua\n";
+        return false;
+    }
+    return true;
+}
+
+// Library info paths are written relative to the main project, so "%{prj.name}" has to be pinned
+// to that project's name when they are reused by another project
+std::string PinProjectName(std::string str, const std::string& project)
+{
+    const std::string token = "%{prj.name}";
+    for (size_t pos = str.find(token); pos != std::string::npos; pos = str.find(token, pos + project.length()))
+    {
+        str.replace(pos, token.length(), project);
+    }
+    return str;
+}
+
+void WriteStringList(std::ostream& file, const std::string& indent, const std::string& name, const std::vector<std::string>& list, const std::string& project)
+{
+    file << indent << name << "\n" << indent << "{\n";
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        file << indent + TAB << "\"" << PinProjectName(list[i], project) << '\"';
+        if (i < list.size() - 1)
+            file << ',';
+        file << '\n';
+    }
+    file << indent << "}\n";
+}
+
+// Maps a Windows link name from library.info to the name the GNU linker resolves as lib<name>.a/.so.
+// Returns an empty string for Windows system libraries that have no Linux counterpart.
+std::string LinuxLinkName(std::string link)
+{
+    static const std::unordered_set<std::string> windowsOnly = {
+        "advapi32", "comctl32", "comdlg32", "d3d11", "d3d12", "d3dcompiler", "dbghelp", "dwmapi",
+        "dxgi", "gdi32", "imm32", "kernel32", "ole32", "oleaut32", "setupapi", "shell32", "shlwapi",
+        "user32", "userenv", "uuid", "version", "winmm", "ws2_32", "wsock32", "xinput"
+    };
+
+    for (const std::string ext : { ".lib", ".dll", ".a", ".so" })
+    {
+        if (link.length() > ext.length() && link.compare(link.length() - ext.length(), ext.length(), ext) == 0)
+        {
+            link.erase(link.length() - ext.length());
+            break;
+        }
+    }
+
+    std::string lower = link;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (lower == "opengl32")
+        return "GL";
+    if (windowsOnly.find(lower) != windowsOnly.end())
+        return "";
+
+    // "-l" already adds the "lib" prefix
+    if (link.length() > 3 && link.compare(0, 3, "lib") == 0)
+        link.erase(0, 3);
+    return link;
+}
+
+void GenerateLinuxFilter(std::ostream& file, const ProjectSettings& settings, const std::string& project)
+{
+    std::vector<std::string> links;
+    for (const std::string& link : settings.globalLinks)
+    {
+        std::string name = LinuxLinkName(link);
+        if (!name.empty())
+            CheckAndPush(links, name);
+    }
+
+    file << TAB << "filter \"system:linux\"\n";
+    file << TAB + TAB << "defines { \"LINUX\" }\n";
+    file << TAB + TAB << "pic \"On\"\n";
+    file << TAB + TAB << "linkgroups \"On\"\n"; // static libraries resolve regardless of link order
+    if (!links.empty())
+        WriteStringList(file, TAB + TAB, "links", links, project);
+    file << TAB + TAB << "if compilercache then\n";
+    file << TAB + TAB + TAB << "makesettings { \"CC := \" .. compilercache .. \" $(CC)\", \"CXX := \" .. compilercache .. \" $(CXX)\" }\n";
+    file << TAB + TAB << "end\n\n";
+}
+
+// The links of one configuration, split by system like the global ones: library.info names on Windows and
+// the GNU linker names on Linux, matching what build.ninja links
+void GenerateConfigurationLinks(std::ostream& file, const StringSet& links, const std::string& configuration, const std::string& project)
+{
+    if (links.empty())
+        return;
+
+    std::vector<std::string> linuxLinks;
+    for (const std::string& link : links)
+    {
+        std::string name = LinuxLinkName(link);
+        if (!name.empty())
+            CheckAndPush(linuxLinks, name);
+    }
+
+    file << TAB << "filter { \"configurations:" << configuration << "\", \"system:windows\" }\n";
+    WriteStringList(file, TAB + TAB, "links", links.ToVector(), project);
+    file << '\n';
+    if (!linuxLinks.empty())
+    {
+        file << TAB << "filter { \"configurations:" << configuration << "\", \"system:linux\" }\n";
+        WriteStringList(file, TAB + TAB, "links", linuxLinks, project);
+        file << '\n';
+    }
+}
+
+void GenerateBenchProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::vector<std::string>& isas)
+{
+    std::cout << "Adding benchmark project: " << settings.name + BENCH_PROJECT_SUFFIX << "\n";
+
+    std::vector<std::string> includeDirs = libraryIncludeDirs;
+    includeDirs.push_back(settings.name + "/src");
+    includeDirs.push_back(settings.name + BENCH_PROJECT_SUFFIX);
+
+    std::vector<std::string> libDirs = settings.additionalLibDirs.ToVector();
+    libDirs.push_back(settings.name + "/lib");
+
+    file << "project \"" << settings.name << BENCH_PROJECT_SUFFIX << "\"\n";
+    file << TAB << "location \"%{prj.name}\"\n";
+    file << TAB << "kind \"ConsoleApp\"\n";
+    file << TAB << "language \"C++\"\n";
+    file << TAB << "targetname \"%{prj.name}\"\n";
+    file << TAB << "targetdir (\"bin/\".. outputdir)\n";
+    file << TAB << "objdir (\"%{prj.name}/int/\" .. outputdir)\n";
+    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
+    file << TAB << "staticruntime \"Off\"\n";
+    file << TAB << "debugdir \"" << settings.name << "\"\n\n"; // Library DLLs are copied next to the main project
+
+    file << TAB << "files\n" << TAB << "{\n";
+    file << TAB + TAB << "\"%{prj.name}/**.h\",\n";
+    file << TAB + TAB << "\"%{prj.name}/**.hpp\",\n";
+    file << TAB + TAB << "\"%{prj.name}/**.cpp\"\n" << TAB << "}\n\n";
+
+    WriteStringList(file, TAB, "includedirs", includeDirs, settings.name);
+    file << '\n';
+    const std::vector<std::string> projectLinks = ProjectLinks(settings, isas);
+    if (!projectLinks.empty())
+    {
+        WriteStringList(file, TAB, "links", projectLinks, settings.name);
+        file << '\n';
+    }
+    if (!settings.defines.empty())
+    {
+        WriteStringList(file, TAB, "defines", settings.defines.ToVector(), settings.name);
+        file << '\n';
+    }
+    WriteStringList(file, TAB, "libdirs", libDirs, settings.name);
+    file << '\n';
+
+    file << TAB << R"(filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+)";
+    if (!settings.globalLinks.empty())
+        WriteStringList(file, TAB + TAB, "links", settings.globalLinks.ToVector(), settings.name);
+    file << '\n';
+
+    GenerateLinuxFilter(file, settings, settings.name);
+
+    file << TAB << R"(filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+)";
+    file << '\n';
+    GenerateConfigurationLinks(file, settings.debugLinks, "Debug", settings.name);
+
+    // Optimized, but keeps symbols so profilers can attribute samples
+    file << TAB << R"(filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "Speed"
+		symbols "On"
+)";
+    file << '\n';
+    GenerateConfigurationLinks(file, settings.releaseLinks, "Release", settings.name);
+}
+
+// Static library with the project's kernels/ sources, built for one instruction set in namespace isa_<name>
+void GenerateKernelProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::string& isa)
+{
+    const IsaVariant* variant = FindIsaVariant(isa);
+    const std::string kernels = settings.name + "/" + KERNEL_FOLDER;
+
+    std::vector<std::string> includeDirs = libraryIncludeDirs;
+    includeDirs.push_back(settings.name + "/src");
+
+    std::vector<std::string> defines = settings.defines.ToVector();
+    defines.push_back("PG_ISA=isa_" + isa);
+
+    file << "project \"" << settings.name << "Kernels_" << isa << "\"\n";
+    file << TAB << "location \"" << settings.name << "/int/" << KERNEL_FOLDER << "\"\n";
+    file << TAB << "kind \"StaticLib\"\n";
+    file << TAB << "language \"C++\"\n";
+    file << TAB << "targetdir (\"" << settings.name << "/int/\" .. outputdir .. \"/" << KERNEL_FOLDER << "\")\n";
+    file << TAB << "objdir (\"" << settings.name << "/int/\" .. outputdir .. \"/isa_" << isa << "\")\n";
+    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
+    file << TAB << "staticruntime \"Off\"\n\n";
+
+    file << TAB << "files\n" << TAB << "{\n";
+    file << TAB + TAB << "\"" << kernels << "/**.h\",\n";
+    file << TAB + TAB << "\"" << kernels << "/**.cpp\"\n" << TAB << "}\n\n";
+
+    WriteStringList(file, TAB, "includedirs", includeDirs, settings.name);
+    file << '\n';
+    WriteStringList(file, TAB, "defines", defines, settings.name);
+    file << '\n';
+
+    file << TAB << R"(filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+)";
+    if (!variant->msvcFlags.empty())
+        WriteStringList(file, TAB + TAB, "buildoptions", variant->msvcFlags, settings.name);
+    file << '\n';
+
+    file << TAB << "filter \"system:linux\"\n";
+    file << TAB + TAB << "defines { \"LINUX\" }\n";
+    file << TAB + TAB << "pic \"On\"\n";
+    if (!variant->gccFlags.empty())
+        WriteStringList(file, TAB + TAB, "buildoptions", variant->gccFlags, settings.name);
+    file << TAB + TAB << "if compilercache then\n";
+    file << TAB + TAB + TAB << "makesettings { \"CC := \" .. compilercache .. \" $(CC)\", \"CXX := \" .. compilercache .. \" $(CXX)\" }\n";
+    file << TAB + TAB << "end\n\n";
+
+    file << TAB << R"(filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+)";
+    file << TAB << R"(filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
+
+)";
+}
+
+// Static library that compiles the generated module interface units (and the header units they import)
+// before the main project. Premake only emits module settings for Visual Studio, so it exists on Windows only.
+void GenerateModuleProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs)
+{
+    const std::string modules = settings.name + "/" + MODULE_FOLDER;
+
+    file << "if os.target() == \"windows\" then\n";
+    file << "project \"" << settings.name << "Modules\"\n";
+    file << TAB << "location \"" << settings.name << "/int/" << MODULE_FOLDER << "\"\n";
+    file << TAB << "kind \"StaticLib\"\n";
+    file << TAB << "language \"C++\"\n";
+    file << TAB << "targetdir (\"" << settings.name << "/int/\" .. outputdir .. \"/" << MODULE_FOLDER << "\")\n";
+    file << TAB << "objdir (\"" << settings.name << "/int/\" .. outputdir .. \"/" << MODULE_FOLDER << "/obj\")\n";
+    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
+    file << TAB << "staticruntime \"Off\"\n";
+    file << TAB << "systemversion \"latest\"\n";
+    file << TAB << "scanformoduledependencies \"true\"\n\n";
+
+    file << TAB << "files { \"" << modules << "/**.ixx\" }\n\n";
+
+    WriteStringList(file, TAB, "includedirs", libraryIncludeDirs, settings.name);
+    file << '\n';
+    std::vector<std::string> defines = settings.defines.ToVector();
+    defines.push_back("WIN32");
+    WriteStringList(file, TAB, "defines", defines, settings.name);
+    file << '\n';
+
+    file << TAB << R"(filter "files:**.ixx"
+		compileas "Module"
+
+)";
+    file << TAB << R"(filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+)";
+    file << TAB << R"(filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
+
+)";
+    file << "end\n\n";
+}
+
+// Library include directories that live in <Project>/include, which -merge-includes folds into one tree
+bool IsMergedIncludeDir(const std::string& dir, const std::string& project)
+{
+    const std::string pinned = PinProjectName(dir, project);
+    const std::string include = project + "/include";
+    return pinned.compare(0, include.size(), include) == 0 && (pinned.size() == include.size() || pinned[include.size()] == '/');
+}
+
+// Directories every project of the workspace searches for library headers, in search order and relative
+// to the main project ("%{prj.name}/..."). With mergeIncludes the ones in <Project>/include are replaced
+// by the merged tree; directories elsewhere are kept as they are.
+std::vector<std::string> LibraryIncludeDirs(const ProjectSettings& settings, bool mergeIncludes)
+{
+    std::vector<std::string> dirs;
+    for (const std::string& dir : settings.additionalIncludeDirs)
+    {
+        if (!mergeIncludes || !IsMergedIncludeDir(dir, settings.name))
+            dirs.push_back(dir);
+    }
+    dirs.push_back(mergeIncludes ? "%{prj.name}/" MERGED_INCLUDE_FOLDER : "%{prj.name}/include");
+    return dirs;
+}
+
+bool GenerateIncludeTree(const ProjectSettings& settings)
+{
+    std::vector<std::string> sources;
+    for (const std::string& dir : settings.additionalIncludeDirs)
+    {
+        if (IsMergedIncludeDir(dir, settings.name))
+            sources.push_back(PinProjectName(dir, settings.name));
+    }
+    sources.push_back(settings.name + "/include");
+
+    const std::string root = settings.name + "/" MERGED_INCLUDE_FOLDER;
+    std::cout << "Merging " << sources.size() << " include directories into " << root << "...\n";
+    std::vector<IncludeCollision> collisions;
+    if (!BuildIncludeTree(sources, root, collisions))
+    {
+        std::cout << "[ERR] Could not create the merged include tree: " << root << std::endl;
+        return false;
+    }
+    for (const IncludeCollision& collision : collisions)
+    {
+        std::cout << "[WARNING] Include path collision: \"" << collision.path << "\" in " << collision.winner
+            << " hides the one in " << collision.shadowed << "\n";
+    }
+    return true;
+}
+
+// Projects of this workspace the main (and bench) project links: kernel variants and source libraries
+std::vector<std::string> ProjectLinks(const ProjectSettings& settings, const std::vector<std::string>& isas)
+{
+    std::vector<std::string> links;
+    for (const std::string& isa : isas)
+        links.push_back(settings.name + "Kernels_" + isa);
+    for (const std::string& lib : settings.sourceLibraries)
+        links.push_back(lib);
+    return links;
+}
+
+// Static library built from the "src" tree a library ships, so it compiles in parallel with (and is
+// cached independently of) the main project. It sees the same headers and defines as the main project.
+void GenerateSourceLibraryProject(std::ostream& file, const ProjectSettings& settings, const std::vector<std::string>& libraryIncludeDirs, const std::string& lib)
+{
+    const std::string folder = std::string(SOURCE_LIBRARY_FOLDER) + "/" + lib;
+
+    std::vector<std::string> includeDirs = libraryIncludeDirs;
+    includeDirs.push_back(folder + "/src");
+
+    file << "project \"" << lib << "\"\n";
+    file << TAB << "location \"" << folder << "\"\n";
+    file << TAB << "kind \"StaticLib\"\n";
+    file << TAB << "language \"C++\"\n";
+    file << TAB << "targetdir (\"bin/\" .. outputdir .. \"/" << SOURCE_LIBRARY_FOLDER << "\")\n";
+    file << TAB << "objdir (\"" << folder << "/int/\" .. outputdir)\n";
+    file << TAB << "cppdialect \"C++" << (int)settings.dialect << "\"\n";
+    file << TAB << "staticruntime \"Off\"\n\n";
+
+    file << TAB << "files\n" << TAB << "{\n";
+    file << TAB + TAB << "\"" << folder << "/src/**.h\",\n";
+    file << TAB + TAB << "\"" << folder << "/src/**.hpp\",\n";
+    file << TAB + TAB << "\"" << folder << "/src/**.c\",\n";
+    file << TAB + TAB << "\"" << folder << "/src/**.cpp\"\n" << TAB << "}\n\n";
+
+    WriteStringList(file, TAB, "includedirs", includeDirs, settings.name);
+    file << '\n';
+    if (!settings.defines.empty())
+    {
+        WriteStringList(file, TAB, "defines", settings.defines.ToVector(), settings.name);
+        file << '\n';
+    }
+
+    file << TAB << R"(filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+
+)";
+    file << TAB << "filter \"system:linux\"\n";
+    file << TAB + TAB << "defines { \"LINUX\" }\n";
+    file << TAB + TAB << "pic \"On\"\n";
+    file << TAB + TAB << "if compilercache then\n";
+    file << TAB + TAB + TAB << "makesettings { \"CC := \" .. compilercache .. \" $(CC)\", \"CXX := \" .. compilercache .. \" $(CXX)\" }\n";
+    file << TAB + TAB << "end\n\n";
+
+    file << TAB << R"(filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+)";
+    file << TAB << R"(filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
+
+)";
+}
+
+void CheckLibFile(const std::filesystem::path& file)
+{
+    if (file.extension() != ".lib" && file.extension() != ".dll")
+        return;
+
+    fileManifest.push_back(file.u8string());
+}
+
+bool CopyFiles(const std::string& project, const std::vector<LibDirectoryInfo>& libraries, bool useExamples, bool dryRun, LockFile& lock)
+{
+    std::cout << "Planning library files...\n";
+    CopyPlan plan(ioLimits.bufferSize);
+    const size_t firstLocked = lock.libraries.size();
+    for (const LibDirectoryInfo& lib : libraries)
+    {
+        LockedLibrary& locked = lock.libraries.emplace_back();
+        locked.name = lib.name;
+        locked.isCompressed = lib.isCompressed;
+        locked.fingerprint = LibraryFingerprint(libDirectory + "/" + lib.name + (lib.isCompressed ? ".zip" : ""), lib.isCompressed);
+        plan.AddLibrary(lib.name);
+        if (!PlanLibrary(plan, project, lib))
+            return false;
+    }
+    plan.PrintConflicts();
+    if (lock.pruneDlls && !PruneDlls(plan, lock.settings, lock))
+        return false;
+
+    if (dryRun)
+    {
+        plan.Print();
+        return true;
+    }
+
+    std::cout << "Copying additional premake files...\n";
+    if (!MaterializeFolder(std::filesystem::u8path(premakeFolder), std::filesystem::current_path()))
+        return false;
+
+    std::cout << "Copying " << plan.FileCount() << " library files...\n";
+    if (!plan.Execute(ioLimits, COPY_JOURNAL_NAME))
+        return false;
+    for (size_t i = 0; i < libraries.size(); ++i)
+        lock.libraries[firstLocked + i].files = plan.FilesOf((uint32_t)i);
+
+    bool firstExample = true;
+    for (const LibDirectoryInfo& lib : libraries)
+    {
+        if (useExamples && !CopyExample(project, lib, firstExample))
+            return false;
+    }
+
+    if (!useExamples)
+    {
+        if (!std::filesystem::exists(project))
+            std::filesystem::create_directories(project);
+
+        std::cout << "Generating basic Main file...\n";
+
+        std::ofstream main(project + "/Main.cpp");
+        if (!main.is_open())
+        {
+            std::cout << "[ERR] Couldn't create standard Main file";
+            return false;
+        }
+
+        main << R"(#include <iostream>
+
+int main (int argc, char* argv[])
+{
+    
+    return 0;
+}
+)";
+    }
+
+    return true;
+}
+
+// Adds the include, lib and bin folders of a library the way they are laid out in the project:
+// include/ and lib/ keep their names, the contents of bin/ go next to the project files
+bool PlanLibrary(CopyPlan& plan, const std::string& project, const LibDirectoryInfo& lib)
+{
+    const std::pair<const char*, std::string> folders[] = {
+        { "include", project + "/include" }, { "lib", project + "/lib" }, { "bin", project },
+        { "src", SOURCE_LIBRARY_FOLDER "/" + lib.name + "/src" }
+    };
+    if (lib.isCompressed)
+    {
+        ZipArchive* zipFile = OpenLibZip(lib.name);
+        if (zipFile == nullptr)
+        {
+            std::cout << "Could not find or read: " << libDirectory + "/" + lib.name + ".zip" << std::endl;
+            return false;
+        }
+        for (const auto& [folder, destination] : folders)
+        {
+            const uint32_t root = zipFile->Find(folder);
+            if (root != ZipArchive::npos && !plan.AddZip(*zipFile, root, destination))
+                return false;
+        }
+        return true;
+    }
+
+    for (const auto& [folder, destination] : folders)
+    {
+        const std::filesystem::path source = libDirectory + "/" + lib.name + "/" + folder;
+        if (std::filesystem::exists(source) && !plan.AddFolder(source, destination))
+            return false;
+    }
+    return true;
+}
+
+// The first library example becomes Main.cpp, later ones go to examples/<lib>.cpp
+bool CopyExample(const std::string& project, const LibDirectoryInfo& lib, bool& firstExample)
+{
+    const std::string source = libDirectory + "/" + lib.name + (lib.isCompressed ? ".zip" : "") + "/main.cpp";
+    ZipArchive* zipFile = nullptr;
+    uint32_t example = ZipArchive::npos;
+    if (lib.isCompressed)
+    {
+        zipFile = OpenLibZip(lib.name);
+        if (zipFile == nullptr)
+        {
+            std::cout << "Could not find or read: " << libDirectory + "/" + lib.name + ".zip" << std::endl;
+            return false;
+        }
+        example = zipFile->Find("main.cpp");
+        if (example == ZipArchive::npos)
+            return true;
+    }
+    else if (!std::filesystem::exists(source))
+    {
+        return true;
+    }
+
+    std::string destination = project + "/Main.cpp";
+    if (firstExample)
+    {
+        std::cout << "Generating Main file based on library: " << lib.name << "\n";
+        firstExample = false;
+    }
+    else
+    {
+        std::cout << "More than one example file found. Sending " + lib.name + " example to 'examples/' folder.\n";
+        destination = project + "/../examples/" + lib.name + ".cpp";
+    }
+
+    try
+    {
+        std::filesystem::create_directories(std::filesystem::path(destination).parent_path());
+        if (zipFile != nullptr)
+        {
+            if (!zipFile->ExtractToFile(example, destination))
+                throw std::runtime_error("Could not extract main.cpp");
+        }
+        else
+        {
+            std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing);
+        }
+    }
+    catch (std::exception&)
+    {
+        std::cout << "[ERR] Could not copy file from: " << source << " to " << destination << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VerifyWorkspace(const LockFile& lock)
+{
+    std::cout << "Verifying library files...\n";
+
+    // Plan the sources the way CopyFiles lays them out, so shared and conflicting files resolve the same
+    CopyPlan plan(ioLimits.bufferSize);
+    for (const LockedLibrary& locked : lock.libraries)
+    {
+        const std::string source = libDirectory + "/" + locked.name + (locked.isCompressed ? ".zip" : "");
+        if (LibraryFingerprint(source, locked.isCompressed) != locked.fingerprint)
+        {
+            std::cout << "[WARNING] '" << locked.name << "' changed since it was copied, skipping it. Use --update to refresh it.\n";
+            continue;
+        }
+
+        plan.AddLibrary(locked.name);
+        if (!PlanLibrary(plan, lock.settings.name, { locked.name, locked.isCompressed }))
+            return false;
+    }
+
+    // Only what was actually copied, e.g. not the DLLs -prune-dlls left out
+    std::unordered_set<std::string> copied;
+    for (const LockedLibrary& locked : lock.libraries)
+        copied.insert(locked.files.begin(), locked.files.end());
+    std::unordered_set<std::string> skipped;
+    for (const CopyPlan::File& file : plan.Files())
+    {
+        if (copied.find(file.destination) == copied.end())
+            skipped.insert(file.destination);
+    }
+    plan.Remove(skipped);
+
+    std::vector<VerifyJob> jobs;
+    plan.VerifyJobs(jobs);
+    return VerifyFiles(jobs, ioLimits);
+}
+
+// Workspace relative directories the linker searches, in order
+std::vector<std::string> LibraryDirs(const ProjectSettings& settings)
+{
+    std::vector<std::string> dirs;
+    for (const std::string& dir : settings.additionalLibDirs)
+        dirs.push_back(PinProjectName(dir, settings.name));
+    dirs.push_back(settings.name + "/lib");
+    return dirs;
+}
+
+// File names the linker tries for a link entry in each library directory
+std::vector<std::string> LinkCandidates(const std::string& link)
+{
+    std::string extension = std::filesystem::u8path(link).extension().u8string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == ".lib" || extension == ".a")
+        return { link };
+    return { link + ".lib", "lib" + link + ".a", link + ".a" };
+}
+
+// --prune-links [--apply] [<object file or folder>...]
+// Resolves every link entry of the workspace to the archives in its library directories and drops the
+// ones that define nothing the objects of the main, bench and source library projects (or the archives
+// they pull in) need
+int PruneLinks()
+{
+    LockFile lock;
+    if (!ReadLockFile(LOCK_FILE_NAME, lock))
+    {
+        std::cout << "[ERR] Could not read " << LOCK_FILE_NAME << ". Generate the workspace in this directory first." << std::endl;
+        return 1;
+    }
+
+    bool apply = false;
+    std::vector<std::string> inputs;
+    for (size_t i = 1; i < args.size(); ++i)
+    {
+        if (args[i] == "-apply" || args[i] == "--apply")
+            apply = true;
+        else
+            inputs.push_back(args[i]);
+    }
+
+    // Every linked executable with the folders its objects are built in. Source library projects are
+    // linked into the main and the bench project, so their objects need the link entries as well.
+    std::vector<std::vector<std::string>> executables;
+    if (!inputs.empty())
+        executables.push_back(inputs);
+    else
+    {
+        std::vector<std::string> shared;
+        for (const std::string& lib : lock.settings.sourceLibraries)
+            shared.push_back(std::string(SOURCE_LIBRARY_FOLDER) + "/" + lib + "/int");
+        executables.push_back({ lock.settings.name + "/int" });
+        if (lock.includeBench)
+            executables.push_back({ lock.settings.name + BENCH_PROJECT_SUFFIX + "/int" });
+        for (std::vector<std::string>& folders : executables)
+            folders.insert(folders.end(), shared.begin(), shared.end());
+    }
+
+    // What each executable defines itself and what it needs from the libraries
+    std::vector<SymbolTable> projects;
+    size_t objectCount = 0;
+    for (const std::vector<std::string>& folders : executables)
+    {
+        std::vector<std::string> objects;
+        for (const std::string& input : folders)
+        {
+            std::error_code ec;
+            if (!std::filesystem::is_directory(std::filesystem::u8path(input), ec))
+            {
+                // Object files passed by the user; default folders of projects that aren't built are skipped
+                if (!inputs.empty())
+                    objects.push_back(input);
+                continue;
+            }
+            for (std::filesystem::recursive_directory_iterator iter(std::filesystem::u8path(input), ec), end; !ec && iter != end; iter.increment(ec))
+            {
+                const std::string extension = iter->path().extension().u8string();
+                if (iter->is_regular_file(ec) && (extension == ".obj" || extension == ".o"))
+                    objects.push_back(iter->path().generic_u8string());
+            }
+        }
+        if (objects.empty())
+        {
+            std::cout << "[ERR] No object files found in: " << folders[0] << ". Build the project first or pass its object files." << std::endl;
+            return 1;
+        }
+
+        SymbolTable& project = projects.emplace_back();
+        for (const std::string& object : objects)
+        {
+            SymbolTable table;
+            if (!ReadObjectSymbols(object, table))
+            {
+                std::cout << "[ERR] Could not read the symbols of: " << object << " (objects built for link-time code generation can't be analyzed)" << std::endl;
+                return 1;
+            }
+            project.defined.insert(project.defined.end(), table.defined.begin(), table.defined.end());
+            project.undefined.insert(project.undefined.end(), table.undefined.begin(), table.undefined.end());
+        }
+        objectCount += objects.size();
+    }
+
+    const std::vector<std::string> libDirs = LibraryDirs(lock.settings);
 
-    //Include Directories
-    file << TAB << "includedirs\n" << TAB << "{\n";
-    for (const std::string& str : settings.additionalIncludeDirs)
+    // Archives copied from a library are indexed once per library fingerprint
+    std::unordered_map<std::string, const LockedLibrary*> owners;
+    for (const LockedLibrary& lib : lock.libraries)
     {
-        file << TAB + TAB << "\"" << str << "\",\n";
+        for (const std::string& file : lib.files)
+            owners[file] = &lib;
     }
-    file << TAB + TAB << "\"%{prj.name}/include\",\n";
-    file << TAB + TAB << "\"%{prj.name}/src\"\n" << TAB << "}\n\n";
-
-    //Defines
-    if (!settings.defines.empty())
+    SymbolCache symbols(_APPDATA_ + "/premake-gen/cache/symbols");
+    auto symbolsOf = [&](const std::string& archive)
     {
-        file << TAB << "defines\n" << TAB << "{\n";
-        for (size_t i = 0; i < settings.defines.size(); ++i)
+        const auto owner = owners.find(archive);
+        const LockedLibrary* lib = owner != owners.end() ? owner->second : nullptr;
+        return symbols.Get(archive, lib != nullptr ? lib->name : "", lib != nullptr ? lib->fingerprint : "",
+            [&](SymbolTable& table) { return ReadArchiveSymbols(archive, table); });
+    };
+
+    std::vector<LinkEntry> entries;
+    StringSet links;
+    links.Merge(lock.settings.globalLinks);
+    links.Merge(lock.settings.debugLinks);
+    links.Merge(lock.settings.releaseLinks);
+    for (const std::string& link : links)
+    {
+        LinkEntry& entry = entries.emplace_back();
+        entry.name = link;
+        std::unordered_set<std::string> seen;
+        for (const std::string& dir : libDirs)
         {
-            file << TAB + TAB << "\"" << settings.defines[i] << '\"';
-            if (i < settings.defines.size() - 1)
-                file << ',';
-            file << '\n';
+            for (const std::string& candidate : LinkCandidates(link))
+            {
+                const std::string archive = (std::filesystem::u8path(dir) / std::filesystem::u8path(candidate)).lexically_normal().generic_u8string();
+                std::error_code ec;
+                if (!std::filesystem::is_regular_file(std::filesystem::u8path(archive), ec) || !seen.insert(archive).second)
+                    continue;
+
+                const SymbolTable* table = symbolsOf(archive);
+                if (table != nullptr)
+                    entry.archives.push_back(table);
+                else
+                    entry.unreadable = true;
+            }
         }
-        file << TAB << "}\n\n";
     }
 
-    // Library Directories
-    if (settings.additionalLibDirs.empty())
+    // Debug and release link separately, each with the global entries first
+    std::vector<std::vector<std::string>> configurations;
+    for (const StringSet* configLinks : { &lock.settings.debugLinks, &lock.settings.releaseLinks })
     {
-        //Cleaner version
-        file << TAB << "libdirs \"%{prj.name}/lib\"\n\n";
+        StringSet configuration;
+        configuration.Merge(lock.settings.globalLinks);
+        configuration.Merge(*configLinks);
+        std::vector<std::string>& names = configurations.emplace_back();
+        for (const std::string& link : configuration)
+            names.push_back(link);
     }
-    else 
+    for (const SymbolTable& project : projects)
+        ResolveLinks(project, configurations, entries);
+
+    if (!symbols.Save())
+        std::cout << "[WARNING] Could not write the symbol cache in " << _APPDATA_ << "/premake-gen/cache/symbols\n";
+
+    std::cout << "Checked " << entries.size() << " link entries against " << objectCount << " object files:\n";
+    StringSet unused;
+    for (const LinkEntry& entry : entries)
     {
-        // Multiline Version
-        file << TAB << "libdirs\n" << TAB << "{\n";
-        for (const std::string& str : settings.additionalLibDirs)
+        std::cout << "  " << entry.name << ": ";
+        if (entry.used)
+            std::cout << "used\n";
+        else if (entry.unreadable)
+            std::cout << "kept, its library could not be read\n";
+        else if (entry.archives.empty())
+            std::cout << "kept, not in the library directories (system library)\n";
+        else if (entry.opaque)
+            std::cout << "kept, a used library has members that can't be analyzed\n";
+        else
         {
-            file << TAB + TAB << "\"" << str << "\",\n";
+            std::cout << "resolves nothing\n";
+            unused.Insert(entry.name);
         }
-        file << TAB + TAB << "\"%{prj.name}/lib\"\n" << TAB << "}\n\n";
     }
 
-    //Global Links
-    if (!settings.globalLinks.empty())
+    if (!apply)
     {
-        file << TAB << "links\n" << TAB << "{\n";
-        for (size_t i = 0; i < settings.globalLinks.size(); ++i)
-        {
-            file << TAB + TAB << "\"" << settings.globalLinks[i] << '\"';
-            if (i < settings.globalLinks.size() - 1)
-                file << ',';
-            file << '\n';
-        }
-        file << TAB << "}\n\n";
+        if (!unused.empty())
+            std::cout << unused.size() << " link entries resolve nothing. Run 'premake-gen --prune-links --apply' to drop them.\n";
+        return 0;
     }
-    
-    //Configurations
-    file << TAB << R"(filter "system:windows"
-		systemversion "latest"
-		defines { "WIN32" }
 
-	filter "configurations:Debug"
-		defines { "_DEBUG", "_CONSOLE" }
-		symbols "On"
-)";
-    if (!settings.debugLinks.empty())
+    lock.prunedLinks = unused;
+    const ProjectSettings linked = LinkedSettings(lock);
+    if (!GeneratePremakeFile(linked, lock.solution, lock.includeBench, lock.isas, lock.includeModules, lock.mergeIncludes))
+        return 1;
+    if (lock.includeNinja && !GenerateNinjaFiles(linked, lock.includeBench, lock.isas, lock.mergeIncludes))
+        return 1;
+    if (!WriteLockFile(LOCK_FILE_NAME, lock))
     {
-        file << TAB + TAB << "links\n" << TAB + TAB << "{\n";
-        for (size_t i = 0; i < settings.debugLinks.size(); ++i)
-        {
-            file << TAB + TAB + TAB << "\"" << settings.debugLinks[i] << '\"';
-            if (i < settings.debugLinks.size() - 1)
-                file << ',';
-            file << '\n';
-        }
-        file << TAB + TAB<< "}\n";
+        std::cout << "[ERR] Could not write " << LOCK_FILE_NAME << std::endl;
+        return 1;
     }
-    file << '\n';
+    std::cout << "Dropped " << unused.size() << " link entries from the generated projects" << std::endl;
+    return 0;
+}
 
-    file << TAB << R"(filter "configurations:Release"
-		defines { "NDEBUG", "_CONSOLE" }
-		optimize "On"
-)";
-    if (!settings.releaseLinks.empty())
+// The merged settings of the lock without the link entries --prune-links dropped
+ProjectSettings LinkedSettings(const LockFile& lock)
+{
+    ProjectSettings settings = lock.settings;
+    for (StringSet* links : { &settings.globalLinks, &settings.debugLinks, &settings.releaseLinks })
     {
-        file << TAB + TAB << "links\n" << TAB + TAB << "{\n";
-        for (size_t i = 0; i < settings.releaseLinks.size(); ++i)
+        StringSet kept;
+        for (const std::string& link : *links)
         {
-            file << TAB + TAB + TAB << "\"" << settings.releaseLinks[i] << '\"';
-            if (i < settings.releaseLinks.size() - 1)
-                file << ',';
-            file << '\n';
+            if (!lock.prunedLinks.Contains(link))
+                kept.Insert(link);
         }
-        file << TAB + TAB << "}\n\n";
+        *links = kept;
     }
-
-    return true;
+    return settings;
 }
 
-void CheckLibFile(const std::filesystem::path& file)
+// -prune-dlls: of the DLLs that bin/ folders put next to the project files, only copy the ones something
+// needs. The roots are the DLLs the linked import libraries bind to and the imports of targets already
+// built into bin/; the import tables of the planned DLLs are followed from there. DLLs that are only
+// loaded at runtime (plugins) are not seen, and bin/ subfolders are always copied.
+bool PruneDlls(CopyPlan& plan, const ProjectSettings& settings, const LockFile& lock)
 {
-    if (file.extension() != ".lib" && file.extension() != ".dll")
-        return;
-
-    fileManifest.push_back(file.u8string());
-}
+    auto lower = [](std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return text;
+    };
 
-bool DoCopy_Zip(zipp::ZipReader& zipFile, const zipp::Path& source, const std::filesystem::path& destination)
-{
-    try
+    std::unordered_map<std::string, const CopyPlan::File*> deployable;
+    for (const CopyPlan::File& file : plan.Files())
     {
-        std::filesystem::create_directories(destination);
+        const std::filesystem::path destination = std::filesystem::u8path(file.destination);
+        if (destination.parent_path().generic_u8string() == settings.name && lower(destination.extension().u8string()) == ".dll")
+            deployable.emplace(lower(destination.filename().u8string()), &file);
+    }
+    if (deployable.empty())
+        return true;
 
-        auto lambda = [&](const zipp::Entry& dirEntry, void* userData)
+    // The import libraries are read from their sources, since they aren't copied yet
+    std::vector<std::string> pending;
+    SymbolCache symbols(_APPDATA_ + "/premake-gen/cache/symbols");
+    StringSet links;
+    links.Merge(settings.globalLinks);
+    links.Merge(settings.debugLinks);
+    links.Merge(settings.releaseLinks);
+    for (const std::string& link : links)
+    {
+        for (const std::string& dir : LibraryDirs(settings))
+        {
+            for (const std::string& candidate : LinkCandidates(link))
             {
-                const zipp::Path& path = dirEntry.GetPath();
-                std::filesystem::path dst = std::filesystem::path(destination.string() + "/" + dirEntry.GetPath().SubDirectory(1).AsString());
-
-                if (!dirEntry.IsFile())
+                const std::string archive = (std::filesystem::u8path(dir) / std::filesystem::u8path(candidate)).lexically_normal().generic_u8string();
+                const CopyPlan::File* planned = plan.Find(archive);
+                const SymbolTable* table = nullptr;
+                std::error_code ec;
+                if (planned != nullptr)
+                {
+                    const LockedLibrary* lib = lock.Find(plan.LibraryName(planned->owners.front()));
+                    table = symbols.Get(archive, lib != nullptr ? lib->name : "", lib != nullptr ? lib->fingerprint : "", [&](SymbolTable& read)
+                        {
+                            // Streamed, so only the member being parsed is in memory
+                            ArchiveSymbolReader reader;
+                            return plan.ReadSource(*planned, [](const uint8_t* bytes, size_t size, void* userData)
+                                {
+                                    return static_cast<ArchiveSymbolReader*>(userData)->Feed(bytes, size);
+                                }, &reader) && reader.Finish(read);
+                        });
+                }
+                else if (std::filesystem::is_regular_file(std::filesystem::u8path(archive), ec))
                 {
-                    std::filesystem::create_directories(dst);
+                    table = symbols.Get(archive, "", "", [&](SymbolTable& read) { return ReadArchiveSymbols(archive, read); });
                 }
                 else
                 {
-                    CheckLibFile(path.Name().AsString());
-                    zipFile.ExtractToFile(dirEntry, dst.u8string());
+                    continue;
+                }
+
+                if (table == nullptr)
+                {
+                    std::cout << "[WARNING] Could not read " << archive << ", copying every library DLL\n";
+                    return true;
                 }
-            };
-        zipFile.RecursiveCallback(source, lambda, nullptr, false);
+                pending.insert(pending.end(), table->dlls.begin(), table->dlls.end());
+            }
+        }
     }
-    catch (std::exception&)
+    if (!symbols.Save())
+        std::cout << "[WARNING] Could not write the symbol cache in " << _APPDATA_ << "/premake-gen/cache/symbols\n";
+
+    std::error_code ec;
+    for (std::filesystem::recursive_directory_iterator iter("bin", ec), end; !ec && iter != end; iter.increment(ec))
     {
-        std::cout << "[ERR] Could not copy files from: " << source << " to " << destination << std::endl;
-        return false;
+        const std::string extension = lower(iter->path().extension().u8string());
+        std::vector<std::string> imports;
+        if (iter->is_regular_file(ec) && (extension == ".exe" || extension == ".dll") && ReadPeImports(iter->path().u8string(), imports))
+            pending.insert(pending.end(), imports.begin(), imports.end());
     }
-    return true;
-}
 
-bool DoCopy_Folder(const std::filesystem::path& source, const std::filesystem::path& destination)
-{
-    try
+    // Anything not deployable is a system DLL or comes from elsewhere
+    std::unordered_set<std::string> needed;
+    while (!pending.empty())
     {
-        std::filesystem::create_directories(destination);
-
-        for (const std::filesystem::directory_entry& dirEntry : std::filesystem::recursive_directory_iterator(source))
-        {
-            const std::filesystem::path& path = dirEntry.path();
-            std::string relativePathStr = path.string().substr(source.string().length());
-            std::filesystem::path dst = std::filesystem::path(destination.string() + relativePathStr);
+        const std::string dll = pending.back();
+        pending.pop_back();
+        const auto found = deployable.find(dll);
+        if (found == deployable.end() || !needed.insert(dll).second)
+            continue;
 
-            if (std::filesystem::is_directory(path))
+        PeImportReader reader;
+        plan.ReadSource(*found->second, [](const uint8_t* bytes, size_t size, void* userData)
             {
-                std::filesystem::create_directories(dst);
-            }
-            else
-            {
-                CheckLibFile(path.filename());
-                std::filesystem::copy_file(path, dst, std::filesystem::copy_options::overwrite_existing);
-            }
+                return static_cast<PeImportReader*>(userData)->Feed(bytes, size);
+            }, &reader);
+        std::vector<std::string> imports;
+        if (!reader.Finish(imports))
+        {
+            std::cout << "[WARNING] Could not read the imports of " << found->second->destination << ", copying every library DLL\n";
+            return true;
         }
+        pending.insert(pending.end(), imports.begin(), imports.end());
     }
-    catch (std::exception&)
+
+    std::unordered_set<std::string> skipped;
+    uint64_t skippedBytes = 0;
+    for (const auto& [name, file] : deployable)
     {
-        std::cout << "[ERR] Could not copy files from: " << source << " to " << destination << std::endl;
-        return false;
+        if (needed.find(name) != needed.end())
+            continue;
+        skipped.insert(file->destination);
+        skippedBytes += file->size;
+        VerboseLine("  skipping " + file->destination);
     }
+    std::cout << "Deploying " << needed.size() << " of " << deployable.size() << " library DLLs, skipping "
+        << (skippedBytes + 512 * 1024) / (1024 * 1024) << " MB\n";
+    plan.Remove(skipped);
     return true;
 }
 
-bool CopyFiles(const std::string& project, const std::vector<LibDirectoryInfo>& libraries, bool useExamples)
+bool GenerateBenchFiles(const std::string& project)
 {
-    std::cout << "Copying additional premake files...\n";
-    if (!DoCopy_Folder(_APPDATA_ + "\\premake-gen\\premake", std::filesystem::current_path()))
-        return false;
+    std::cout << "Generating benchmark harness...\n";
 
-    bool firstExample = true;
-    for (const LibDirectoryInfo& lib : libraries)
-    {
-        if (lib.isCompressed)
-        {
-            if (!CopyFiles_Zip(project, lib.name, useExamples, firstExample))
-                return false;
-        }
-        else
-        {
-            if (!CopyFiles_Folder(project, lib.name, useExamples, firstExample))
-                return false;
-        }
-    }
+    if (!std::filesystem::exists(project))
+        std::filesystem::create_directories(project);
 
-    if (!useExamples)
+    std::ofstream harness(project + "/Bench.h");
+    if (!harness.is_open())
     {
-        if (!std::filesystem::exists(project))
-            std::filesystem::create_directories(project);
+        std::cout << "[ERR] Couldn't create benchmark harness: " << project + "/Bench.h" << std::endl;
+        return false;
+    }
+    harness << BENCH_HARNESS_HEADER;
 
-        std::cout << "Generating basic Main file...\n";
+    // Keep benchmarks the user has already written
+    if (std::filesystem::exists(project + "/Main.cpp"))
+        return true;
 
-        std::ofstream main(project + "/Main.cpp");
-        if (!main.is_open())
-        {
-            std::cout << "[ERR] Couldn't create standard Main file";
-            return false;
-        }
+    std::ofstream main(project + "/Main.cpp");
+    if (!main.is_open())
+    {
+        std::cout << "[ERR] Couldn't create benchmark Main file";
+        return false;
+    }
+    main << BENCH_MAIN_SOURCE;
 
-        main << R"(#include <iostream>
+    return true;
+}
 
-int main (int argc, char* argv[])
+bool GenerateLinuxScript()
 {
-    
-    return 0;
-}
-)";
+    std::cout << "Generating generate-linux.sh...\n";
+    std::ofstream file("generate-linux.sh", std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "[ERR] Could not create or open: " << "generate-linux.sh\n";
+        return false;
     }
 
+    file << R"(#!/bin/sh
+# Generates Linux build files for this workspace.
+# Usage: ./generate-linux.sh [action] [premake options]
+#   action defaults to gmake2 (use "ninja" if your premake has the ninja module)
+#   --no-ccache disables wrapping the compiler with ccache/sccache
+
+ACTION=${1:-gmake2}
+[ $# -gt 0 ] && shift
+
+if [ -x ./premake5 ]; then
+    PREMAKE=./premake5
+elif command -v premake5 >/dev/null 2>&1; then
+    PREMAKE=premake5
+else
+    echo "premake5 not found. Place a Linux premake5 binary next to this script or on PATH." >&2
+    exit 1
+fi
+
+"$PREMAKE" --os=linux "$@" "$ACTION"
+)";
+    file.close();
+
+    std::error_code ec;
+    std::filesystem::permissions("generate-linux.sh",
+        std::filesystem::perms::owner_exec | std::filesystem::perms::group_exec | std::filesystem::perms::others_exec,
+        std::filesystem::perm_options::add, ec);
+
     return true;
 }
 
-bool CopyFiles_Zip(const std::string& project, const std::string& lib, bool useExamples, bool& firstExample)
+// build.ninja and compile_commands.json for the same projects premake5.lua describes, with the
+// library.info paths pinned to the main project and links mapped for the host platform
+bool GenerateNinjaFiles(const ProjectSettings& settings, bool includeBench, const std::vector<std::string>& isas, bool mergeIncludes)
 {
-    std::cout << "Copying required files for library: " << lib << "\n";
+    std::cout << "Generating build.ninja and compile_commands.json...\n";
 
-    zipp::ZipReader zipFile(libDirectory + "/" + lib + ".zip");
-    if (!zipFile.IsOpen())
+    auto pinned = [&](const StringSet& list)
     {
-        std::cout << "Could not find or read: " << libDirectory + "/" + lib + ".zip" << std::endl;
-        return false;
-    }
-
-    if (zipFile.Contains("include"))
+        std::vector<std::string> result;
+        for (const std::string& str : list)
+            result.push_back(PinProjectName(str, settings.name));
+        return result;
+    };
+    auto platformLinks = [&](const StringSet& list)
     {
-        if (!DoCopy_Zip(zipFile, zipp::Path("include"), project + "/include"))
-            return false;
-    }
-    if (zipFile.Contains("lib"))
+        std::vector<std::string> links;
+        for (const std::string& link : pinned(list))
+        {
+#ifdef _WIN32
+            CheckAndPush(links, link);
+#else
+            const std::string name = LinuxLinkName(link);
+            if (!name.empty())
+                CheckAndPush(links, name);
+#endif
+        }
+        return links;
+    };
+
+    std::vector<NinjaProject> projects;
+    NinjaProject& project = projects.emplace_back();
+    project.name = settings.name;
+    project.kind = settings.kind;
+    project.targetName = PinProjectName(settings.targetName, settings.name);
+    project.dialect = settings.dialect;
+    std::vector<std::string> libraryIncludeDirs;
+    for (const std::string& dir : LibraryIncludeDirs(settings, mergeIncludes))
+        libraryIncludeDirs.push_back(PinProjectName(dir, settings.name));
+    project.includeDirs = libraryIncludeDirs;
+    project.includeDirs.push_back(settings.name + "/src");
+    project.libDirs = pinned(settings.additionalLibDirs);
+    project.libDirs.push_back(settings.name + "/lib");
+    project.defines = pinned(settings.defines);
+    project.links = platformLinks(settings.globalLinks);
+    project.debugLinks = platformLinks(settings.debugLinks);
+    project.releaseLinks = platformLinks(settings.releaseLinks);
+    project.isas = isas;
+    project.kernelFolder = settings.name + "/" + KERNEL_FOLDER;
+    project.projectLinks = settings.sourceLibraries.ToVector();
+
+    if (includeBench)
     {
-        if (!DoCopy_Zip(zipFile, zipp::Path("lib"), project + "/lib"))
-            return false;
+        NinjaProject bench = project;
+        bench.name = settings.name + BENCH_PROJECT_SUFFIX;
+        bench.kind = ProjectKind::ConsoleApp;
+        bench.targetName = bench.name;
+        bench.compileC = false;
+        bench.releaseSymbols = true;
+        bench.includeDirs.push_back(bench.name);
+        projects.push_back(std::move(bench));
     }
-    if (zipFile.Contains("bin"))
+
+    for (const std::string& lib : settings.sourceLibraries)
     {
-        if (!DoCopy_Zip(zipFile, zipp::Path("bin"), project))
-            return false;
+        NinjaProject& libProject = projects.emplace_back();
+        libProject.name = lib;
+        libProject.folder = std::string(SOURCE_LIBRARY_FOLDER) + "/" + lib;
+        libProject.kind = ProjectKind::StaticLib;
+        libProject.targetName = lib;
+        libProject.dialect = settings.dialect;
+        libProject.includeDirs = libraryIncludeDirs;
+        libProject.includeDirs.push_back(libProject.folder + "/src");
+        libProject.defines = pinned(settings.defines);
     }
-    if (zipFile.Contains("main.cpp"))
-    {
-        if (firstExample)
-        {
-            std::cout << "Generating Main file based on library: " << lib << "\n";
 
-            firstExample = false;
-            try
-            {
-                zipFile.ExtractToFile("main.cpp", project + "/Main.cpp");
-            }
-            catch (std::exception)
-            {
-                std::cout << "[ERR] Could not copy file from: " << libDirectory + "/" + lib + ".zip/main.cpp" << " to " << project + "/Main.cpp" << "" << std::endl;
-                return false;
-            }
-        }
-        else
-        {
-            std::cout << "More than one example file found. Sending " + lib + " example to 'examples/' folder.\n";
-            try
-            {
-                std::filesystem::create_directories(project + "/../examples");
-                zipFile.ExtractToFile("main.cpp", project + "/../examples/" + lib + ".cpp");
-            }
-            catch (std::exception)
-            {
-                std::cout << "[ERR] Could not copy file from: " << libDirectory + "/" + lib + "/main.cpp" << " to " << project + "/" + lib + ".cpp" << std::endl;
-                return false;
-            }
-        }
+    std::string ninja;
+    std::string compileCommands;
+    BuildNinjaFiles(projects, ninja, compileCommands);
+    if (!WriteIfChanged("build.ninja", ninja) || !WriteIfChanged("compile_commands.json", compileCommands))
+    {
+        std::cout << "[ERR] Could not write build.ninja or compile_commands.json\n";
+        return false;
     }
     return true;
 }
 
-bool CopyFiles_Folder(const std::string& project, const std::string& lib, bool useExamples, bool& firstExample)
+// kernels/Dispatch.h is owned by premake-gen and rewritten on every run. An empty kernels/ folder gets an
+// example kernel, which belongs to the user from then on.
+bool GenerateKernelFiles(const std::string& project, const std::vector<std::string>& isas)
 {
-    std::cout << "Copying required files for library: " << lib << "\n";
+    std::cout << "Generating " << KERNEL_FOLDER << "/" << DISPATCH_HEADER_NAME << " for: ";
+    for (size_t i = 0; i < isas.size(); ++i)
+        std::cout << (i == 0 ? "" : ", ") << isas[i];
+    std::cout << "\n";
+
+    const std::string folder = project + "/" + KERNEL_FOLDER;
+    std::error_code ec;
+    std::filesystem::create_directories(folder, ec);
+    if (!WriteIfChanged(folder + "/" + DISPATCH_HEADER_NAME, DispatchHeader(isas)))
+    {
+        std::cout << "[ERR] Could not create or open: " << folder << "/" << DISPATCH_HEADER_NAME << "\n";
+        return false;
+    }
 
-    if (std::filesystem::exists(libDirectory + "/" + lib + "/include"))
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(folder, ec))
     {
-        if (!DoCopy_Folder(libDirectory + "/" + lib + "/include", project + "/include"))
-            return false;
+        if (entry.path().extension() == ".cpp")
+            return true;
+    }
+
+    std::ofstream header(folder + "/Kernels.h");
+    header << R"(#pragma once
+
+#include "Dispatch.h"
+
+#include <cstddef>
+
+// Hot loops built once per instruction set; call them as kernels::Scale(...)
+PG_DECLARE_KERNEL(void, Scale, float* data, size_t count, float factor)
+)";
+    std::ofstream source(folder + "/Scale.cpp");
+    source << R"(#include "Kernels.h"
+
+// Compiled once per -isa variant; the compiler vectorizes the loop for each instruction set
+namespace PG_ISA
+{
+    void Scale(float* data, size_t count, float factor)
+    {
+        for (size_t i = 0; i < count; ++i)
+            data[i] *= factor;
     }
-    if (std::filesystem::exists(libDirectory + "/" + lib + "/lib"))
+}
+)";
+    if (!header || !source)
     {
-        if (!DoCopy_Folder(libDirectory + "/" + lib + "/lib", project + "/lib"))
-            return false;
+        std::cout << "[ERR] Could not create the example kernel in " << folder << "\n";
+        return false;
     }
-    if (std::filesystem::exists(libDirectory + "/" + lib + "/bin"))
+    return true;
+}
+
+// Module names allow letters, digits, '_' and '.'; anything else in a library name becomes '_'
+std::string ModuleName(const std::string& lib)
+{
+    std::string name = lib;
+    for (char& c : name)
     {
-        if (!DoCopy_Folder(libDirectory + "/" + lib + "/bin", project))
-            return false;
+        if (!std::isalnum((unsigned char)c) && c != '_' && c != '.')
+            c = '_';
     }
-    if (useExamples && std::filesystem::exists(libDirectory + "/" + lib + "/main.cpp"))
+    if (name.empty() || std::isdigit((unsigned char)name[0]))
+        name.insert(0, "lib_");
+    return name;
+}
+
+// Writes <Project>/modules/<LibName>.ixx for every library with public headers: a named module that
+// re-exports them as header units. The headers are the ones the library lists under @modules, or else
+// its shallowest headers in include/ (usually the umbrella headers). Units of removed libraries are deleted.
+bool GenerateModuleFiles(const LockFile& lock)
+{
+    const std::string marker = "// Generated by premake-gen -modules";
+    const std::string includePrefix = lock.settings.name + "/include/";
+    const std::filesystem::path folder = std::filesystem::u8path(lock.settings.name + "/" + MODULE_FOLDER);
+    std::error_code ec;
+    std::filesystem::create_directories(folder, ec);
+
+    std::cout << "Generating module interface units...\n";
+    std::unordered_set<std::string> written;
+    for (const LockedLibrary& lib : lock.libraries)
     {
-        if (firstExample)
+        std::vector<std::string> listed;
+        std::vector<std::string> shallowest;
+        size_t minDepth = SIZE_MAX;
+        for (const std::string& file : lib.files)
         {
-            std::cout << "Generating Main file based on library: " << lib << "\n";
+            const std::string extension = std::filesystem::u8path(file).extension().u8string();
+            if (file.compare(0, includePrefix.size(), includePrefix) != 0 ||
+                (extension != ".h" && extension != ".hpp" && extension != ".hh" && extension != ".hxx"))
+                continue;
 
-            firstExample = false;
-            try
-            {
-                std::filesystem::copy_file(libDirectory + "/" + lib + "/main.cpp", project + "/Main.cpp");
-            }
-            catch (std::exception e)
+            const std::string header = file.substr(includePrefix.size());
+            if (lock.settings.modules.Contains(header))
+                listed.push_back(header);
+
+            const size_t depth = std::count(header.begin(), header.end(), '/');
+            if (depth < minDepth)
             {
-                std::cout << "[ERR] Could not copy file from: " << libDirectory + "/" + lib + "/main.cpp" << " to " << project + "/Main.cpp" << "" << std::endl;
-                return false;
+                minDepth = depth;
+                shallowest.clear();
             }
+            if (depth == minDepth)
+                shallowest.push_back(header);
         }
-        else
+
+        std::vector<std::string>& headers = listed.empty() ? shallowest : listed;
+        if (headers.empty())
+            continue;
+        std::sort(headers.begin(), headers.end());
+
+        std::ostringstream unit;
+        unit << marker << " from the public headers of " << lib.name << "; rewritten on every update\n";
+        unit << "export module " << ModuleName(lib.name) << ";\n\n";
+        for (const std::string& header : headers)
+            unit << "export import \"" << header << "\";\n";
+
+        const std::string fileName = lib.name + ".ixx";
+        written.insert(fileName);
+        if (!WriteIfChanged((folder / std::filesystem::u8path(fileName)).u8string(), unit.str()))
         {
-            std::cout << "More than one example file found. Sending " + lib + " example to 'examples/' folder.\n";
-            try
-            {
-                std::filesystem::create_directories(project + "/../examples");
-                std::filesystem::copy_file(libDirectory + "/" + lib + "/main.cpp", project + "/../examples/" + lib + ".cpp");
-            }
-            catch (std::exception e)
-            {
-                std::cout << "[ERR] Could not copy file from: " << libDirectory + "/" + lib + "/main.cpp" << " to " << project + "/" + lib + ".cpp" << std::endl;
-                return false;
-            }
+            std::cout << "[ERR] Could not create or open: " << (folder / fileName).u8string() << "\n";
+            return false;
         }
     }
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(folder, ec))
+    {
+        if (entry.path().extension() != ".ixx" || written.count(entry.path().filename().u8string()) != 0)
+            continue;
+        std::ifstream existing(entry.path());
+        std::string firstLine;
+        std::getline(existing, firstLine);
+        existing.close();
+        if (firstLine.compare(0, marker.size(), marker) == 0)
+            std::filesystem::remove(entry.path(), ec);
+    }
     return true;
 }
 
-bool GenerateGitignore()
+// Leaves the file untouched if it already has this content, so build tools don't see a change
+bool WriteIfChanged(const std::string& path, const std::string& content)
 {
-    std::cout << "Generating .gitignore file...\n";
-    std::ofstream file(".gitignore");
-    if (!file.is_open())
+    std::ifstream existing(path);
+    if (existing.is_open())
     {
-        std::cout << "[ERR] could not create .gitignore file\n";
+        std::ostringstream current;
+        current << existing.rdbuf();
+        if (current.str() == content)
+        {
+            std::cout << path << " is up to date\n";
+            return true;
+        }
+        existing.close();
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open())
         return false;
+    file << content;
+    return (bool)file;
+}
+
+void CollectLibFiles(const LockFile& lock)
+{
+    fileManifest.clear();
+    for (const LockedLibrary& lib : lock.libraries)
+    {
+        for (const std::string& file : lib.files)
+            CheckLibFile(std::filesystem::path(file).filename());
     }
+}
+
+bool GenerateGitignore()
+{
+    std::cout << "Generating .gitignore file...\n";
+    std::ostringstream file;
 
     file << R"(# Visual Studio
 *.sln
@@ -872,10 +2800,22 @@ bool GenerateGitignore()
 
 # Makefile
 Makefile
+*.make
+
+# Ninja
+build.ninja
+compile_commands.json
+.ninja_deps
+.ninja_log
+
+# Interrupted copies
+/)" COPY_JOURNAL_NAME R"(
+*.pg-partial
 
 # Build Dirs
 */int
 /bin
+/)" SOURCE_LIBRARY_FOLDER R"(/*/int
 
 # Binaries
 *.exe
@@ -893,5 +2833,10 @@ Makefile
         file << '!' << lib << '\n';
     }
 
+    if (!WriteIfChanged(".gitignore", file.str()))
+    {
+        std::cout << "[ERR] could not create .gitignore file\n";
+        return false;
+    }
     return true;
 }
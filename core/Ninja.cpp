@@ -0,0 +1,420 @@
+#include "Ninja.h"
+
+#include "Isa.h"
+#include "Json.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+#ifdef _WIN32
+    constexpr bool MSVC = true;
+    constexpr const char* SYSTEM = "windows";
+    constexpr const char* OBJECT_EXTENSION = ".obj";
+#else
+    constexpr bool MSVC = false;
+    constexpr const char* SYSTEM = "linux";
+    constexpr const char* OBJECT_EXTENSION = ".o";
+#endif
+
+    struct Configuration
+    {
+        const char* name;
+        bool debug;
+    };
+    const Configuration CONFIGURATIONS[] = { { "Debug", true }, { "Release", false } };
+
+    struct Source
+    {
+        std::string path;
+        bool isC;
+    };
+
+    // Paths in build lines
+    std::string NinjaPath(const std::string& path)
+    {
+        std::string escaped;
+        for (const char c : path)
+        {
+            if (c == '$' || c == ' ' || c == ':')
+                escaped += '$';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Values of variables, which are only expanded
+    std::string NinjaValue(const std::string& value)
+    {
+        std::string escaped;
+        for (const char c : value)
+        {
+            if (c == '$')
+                escaped += '$';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    std::string NinjaVariable(const std::string& project, const Configuration& configuration, const char* name)
+    {
+        std::string variable = project + "_" + configuration.name + "_" + name;
+        std::replace_if(variable.begin(), variable.end(), [](unsigned char c) { return !std::isalnum(c) && c != '_'; }, '_');
+        return variable;
+    }
+
+    std::string QuoteArgument(const std::string& argument)
+    {
+        if (!argument.empty() && argument.find_first_of(MSVC ? " \t\"" : " \t\"'\\$`&|;<>()*?#~!") == std::string::npos)
+            return argument;
+
+        if (MSVC)
+        {
+            std::string quoted = "\"";
+            for (const char c : argument)
+                quoted += (c == '"') ? std::string("\\\"") : std::string(1, c);
+            return quoted + "\"";
+        }
+
+        std::string quoted = "'";
+        for (const char c : argument)
+            quoted += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+        return quoted + "'";
+    }
+
+    std::string JoinArguments(const std::vector<std::string>& arguments)
+    {
+        std::string joined;
+        for (const std::string& argument : arguments)
+        {
+            if (!joined.empty())
+                joined += ' ';
+            joined += QuoteArgument(argument);
+        }
+        return joined;
+    }
+
+    std::string Compiler(const char* variable, const char* fallback)
+    {
+        const char* value = std::getenv(variable);
+        return (value != nullptr && *value != '\0') ? value : fallback;
+    }
+
+    std::string OutputDirectory(const Configuration& configuration)
+    {
+        return std::string("bin/") + configuration.name + "-" + SYSTEM + "-x86_64";
+    }
+
+    std::string TargetFile(const NinjaProject& project)
+    {
+        switch (project.kind)
+        {
+        case ProjectKind::StaticLib:
+            return MSVC ? project.targetName + ".lib" : "lib" + project.targetName + ".a";
+        case ProjectKind::SharedLib:
+            return MSVC ? project.targetName + ".dll" : "lib" + project.targetName + ".so";
+        default:
+            return MSVC ? project.targetName + ".exe" : project.targetName;
+        }
+    }
+
+    // Every *.cpp (and *.c) below root, like the premake file globs, minus the object folder and skipped
+    void FindSources(const std::string& root, bool compileC, const std::string& skipped, std::vector<Source>& sources, std::vector<std::string>& folders)
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root, ec))
+            return;
+
+        folders.push_back(root);
+        const std::filesystem::path objects = std::filesystem::path(root) / "int";
+        for (auto iter = std::filesystem::recursive_directory_iterator(root, ec);
+            iter != std::filesystem::recursive_directory_iterator(); iter.increment(ec))
+        {
+            if (ec)
+                break;
+            const std::filesystem::path& path = iter->path();
+            if (iter->is_directory(ec))
+            {
+                if (path == objects || (!skipped.empty() && path == std::filesystem::path(skipped)))
+                    iter.disable_recursion_pending();
+                else
+                    folders.push_back(path.generic_u8string());
+                continue;
+            }
+
+            const std::filesystem::path extension = path.extension();
+            if (extension == ".cpp" || (compileC && extension == ".c"))
+                sources.push_back({ path.generic_u8string(), extension == ".c" });
+        }
+        std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.path < b.path; });
+    }
+
+    std::vector<std::string> CompileFlags(const NinjaProject& project, const Configuration& configuration, bool cpp)
+    {
+        std::vector<std::string> flags;
+        std::vector<std::string> defines;
+        const bool symbols = configuration.debug || project.releaseSymbols;
+        if (MSVC)
+        {
+            flags = { "/nologo", "/EHsc" };
+            if (cpp && project.dialect >= 14)
+                flags.push_back(project.dialect > 20 ? "/std:c++latest" : "/std:c++" + std::to_string(project.dialect));
+            flags.push_back(configuration.debug ? "/MDd" : "/MD");
+            flags.push_back(configuration.debug ? "/Od" : (project.releaseSymbols ? "/O2" : "/Ox"));
+            if (symbols)
+                flags.push_back("/Z7"); // no shared .pdb, so parallel compiles don't contend for it
+            defines.push_back("WIN32");
+        }
+        else
+        {
+            if (cpp)
+                flags.push_back("-std=c++" + std::to_string(project.dialect));
+            flags.push_back("-fPIC");
+            flags.push_back(configuration.debug ? "-O0" : (project.releaseSymbols ? "-O3" : "-O2"));
+            if (symbols)
+                flags.push_back("-g");
+            defines.push_back("LINUX");
+        }
+
+        defines.insert(defines.end(), project.defines.begin(), project.defines.end());
+        defines.push_back(configuration.debug ? "_DEBUG" : "NDEBUG");
+        defines.push_back("_CONSOLE");
+        for (const std::string& define : defines)
+            flags.push_back((MSVC ? "/D" : "-D") + define);
+        for (const std::string& dir : project.includeDirs)
+            flags.push_back((MSVC ? "/I" : "-I") + dir);
+        return flags;
+    }
+
+    // Kernel sources: the project's C++ flags plus the variant's switches and namespace
+    std::vector<std::string> IsaFlags(std::vector<std::string> flags, const std::string& isa)
+    {
+        const IsaVariant* variant = FindIsaVariant(isa);
+        const std::vector<std::string>& extra = MSVC ? variant->msvcFlags : variant->gccFlags;
+        flags.insert(flags.end(), extra.begin(), extra.end());
+        flags.push_back(std::string(MSVC ? "/D" : "-D") + "PG_ISA=isa_" + isa);
+        return flags;
+    }
+
+    std::vector<std::string> LinkFlags(const NinjaProject& project, const Configuration& configuration)
+    {
+        std::vector<std::string> links = project.links;
+        const std::vector<std::string>& configurationLinks = configuration.debug ? project.debugLinks : project.releaseLinks;
+        links.insert(links.end(), configurationLinks.begin(), configurationLinks.end());
+
+        std::vector<std::string> flags;
+        if (MSVC)
+        {
+            if (project.kind == ProjectKind::SharedLib)
+                flags.push_back("/DLL");
+            flags.push_back(project.kind == ProjectKind::WindowedApp ? "/SUBSYSTEM:WINDOWS" : "/SUBSYSTEM:CONSOLE");
+            if (configuration.debug || project.releaseSymbols)
+                flags.push_back("/DEBUG");
+            for (const std::string& dir : project.libDirs)
+                flags.push_back("/LIBPATH:" + dir);
+            for (const std::string& link : links)
+                flags.push_back(std::filesystem::path(link).has_extension() ? link : link + ".lib");
+            return flags;
+        }
+
+        if (project.kind == ProjectKind::SharedLib)
+            flags.push_back("-shared");
+        for (const std::string& dir : project.libDirs)
+            flags.push_back("-L" + dir);
+        if (!links.empty())
+        {
+            // Same as linkgroups "On": static libraries resolve regardless of order
+            flags.push_back("-Wl,--start-group");
+            for (const std::string& link : links)
+                flags.push_back("-l" + link);
+            flags.push_back("-Wl,--end-group");
+        }
+        return flags;
+    }
+}
+
+void BuildNinjaFiles(const std::vector<NinjaProject>& projects, std::string& ninja, std::string& compileCommands)
+{
+    const std::string cc = MSVC ? "cl" : Compiler("CC", "cc");
+    const std::string cxx = MSVC ? "cl" : Compiler("CXX", "c++");
+
+    std::ostringstream file;
+    file << "# Generated by premake-gen from premake-gen.lock, rerun \"premake-gen --ninja\" to regenerate.\n";
+    file << "ninja_required_version = 1.3\n\n";
+    file << "cc = " << NinjaValue(cc) << "\n";
+    file << "cxx = " << NinjaValue(cxx) << "\n\n";
+    if (MSVC)
+    {
+        file << R"(msvc_deps_prefix = Note: including file:
+
+rule cc
+  command = $cc /showIncludes $cflags /c $in /Fo$out
+  deps = msvc
+  description = CC $out
+
+rule cxx
+  command = $cxx /showIncludes $cflags /c $in /Fo$out
+  deps = msvc
+  description = CXX $out
+
+rule link
+  command = link /nologo $in /OUT:$out $ldflags
+  description = LINK $out
+
+rule lib
+  command = lib /nologo $in /OUT:$out
+  description = LIB $out
+
+)";
+    }
+    else
+    {
+        file << R"(rule cc
+  command = $cc -MMD -MF $out.d $cflags -c $in -o $out
+  depfile = $out.d
+  deps = gcc
+  description = CC $out
+
+rule cxx
+  command = $cxx -MMD -MF $out.d $cflags -c $in -o $out
+  depfile = $out.d
+  deps = gcc
+  description = CXX $out
+
+rule link
+  command = $cxx $in -o $out $ldflags
+  description = LINK $out
+
+rule lib
+  command = rm -f $out && ar crs $out $in
+  description = AR $out
+
+)";
+    }
+    file << R"(rule regen
+  command = premake-gen --ninja
+  description = Regenerating build.ninja
+  generator = 1
+  restat = 1
+
+)";
+
+    const std::string workspace = std::filesystem::current_path().u8string();
+    std::ostringstream commands;
+    commands << "[";
+    bool firstCommand = true;
+
+    std::vector<std::string> folders;
+    std::vector<std::string> configurationTargets[std::size(CONFIGURATIONS)];
+    for (const NinjaProject& project : projects)
+    {
+        std::vector<Source> sources;
+        std::vector<Source> kernelSources;
+        const std::string kernelFolder = project.isas.empty() ? "" : project.kernelFolder;
+        const std::string folder = project.folder.empty() ? project.name : project.folder;
+        FindSources(folder, project.compileC, kernelFolder, sources, folders);
+        if (!kernelFolder.empty())
+            FindSources(kernelFolder, false, "", kernelSources, folders);
+
+        for (size_t c = 0; c < std::size(CONFIGURATIONS); ++c)
+        {
+            const Configuration& configuration = CONFIGURATIONS[c];
+            const std::string cflags = NinjaVariable(project.name, configuration, "cflags");
+            const std::string cxxflags = NinjaVariable(project.name, configuration, "cxxflags");
+            const std::string ldflags = NinjaVariable(project.name, configuration, "ldflags");
+            const std::vector<std::string> cFlagList = CompileFlags(project, configuration, false);
+            const std::vector<std::string> cxxFlagList = CompileFlags(project, configuration, true);
+
+            file << "# " << project.name << " | " << configuration.name << "\n";
+            file << cflags << " = " << NinjaValue(JoinArguments(cFlagList)) << "\n";
+            file << cxxflags << " = " << NinjaValue(JoinArguments(cxxFlagList)) << "\n";
+            file << ldflags << " = " << NinjaValue(JoinArguments(LinkFlags(project, configuration))) << "\n";
+            for (const std::string& isa : project.isas)
+                file << NinjaVariable(project.name, configuration, ("isa_" + isa + "_cxxflags").c_str()) << " = " << NinjaValue(JoinArguments(IsaFlags(cxxFlagList, isa))) << "\n";
+            file << "\n";
+
+            const std::string objectDirectory = folder + "/int/ninja-" + configuration.name + "/";
+            std::vector<std::string> objects;
+            std::vector<std::pair<const Source*, std::string>> builds; // source, variant ("" = project flags)
+            for (const Source& source : sources)
+                builds.emplace_back(&source, "");
+            for (const std::string& isa : project.isas)
+            {
+                for (const Source& source : kernelSources)
+                    builds.emplace_back(&source, isa);
+            }
+
+            for (const auto& [sourcePtr, isa] : builds)
+            {
+                const Source& source = *sourcePtr;
+                const std::string root = isa.empty() ? folder : kernelFolder;
+                const std::string relative = std::filesystem::path(source.path).lexically_relative(root).generic_u8string();
+                const std::string object = objectDirectory + (isa.empty() ? "" : "isa_" + isa + "/") + relative + OBJECT_EXTENSION;
+                const std::string flags = isa.empty() ? (source.isC ? cflags : cxxflags) : NinjaVariable(project.name, configuration, ("isa_" + isa + "_cxxflags").c_str());
+                objects.push_back(object);
+                file << "build " << NinjaPath(object) << ": " << (source.isC ? "cc " : "cxx ") << NinjaPath(source.path) << "\n";
+                file << "  cflags = $" << flags << "\n";
+
+                // clangd reads the Debug flags, and the newest variant of kernels
+                if (!configuration.debug || (!isa.empty() && isa != project.isas.back()))
+                    continue;
+                const std::vector<std::string> flagList = isa.empty() ? (source.isC ? cFlagList : cxxFlagList) : IsaFlags(cxxFlagList, isa);
+                std::string command = QuoteArgument(source.isC ? cc : cxx) + " " + JoinArguments(flagList);
+                command += MSVC ? " /c " + QuoteArgument(source.path) + " " + QuoteArgument("/Fo" + object)
+                    : " -c " + QuoteArgument(source.path) + " -o " + QuoteArgument(object);
+                commands << (firstCommand ? "\n" : ",\n") << "  {\n";
+                commands << "    \"directory\": " << JsonString(workspace) << ",\n";
+                commands << "    \"command\": " << JsonString(command) << ",\n";
+                commands << "    \"file\": " << JsonString(source.path) << ",\n";
+                commands << "    \"output\": " << JsonString(object) << "\n";
+                commands << "  }";
+                firstCommand = false;
+            }
+
+            const std::string target = OutputDirectory(configuration) + "/" + TargetFile(project);
+            file << "build " << NinjaPath(target) << ": " << (project.kind == ProjectKind::StaticLib ? "lib" : "link");
+            for (const std::string& object : objects)
+                file << " " << NinjaPath(object);
+            for (const std::string& link : project.projectLinks)
+            {
+                auto linked = std::find_if(projects.begin(), projects.end(), [&](const NinjaProject& other) { return other.name == link; });
+                if (linked != projects.end())
+                    file << " " << NinjaPath(OutputDirectory(configuration) + "/" + TargetFile(*linked));
+            }
+            file << "\n";
+            if (project.kind != ProjectKind::StaticLib)
+                file << "  ldflags = $" << ldflags << "\n";
+            file << "\n";
+            configurationTargets[c].push_back(target);
+        }
+    }
+    commands << "\n]\n";
+
+    for (size_t c = 0; c < std::size(CONFIGURATIONS); ++c)
+    {
+        std::string name = CONFIGURATIONS[c].name;
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return (char)std::tolower(ch); });
+        file << "build " << name << ": phony";
+        for (const std::string& target : configurationTargets[c])
+            file << " " << NinjaPath(target);
+        file << "\n";
+    }
+    file << "default debug\n\n";
+
+    // Folder timestamps change when sources are added or removed; a deleted folder is a missing
+    // phony target, which also regenerates
+    file << "build build.ninja compile_commands.json: regen |";
+    for (const std::string& folder : folders)
+        file << " " << NinjaPath(folder);
+    file << "\n";
+    for (const std::string& folder : folders)
+        file << "build " << NinjaPath(folder) << ": phony\n";
+
+    ninja = file.str();
+    compileCommands = commands.str();
+}
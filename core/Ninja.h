@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ProjectSettings.h"
+
+#include <string>
+#include <vector>
+
+// One project of build.ninja. Paths are relative to the workspace and links already use the names
+// of the platform being generated for.
+struct NinjaProject
+{
+	std::string name;
+	std::string folder;                 // sources and objects, the name if empty
+	ProjectKind kind = ProjectKind::ConsoleApp;
+	std::string targetName;
+	uint8_t dialect = 17;
+	bool compileC = true;               // also build *.c files
+	bool releaseSymbols = false;        // Release optimizes for speed and keeps symbols (bench projects)
+
+	// "-isa" variants: the sources in kernelFolder are built once per variant and linked in
+	std::vector<std::string> isas;
+	std::string kernelFolder;
+
+	std::vector<std::string> includeDirs;
+	std::vector<std::string> libDirs;
+	std::vector<std::string> defines;
+	std::vector<std::string> links;
+	std::vector<std::string> debugLinks;
+	std::vector<std::string> releaseLinks;
+	std::vector<std::string> projectLinks; // StaticLib projects of this file, built first and linked in
+};
+
+// Renders build.ninja and compile_commands.json with Debug and Release configurations that match the
+// generated premake5.lua: MSVC on Windows, $CC/$CXX (or cc/c++) elsewhere, with compiler-tracked
+// header dependencies. Sources are listed as they are now; build.ninja reruns "premake-gen --ninja"
+// when a source folder changes.
+void BuildNinjaFiles(const std::vector<NinjaProject>& projects, std::string& ninja, std::string& compileCommands);
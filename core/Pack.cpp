@@ -0,0 +1,265 @@
+#include "Pack.h"
+
+#include "ProjectSettings.h"
+#include "ZipArchive.h"
+#include "ZipWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    struct PackStats
+    {
+        size_t files = 0;
+        size_t directories = 0;
+        size_t stored = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+    };
+
+    std::string Lower(std::string str)
+    {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return str;
+    }
+
+    // Binaries and already-compressed formats gain little from deflate but still pay for inflate
+    bool ShouldStore(const std::filesystem::path& file)
+    {
+        static const std::unordered_set<std::string> storedExtensions = {
+            ".lib", ".dll", ".a", ".so", ".dylib", ".pdb", ".exe", ".obj", ".o", ".exp", ".idb",
+            ".zip", ".7z", ".gz", ".bz2", ".xz", ".zst", ".rar",
+            ".png", ".jpg", ".jpeg", ".gif", ".webp", ".ogg", ".mp3", ".flac", ".mp4"
+        };
+        return storedExtensions.find(Lower(file.extension().u8string())) != storedExtensions.end();
+    }
+
+    std::vector<std::filesystem::path> SortedChildren(const std::filesystem::path& folder)
+    {
+        std::vector<std::filesystem::path> children;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(folder))
+            children.push_back(entry.path());
+        std::sort(children.begin(), children.end(), [](const std::filesystem::path& a, const std::filesystem::path& b)
+            {
+                return a.filename().u8string() < b.filename().u8string();
+            });
+        return children;
+    }
+
+    bool AddEntry(ZipWriter& writer, const std::filesystem::path& source, const std::string& name, PackStats& stats)
+    {
+        const bool store = ShouldStore(source);
+        if (!writer.AddFile(name, source, !store))
+        {
+            std::cout << "[ERR] Could not pack \"" << source.u8string() << "\"\n";
+            return false;
+        }
+
+        const ZipWriter::Record& record = writer.Records().back();
+        ++stats.files;
+        stats.stored += record.method == 0;
+        stats.bytesIn += record.uncompressedSize;
+        stats.bytesOut += record.compressedSize;
+        return true;
+    }
+
+    // Depth-first, name-sorted: the same order ZipArchive lays its table out in, so extracting a
+    // folder reads the archive front to back
+    bool AddTree(ZipWriter& writer, const std::filesystem::path& folder, const std::string& name, PackStats& stats)
+    {
+        if (!writer.AddDirectory(name))
+            return false;
+        ++stats.directories;
+
+        for (const std::filesystem::path& child : SortedChildren(folder))
+        {
+            const std::string childName = name + "/" + child.filename().u8string();
+            if (std::filesystem::is_directory(child))
+            {
+                if (!AddTree(writer, child, childName, stats))
+                    return false;
+            }
+            else if (!AddEntry(writer, child, childName, stats))
+                return false;
+        }
+        return true;
+    }
+
+    // The name a link entry uses for a file in "lib", lower case: LibA.lib for Windows, libLibA.a and
+    // libLibA.so (also versioned, libLibA.so.1) for Linux all give "liba". Empty for other files.
+    std::string LinkNameOf(const std::string& fileName)
+    {
+        std::string name = Lower(fileName);
+        const size_t so = name.find(".so");
+        const bool shared = so != std::string::npos && (so + 3 == name.size() || name[so + 3] == '.');
+        const std::string extension = std::filesystem::u8path(name).extension().u8string();
+        if (shared)
+            name.resize(so);
+        else if (extension == ".lib" || extension == ".a")
+            name.resize(name.size() - extension.size());
+        else
+            return "";
+
+        if (extension != ".lib" && name.size() > 3 && name.compare(0, 3, "lib") == 0)
+            name.erase(0, 3);
+        return name;
+    }
+
+    bool ValidateLayout(const std::filesystem::path& folder, ProjectSettings& settings)
+    {
+        const std::filesystem::path info = folder / "library.info";
+        if (!std::filesystem::is_regular_file(info))
+        {
+            std::cout << "[ERR] No \"library.info\" in \"" << folder.u8string() << "\". See 'premake-gen --setup'\n";
+            return false;
+        }
+
+        std::ifstream file(info);
+        if (!file.is_open() || !ParseLibInfo(settings, file))
+        {
+            std::cout << "[ERR] Could not read \"" << info.u8string() << "\"\n";
+            return false;
+        }
+
+        for (const char* folderName : { "include", "lib", "bin", "src" })
+        {
+            const std::filesystem::path sub = folder / folderName;
+            if (std::filesystem::exists(sub) && !std::filesystem::is_directory(sub))
+            {
+                std::cout << "[ERR] \"" << folderName << "\" must be a folder\n";
+                return false;
+            }
+        }
+        if (!std::filesystem::exists(folder / "include") && !std::filesystem::exists(folder / "src"))
+            std::cout << "[WARNING] No \"include\" folder\n";
+
+        std::unordered_set<std::string> libFiles;
+        if (std::filesystem::is_directory(folder / "lib"))
+        {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(folder / "lib"))
+            {
+                if (!entry.is_regular_file())
+                    continue;
+                const std::string linkName = LinkNameOf(entry.path().filename().u8string());
+                if (linkName.empty())
+                    std::cout << "[WARNING] Non library file in \"lib\": " << entry.path().filename().u8string() << '\n';
+                else
+                    libFiles.insert(linkName);
+            }
+        }
+        if (std::filesystem::is_directory(folder / "bin"))
+        {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(folder / "bin"))
+            {
+                if (entry.is_regular_file() && Lower(entry.path().extension().u8string()) != ".dll")
+                    std::cout << "[WARNING] Non dynamic library file in \"bin\": " << entry.path().filename().u8string() << '\n';
+            }
+        }
+
+        // Links without a matching library file are usually system libraries, but may also be a missing file.
+        // A link names LibA.lib on Windows and libLibA.a/.so on Linux, with or without extension and prefix.
+        if (settings.additionalLibDirs.empty())
+        {
+            for (const StringSet* links : { &settings.globalLinks, &settings.debugLinks, &settings.releaseLinks })
+            {
+                for (const std::string& link : *links)
+                {
+                    std::string name = LinkNameOf(link);
+                    if (name.empty())
+                        name = Lower(link);
+                    const bool prefixed = name.size() > 3 && name.compare(0, 3, "lib") == 0;
+                    if (libFiles.find(name) == libFiles.end() && !(prefixed && libFiles.find(name.substr(3)) != libFiles.end()))
+                        std::cout << "[WARNING] Link \"" << link << "\" has no matching library in \"lib\" (fine for system libraries)\n";
+                }
+            }
+        }
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(folder))
+        {
+            const std::string name = entry.path().filename().u8string();
+            if (name != "library.info" && name != "include" && name != "lib" && name != "bin" && name != "src" && name != "main.cpp")
+                std::cout << "[WARNING] \"" << name << "\" is not part of the library layout, packing it anyway\n";
+        }
+        return true;
+    }
+}
+
+bool PackLibrary(const std::string& folder, const std::string& output, const IoLimits& limits)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::filesystem::path root(folder);
+    if (!std::filesystem::is_directory(root))
+    {
+        std::cout << "[ERR] \"" << folder << "\" is not a folder\n";
+        return false;
+    }
+
+    ProjectSettings settings;
+    if (!ValidateLayout(root, settings))
+        return false;
+
+    ZipWriter writer;
+    if (!writer.Open(output, limits.bufferSize))
+    {
+        std::cout << "[ERR] Could not create \"" << output << "\"\n";
+        return false;
+    }
+
+    std::cout << "Packing \"" << folder << "\" into \"" << output << "\"...\n";
+
+    // Known entries first, in the order premake-gen reads them, then anything else
+    PackStats stats;
+    bool ok = AddEntry(writer, root / "library.info", "library.info", stats);
+    for (const char* folderName : { "include", "lib", "bin", "src" })
+    {
+        if (ok && std::filesystem::is_directory(root / folderName))
+            ok = AddTree(writer, root / folderName, folderName, stats);
+    }
+    if (ok && std::filesystem::is_regular_file(root / "main.cpp"))
+        ok = AddEntry(writer, root / "main.cpp", "main.cpp", stats);
+
+    for (const std::filesystem::path& child : SortedChildren(root))
+    {
+        if (!ok)
+            break;
+        const std::string name = child.filename().u8string();
+        if (name == "library.info" || name == "include" || name == "lib" || name == "bin" || name == "src" || name == "main.cpp")
+            continue;
+        ok = std::filesystem::is_directory(child) ? AddTree(writer, child, name, stats) : AddEntry(writer, child, name, stats);
+    }
+
+    std::vector<uint8_t> directory;
+    std::vector<uint8_t> index;
+    if (ok)
+    {
+        writer.BuildCentralDirectory(directory);
+        ok = ZipArchive::BuildIndex(directory, writer.Records().size(), index);
+    }
+    const uint64_t indexOffset = writer.Offset();
+    if (ok)
+        ok = writer.AddData(ZipArchive::INDEX_ENTRY_NAME, index.data(), index.size());
+    if (ok)
+        ok = writer.Close(ZipArchive::IndexComment(indexOffset, index, writer.Offset()));
+
+    if (!ok)
+    {
+        std::cout << "[ERR] Failed to write \"" << output << "\"\n";
+        writer.Close();
+        std::error_code ec;
+        std::filesystem::remove(output, ec);
+        return false;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Packed " << stats.files << " files in " << stats.directories << " folders ("
+        << stats.stored << " stored): " << stats.bytesIn << " -> " << stats.bytesOut << " bytes in "
+        << seconds << "s\n";
+    return true;
+}
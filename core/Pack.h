@@ -0,0 +1,10 @@
+#pragma once
+
+#include "IoLimits.h"
+
+#include <string>
+
+// Validates a library folder against the layout described by HowTo() and writes it to output as a
+// zip laid out for fast extraction: library.info first, entries in depth-first name order,
+// binaries stored instead of deflated and an embedded ZipArchive index.
+bool PackLibrary(const std::string& folder, const std::string& output, const IoLimits& limits);
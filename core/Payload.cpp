@@ -0,0 +1,304 @@
+#include "Payload.h"
+
+#include "ZipArchive.h"
+#include "ZipWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace
+{
+    // Files at least this large are hard linked into projects; smaller ones are copied
+    constexpr uint64_t LINK_THRESHOLD = 64 * 1024;
+
+    // Where the executable ends inside a file that carries a payload, false if zip is no payload
+    bool PayloadPrefix(const ZipArchive& zip, uint64_t& prefixSize)
+    {
+        const std::string marker = PREMAKE_PAYLOAD_COMMENT " ";
+        const std::string& comment = zip.Comment();
+        if (comment.compare(0, marker.size(), marker) != 0)
+            return false;
+
+        try
+        {
+            prefixSize = std::stoull(comment.substr(marker.size()));
+        }
+        catch (std::exception&)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // FNV-1a over the names, sizes and CRCs of every file in the payload
+    std::string PayloadKey(const ZipArchive& zip)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto add = [&](const void* data, size_t size)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; ++i)
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+        };
+
+        std::string path;
+        for (const uint32_t entry : zip.Subtree(zip.Root()))
+        {
+            if (!zip[entry].isFile)
+                continue;
+            zip.RelativePath(entry, zip.Root(), path);
+            add(path.data(), path.size() + 1);
+            add(&zip[entry].uncompressedSize, sizeof(uint64_t));
+            add(&zip[entry].crc32, sizeof(uint32_t));
+        }
+
+        char key[17];
+        std::snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash);
+        return key;
+    }
+
+    bool CopyPrefix(const std::string& source, const std::string& output, uint64_t size, size_t bufferSize)
+    {
+        std::ifstream in(std::filesystem::u8path(source), std::ios::binary);
+        std::ofstream out(std::filesystem::u8path(output), std::ios::binary | std::ios::trunc);
+        if (!in.is_open() || !out.is_open())
+            return false;
+
+        std::vector<char> buffer(std::max<size_t>(bufferSize, 4096));
+        while (size > 0)
+        {
+            const size_t chunk = (size_t)std::min<uint64_t>(size, buffer.size());
+            if (!in.read(buffer.data(), chunk) || !out.write(buffer.data(), chunk))
+                return false;
+            size -= chunk;
+        }
+        out.close();
+        return !out.fail();
+    }
+
+    bool ExtractPayload(ZipArchive& zip, const std::filesystem::path& destination)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(destination, ec);
+
+        std::string path;
+        for (const uint32_t entry : zip.Subtree(zip.Root()))
+        {
+            zip.RelativePath(entry, zip.Root(), path);
+            const std::filesystem::path target = destination / std::filesystem::u8path(path);
+            if (!zip[entry].isFile)
+            {
+                std::filesystem::create_directories(target, ec);
+                continue;
+            }
+            std::filesystem::create_directories(target.parent_path(), ec);
+            if (!zip.ExtractToFile(entry, target.string()))
+                return false;
+#ifndef _WIN32
+            // Extraction creates plain files; the premake binary of a payload embedded on Windows has no
+            // recorded mode but must still pass generate-linux.sh's executable check
+            std::filesystem::perms mode = std::filesystem::perms(zip[entry].unixMode);
+            if (zip[entry].unixMode == 0 && target.filename() == "premake5")
+                mode = std::filesystem::status(target, ec).permissions() | std::filesystem::perms::owner_exec | std::filesystem::perms::group_exec | std::filesystem::perms::others_exec;
+            if (mode != std::filesystem::perms::none)
+                std::filesystem::permissions(target, mode, ec);
+#endif
+        }
+        return !ec;
+    }
+
+    bool IsUnchanged(const std::filesystem::path& source, const std::filesystem::path& destination)
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(destination, ec))
+            return false;
+        if (std::filesystem::equivalent(source, destination, ec))
+            return true;
+
+        const uint64_t sourceSize = std::filesystem::file_size(source, ec);
+        if (ec || std::filesystem::file_size(destination, ec) != sourceSize || ec)
+            return false;
+        const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(source, ec);
+        return !ec && std::filesystem::last_write_time(destination, ec) == sourceTime && !ec;
+    }
+
+    bool MaterializeFile(const std::filesystem::path& source, const std::filesystem::path& destination)
+    {
+        if (IsUnchanged(source, destination))
+            return true;
+
+        std::error_code ec;
+        std::filesystem::remove(destination, ec);
+        if (std::filesystem::file_size(source, ec) >= LINK_THRESHOLD && !ec)
+        {
+            std::filesystem::create_hard_link(source, destination, ec);
+            if (!ec)
+                return true;
+        }
+
+        ec.clear();
+        std::filesystem::copy_file(source, destination, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec)
+            return false;
+        // Same time as the source, so the next run sees the copy as unchanged
+        std::filesystem::last_write_time(destination, std::filesystem::last_write_time(source, ec), ec);
+        return true;
+    }
+}
+
+std::string ExecutablePath()
+{
+#ifdef _WIN32
+    std::wstring path(MAX_PATH, L'\0');
+    for (;;)
+    {
+        const DWORD length = GetModuleFileNameW(nullptr, path.data(), (DWORD)path.size());
+        if (length == 0)
+            return "";
+        if (length < path.size())
+        {
+            path.resize(length);
+            break;
+        }
+        path.resize(path.size() * 2);
+    }
+    return std::filesystem::path(path).u8string();
+#else
+    std::error_code ec;
+    const std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", ec);
+    return ec ? "" : path.u8string();
+#endif
+}
+
+bool EmbedPremakePayload(const std::filesystem::path& folder, const std::string& output, const IoLimits& limits)
+{
+    const std::string executable = ExecutablePath();
+    std::error_code ec;
+    if (executable.empty() || !std::filesystem::is_directory(folder, ec))
+    {
+        std::cout << "[ERR] Could not find the premake-gen executable or the folder: " << folder << std::endl;
+        return false;
+    }
+    if (std::filesystem::equivalent(std::filesystem::u8path(executable), std::filesystem::u8path(output), ec))
+    {
+        std::cout << "[ERR] Can not embed into the running executable, choose another output file" << std::endl;
+        return false;
+    }
+
+    uint64_t prefixSize = std::filesystem::file_size(std::filesystem::u8path(executable), ec);
+    {
+        ZipArchive current;
+        uint64_t existing = 0;
+        if (current.Open(executable) && PayloadPrefix(current, existing) && existing <= prefixSize)
+            prefixSize = existing;
+    }
+
+    if (ec || !CopyPrefix(executable, output, prefixSize, limits.bufferSize))
+    {
+        std::cout << "[ERR] Could not write: " << output << std::endl;
+        return false;
+    }
+
+    ZipWriter writer;
+    if (!writer.OpenAppend(output, limits.bufferSize))
+    {
+        std::cout << "[ERR] Could not write: " << output << std::endl;
+        return false;
+    }
+
+    size_t fileCount = 0;
+    for (std::filesystem::recursive_directory_iterator iter(folder, ec), end; !ec && iter != end; iter.increment(ec))
+    {
+        const std::string name = std::filesystem::relative(iter->path(), folder).generic_u8string();
+        const bool added = iter->is_directory() ? writer.AddDirectory(name) : writer.AddFile(name, iter->path(), true);
+        if (!added)
+        {
+            std::cout << "[ERR] Could not add to payload: " << iter->path() << std::endl;
+            return false;
+        }
+        fileCount += iter->is_directory() ? 0 : 1;
+    }
+    if (ec || !writer.Close(PREMAKE_PAYLOAD_COMMENT " " + std::to_string(prefixSize)))
+    {
+        std::cout << "[ERR] Could not write the payload of: " << output << std::endl;
+        return false;
+    }
+
+    // Keep the executable bits of the source on platforms that have them
+    std::filesystem::permissions(std::filesystem::u8path(output), std::filesystem::status(std::filesystem::u8path(executable), ec).permissions(), ec);
+    std::cout << "Embedded " << fileCount << " premake files into: " << output << std::endl;
+    return true;
+}
+
+std::string PremakePayloadFolder(const std::string& cacheRoot)
+{
+    const std::string executable = ExecutablePath();
+    ZipArchive zip;
+    uint64_t prefixSize = 0;
+    if (executable.empty() || !zip.Open(executable) || !PayloadPrefix(zip, prefixSize))
+        return "";
+
+    const std::filesystem::path folder = std::filesystem::u8path(cacheRoot) / ("premake-" + PayloadKey(zip));
+    std::error_code ec;
+    if (std::filesystem::is_directory(folder, ec))
+        return folder.u8string();
+
+    // Extracted next to its final place and renamed, so a half-written cache is never used
+    const std::filesystem::path staging = folder.u8string() + ".tmp-" + std::to_string(std::random_device{}());
+    std::filesystem::remove_all(staging, ec);
+    std::cout << "Extracting embedded premake files...\n";
+    if (!ExtractPayload(zip, staging))
+    {
+        std::filesystem::remove_all(staging, ec);
+        std::cout << "[ERR] Could not extract the embedded premake files to: " << staging << std::endl;
+        return "";
+    }
+
+    std::filesystem::rename(staging, folder, ec);
+    if (ec)
+    {
+        // Another run got there first; its copy is just as good
+        std::filesystem::remove_all(staging, ec);
+        if (!std::filesystem::is_directory(folder, ec))
+            return "";
+    }
+    return folder.u8string();
+}
+
+bool MaterializeFolder(const std::filesystem::path& source, const std::filesystem::path& destination)
+{
+    try
+    {
+        std::filesystem::create_directories(destination);
+
+        for (const std::filesystem::directory_entry& dirEntry : std::filesystem::recursive_directory_iterator(source))
+        {
+            const std::filesystem::path dst = destination / std::filesystem::relative(dirEntry.path(), source);
+            if (dirEntry.is_directory())
+            {
+                std::filesystem::create_directories(dst);
+            }
+            else if (!MaterializeFile(dirEntry.path(), dst))
+            {
+                std::cout << "[ERR] Could not copy: " << dirEntry.path() << " to " << dst << std::endl;
+                return false;
+            }
+        }
+    }
+    catch (std::exception&)
+    {
+        std::cout << "[ERR] Could not copy files from: " << source << " to " << destination << std::endl;
+        return false;
+    }
+    return true;
+}
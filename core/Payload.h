@@ -0,0 +1,29 @@
+#pragma once
+
+#include "IoLimits.h"
+
+#include <filesystem>
+#include <string>
+
+// The premake files (premake5.exe, scripts, licenses) can ship inside the premake-gen executable
+// as a deflated ZIP appended to its end. The archive comment marks it and records where the
+// executable itself ends, so a payload can be replaced without touching the program.
+#define PREMAKE_PAYLOAD_COMMENT "premake-gen premake payload v1"
+
+// Full path of the running executable, empty if the platform doesn't report it
+std::string ExecutablePath();
+
+// Writes a copy of this executable to output with the files of folder appended as its payload.
+// A payload this executable already carries is replaced, not stacked.
+bool EmbedPremakePayload(const std::filesystem::path& folder, const std::string& output, const IoLimits& limits);
+
+// Folder under cacheRoot holding the extracted payload of this executable. It is extracted once per
+// payload (keyed by the names, sizes and CRCs of its entries) and reused by every later run.
+// Empty if this executable has no payload or it could not be extracted.
+std::string PremakePayloadFolder(const std::string& cacheRoot);
+
+// Brings every file of source into destination. Files that are already there unchanged (same link,
+// or same size and modification time) are skipped; large files are hard linked where the file system
+// allows it and everything else is copied. Small files are always copied so editing a script in one
+// project never writes through to the shared source.
+bool MaterializeFolder(const std::filesystem::path& source, const std::filesystem::path& destination);
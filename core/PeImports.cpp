@@ -0,0 +1,227 @@
+#include "PeImports.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // DOS header, PE signature, optional header and section table all fit in the first page
+    constexpr size_t HEADER_BYTES = 4096;
+    constexpr size_t SECTION_HEADER_SIZE = 40;
+    constexpr size_t IMPORT_DESCRIPTOR_SIZE = 20;
+    constexpr size_t DELAY_DESCRIPTOR_SIZE = 32;
+    // Guards against corrupt headers asking for absurd buffers
+    constexpr uint32_t MAX_SECTION_SIZE = 256 * 1024 * 1024;
+    constexpr size_t MAX_IMPORTS = 65536;
+
+    uint16_t Le16(const uint8_t* p)
+    {
+        return (uint16_t)(p[0] | p[1] << 8);
+    }
+
+    uint32_t Le32(const uint8_t* p)
+    {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+
+    uint64_t Le64(const uint8_t* p)
+    {
+        return (uint64_t)Le32(p) | (uint64_t)Le32(p + 4) << 32;
+    }
+}
+
+bool PeImportReader::Feed(const uint8_t* data, size_t size)
+{
+    const uint64_t offset = m_position;
+    m_position += size;
+    if (!m_parsed)
+    {
+        const size_t take = std::min(size, HEADER_BYTES - m_headers.size());
+        m_headers.insert(m_headers.end(), data, data + take);
+        if (m_headers.size() < HEADER_BYTES)
+            return true;
+
+        m_parsed = true;
+        if (!ParseHeaders())
+            return false;
+        // A small image's import section can start inside the first page
+        Keep(0, m_headers.data(), m_headers.size());
+    }
+    if (!m_valid)
+        return false;
+
+    Keep(offset, data, size);
+    return m_position < m_end;
+}
+
+bool PeImportReader::Finish(std::vector<std::string>& dlls)
+{
+    if (!m_parsed)
+    {
+        m_parsed = true;
+        if (!ParseHeaders())
+            return false;
+        Keep(0, m_headers.data(), m_headers.size());
+    }
+    if (!m_valid || m_position < m_end)
+        return false;
+
+    dlls.clear();
+    std::string name;
+    for (size_t i = 0; m_importTable != 0 && i < MAX_IMPORTS; ++i)
+    {
+        const uint8_t* descriptor = At((uint64_t)m_importTable + i * IMPORT_DESCRIPTOR_SIZE, IMPORT_DESCRIPTOR_SIZE);
+        if (descriptor == nullptr)
+            return false;
+        // The table ends with an all-zero descriptor
+        if (Le32(descriptor + 12) == 0 && Le32(descriptor + 16) == 0)
+            break;
+        if (!NameAt(Le32(descriptor + 12), name))
+            return false;
+        dlls.push_back(name);
+    }
+    for (size_t i = 0; m_delayImportTable != 0 && i < MAX_IMPORTS; ++i)
+    {
+        const uint8_t* descriptor = At((uint64_t)m_delayImportTable + i * DELAY_DESCRIPTOR_SIZE, DELAY_DESCRIPTOR_SIZE);
+        if (descriptor == nullptr)
+            return false;
+        const uint32_t attributes = Le32(descriptor);
+        const uint64_t nameAddress = Le32(descriptor + 4);
+        if (nameAddress == 0)
+            break;
+        // Old linkers stored virtual addresses instead of RVAs, which attribute bit 0 tells apart
+        if ((attributes & 1) == 0 && nameAddress < m_imageBase)
+            return false;
+        if (!NameAt((attributes & 1) != 0 ? nameAddress : nameAddress - m_imageBase, name))
+            return false;
+        dlls.push_back(name);
+    }
+
+    for (std::string& dll : dlls)
+        std::transform(dll.begin(), dll.end(), dll.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    std::sort(dlls.begin(), dlls.end());
+    dlls.erase(std::unique(dlls.begin(), dlls.end()), dlls.end());
+    return true;
+}
+
+bool PeImportReader::ParseHeaders()
+{
+    const uint8_t* headers = m_headers.data();
+    const size_t size = m_headers.size();
+    auto has = [&](uint64_t offset, uint64_t count) { return offset <= size && count <= size - offset; };
+
+    if (!has(0, 0x40) || headers[0] != 'M' || headers[1] != 'Z')
+        return false;
+    const uint32_t peHeader = Le32(headers + 0x3C);
+    if (!has(peHeader, 24) || std::memcmp(headers + peHeader, "PE\0\0", 4) != 0)
+        return false;
+
+    const uint16_t sectionCount = Le16(headers + peHeader + 6);
+    const uint16_t optionalSize = Le16(headers + peHeader + 20);
+    const uint64_t optional = peHeader + 24;
+    if (!has(optional, optionalSize) || optionalSize < 2)
+        return false;
+
+    // PE32 and PE32+ differ in the image base width, which moves the data directories
+    const uint16_t magic = Le16(headers + optional);
+    if (magic != 0x10B && magic != 0x20B)
+        return false;
+    const bool is64 = magic == 0x20B;
+    const uint64_t directoryCountField = optional + (is64 ? 108 : 92);
+    const uint64_t directories = optional + (is64 ? 112 : 96);
+    const uint64_t optionalEnd = optional + optionalSize;
+    if (directoryCountField + 4 > optionalEnd)
+        return false;
+    m_imageBase = is64 ? Le64(headers + optional + 24) : Le32(headers + optional + 28);
+
+    const uint32_t directoryCount = Le32(headers + directoryCountField);
+    auto directory = [&](uint32_t index) -> uint32_t
+    {
+        const uint64_t entry = directories + (uint64_t)index * 8;
+        return (index < directoryCount && entry + 8 <= optionalEnd) ? Le32(headers + entry) : 0;
+    };
+    m_importTable = directory(1);
+    m_delayImportTable = directory(13);
+
+    const uint64_t sectionTable = optionalEnd;
+    if (!has(sectionTable, (uint64_t)sectionCount * SECTION_HEADER_SIZE))
+        return false;
+    for (uint16_t i = 0; i < sectionCount; ++i)
+    {
+        const uint8_t* section = headers + sectionTable + i * SECTION_HEADER_SIZE;
+        const uint32_t virtualSize = Le32(section + 8);
+        const uint32_t address = Le32(section + 12);
+        const uint32_t rawSize = std::min(Le32(section + 16), MAX_SECTION_SIZE);
+        const uint32_t rawOffset = Le32(section + 20);
+        const uint32_t span = std::max(virtualSize, rawSize);
+        auto holds = [&](uint32_t table) { return table != 0 && table >= address && table - address < span; };
+        if (rawSize == 0 || (!holds(m_importTable) && !holds(m_delayImportTable)))
+            continue;
+
+        m_sections.push_back({ rawOffset, address, std::vector<uint8_t>(rawSize) });
+        m_end = std::max<uint64_t>(m_end, (uint64_t)rawOffset + rawSize);
+    }
+
+    m_valid = true;
+    return true;
+}
+
+void PeImportReader::Keep(uint64_t offset, const uint8_t* data, size_t size)
+{
+    for (Section& section : m_sections)
+    {
+        const uint64_t begin = std::max(offset, section.offset);
+        const uint64_t end = std::min(offset + size, section.offset + section.data.size());
+        if (begin < end)
+            std::memcpy(section.data.data() + (begin - section.offset), data + (begin - offset), (size_t)(end - begin));
+    }
+}
+
+const uint8_t* PeImportReader::At(uint64_t address, size_t size) const
+{
+    for (const Section& section : m_sections)
+    {
+        if (address >= section.address && address - section.address <= section.data.size() &&
+            size <= section.data.size() - (address - section.address))
+            return section.data.data() + (address - section.address);
+    }
+    return nullptr;
+}
+
+bool PeImportReader::NameAt(uint64_t address, std::string& name) const
+{
+    for (const Section& section : m_sections)
+    {
+        if (address < section.address || address - section.address >= section.data.size())
+            continue;
+        const uint8_t* begin = section.data.data() + (address - section.address);
+        const uint8_t* end = section.data.data() + section.data.size();
+        const uint8_t* terminator = std::find(begin, end, 0);
+        if (terminator == end || terminator == begin)
+            return false;
+        name.assign(begin, terminator);
+        return true;
+    }
+    return false;
+}
+
+bool ReadPeImports(const std::string& path, std::vector<std::string>& dlls)
+{
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    PeImportReader reader;
+    std::vector<char> buffer(64 * 1024);
+    while (file)
+    {
+        file.read(buffer.data(), buffer.size());
+        const size_t got = (size_t)file.gcount();
+        if (got == 0 || !reader.Feed(reinterpret_cast<const uint8_t*>(buffer.data()), got))
+            break;
+    }
+    return reader.Finish(dlls);
+}
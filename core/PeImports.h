@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Reads the DLLs a PE image (.exe or .dll) imports, both load-time and delay-loaded, without any
+// Windows API so it runs on every platform. The image is fed front to back; only the headers and the
+// sections that hold the import tables are kept, and Feed() returns false as soon as the rest of the
+// file isn't needed, so a caller reading a large DLL from a ZIP can stop inflating early.
+class PeImportReader
+{
+public:
+	// False once everything needed has been read (or the data is no PE image)
+	bool Feed(const uint8_t* data, size_t size);
+	// The imported DLL names, lower case. False if the data was no PE image or its import tables were cut off.
+	bool Finish(std::vector<std::string>& dlls);
+
+private:
+	struct Section
+	{
+		uint64_t offset;  // in the file
+		uint32_t address; // relative virtual address
+		std::vector<uint8_t> data;
+	};
+
+	std::vector<uint8_t> m_headers;
+	std::vector<Section> m_sections; // only the ones holding import data
+	uint64_t m_position = 0;
+	uint64_t m_end = 0;              // file offset after the last kept section
+	uint64_t m_imageBase = 0;
+	uint32_t m_importTable = 0;
+	uint32_t m_delayImportTable = 0;
+	bool m_parsed = false;
+	bool m_valid = false;
+
+	bool ParseHeaders();
+	void Keep(uint64_t offset, const uint8_t* data, size_t size);
+	const uint8_t* At(uint64_t address, size_t size) const;
+	bool NameAt(uint64_t address, std::string& name) const;
+};
+
+bool ReadPeImports(const std::string& path, std::vector<std::string>& dlls);
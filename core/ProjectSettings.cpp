@@ -0,0 +1,234 @@
+#include "ProjectSettings.h"
+
+#include <algorithm>
+#include <iostream>
+
+std::string KindString(ProjectKind kind)
+{
+    switch (kind)
+    {
+    case ProjectKind::ConsoleApp:
+        return "ConsoleApp";
+    case ProjectKind::WindowedApp:
+        return "WindowedApp";
+    case ProjectKind::StaticLib:
+        return "StaticLib";
+    case ProjectKind::SharedLib:
+        return "SharedLib";
+    }
+    return "ERR";
+}
+
+bool IsWhiteSpace(const std::string& str)
+{
+    if (str.empty())
+        return true;
+    for (const char c : str)
+    {
+        if (c != ' ' &&
+            c != '\t' &&
+            c != '\n')
+            return false;
+    }
+    return true;
+}
+
+namespace
+{
+    // Small sets are cheaper to scan than to hash
+    constexpr size_t LINEAR_LIMIT = 8;
+
+    size_t SlotOf(uint32_t id, size_t mask)
+    {
+        return (size_t)(id * 2654435761u) & mask;
+    }
+}
+
+StringInterner& StringInterner::Global()
+{
+    static StringInterner interner;
+    return interner;
+}
+
+uint32_t StringInterner::Intern(std::string_view str)
+{
+    auto found = m_ids.find(str);
+    if (found != m_ids.end())
+        return found->second;
+
+    const uint32_t id = (uint32_t)m_strings.size();
+    const std::string& stored = m_strings.emplace_back(str);
+    m_ids.emplace(stored, id);
+    return id;
+}
+
+uint32_t StringInterner::Find(std::string_view str) const
+{
+    auto found = m_ids.find(str);
+    return (found != m_ids.end()) ? found->second : npos;
+}
+
+bool StringSet::Insert(std::string_view str)
+{
+    return InsertId(StringInterner::Global().Intern(str));
+}
+
+bool StringSet::InsertId(uint32_t id)
+{
+    if (ContainsId(id))
+        return false;
+
+    m_ids.push_back(id);
+    if (m_ids.size() > LINEAR_LIMIT)
+    {
+        if (m_ids.size() * 2 > m_slots.size())
+        {
+            RebuildSlots(std::max<size_t>(32, m_slots.size() * 2));
+        }
+        else
+        {
+            const size_t mask = m_slots.size() - 1;
+            size_t slot = SlotOf(id, mask);
+            while (m_slots[slot] != 0)
+                slot = (slot + 1) & mask;
+            m_slots[slot] = id + 1;
+        }
+    }
+    return true;
+}
+
+void StringSet::Merge(const StringSet& other)
+{
+    for (const uint32_t id : other.m_ids)
+        InsertId(id);
+}
+
+bool StringSet::Contains(std::string_view str) const
+{
+    // Strings that are only queried are not interned
+    const uint32_t id = StringInterner::Global().Find(str);
+    return id != StringInterner::npos && ContainsId(id);
+}
+
+std::vector<std::string> StringSet::ToVector() const
+{
+    std::vector<std::string> strings;
+    strings.reserve(m_ids.size());
+    for (const std::string& str : *this)
+        strings.push_back(str);
+    return strings;
+}
+
+bool StringSet::ContainsId(uint32_t id) const
+{
+    if (m_slots.empty())
+        return std::find(m_ids.begin(), m_ids.end(), id) != m_ids.end();
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = SlotOf(id, mask); m_slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot] == id + 1)
+            return true;
+    }
+    return false;
+}
+
+void StringSet::RebuildSlots(size_t slotCount)
+{
+    m_slots.assign(slotCount, 0);
+    const size_t mask = slotCount - 1;
+    for (const uint32_t id : m_ids)
+    {
+        size_t slot = SlotOf(id, mask);
+        while (m_slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        m_slots[slot] = id + 1;
+    }
+}
+
+void CheckAndPush(std::vector<std::string>& vec, const std::string& str)
+{
+    if (std::find(vec.begin(), vec.end(), str) != vec.end())
+        return;
+
+    vec.push_back(str);
+}
+
+bool ParseLibInfo(ProjectSettings& settings, std::istream& info)
+{
+    std::string activeMarker = "";
+    std::string line = "";
+
+    while (std::getline(info, line))
+    {
+        if (IsWhiteSpace(line))
+            continue;
+
+        if (line[0] == '@')
+        {
+            activeMarker = line.substr(1);
+            continue;
+        }
+
+        if (activeMarker == "defines")
+            settings.defines.Insert(line);
+        else if (activeMarker == "additionalIncludeDirs")
+            settings.additionalIncludeDirs.Insert(line);
+        else if (activeMarker == "additionalLibDirs")
+            settings.additionalLibDirs.Insert(line);
+        else if (activeMarker == "debugLinks")
+            settings.debugLinks.Insert(line);
+        else if (activeMarker == "globalLinks")
+            settings.globalLinks.Insert(line);
+        else if (activeMarker == "releaseLinks")
+            settings.releaseLinks.Insert(line);
+        else if (activeMarker == "modules")
+            settings.modules.Insert(line);
+        else
+        {
+            std::cout << "[ERR] Unidentified marker '" << activeMarker << "'\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CheckLibInfo(std::istream& info, std::string& error)
+{
+    static const char* const markers[] = { "defines", "additionalIncludeDirs", "additionalLibDirs", "debugLinks", "globalLinks", "releaseLinks", "modules" };
+
+    bool known = false;
+    std::string activeMarker = "";
+    std::string line = "";
+    while (std::getline(info, line))
+    {
+        if (IsWhiteSpace(line))
+            continue;
+
+        if (line[0] == '@')
+        {
+            activeMarker = line.substr(1);
+            known = std::find(std::begin(markers), std::end(markers), activeMarker) != std::end(markers);
+            continue;
+        }
+        if (!known)
+        {
+            error = "Unidentified marker '" + activeMarker + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+void MergeLibInfo(ProjectSettings& settings, const ProjectSettings& lib)
+{
+    settings.defines.Merge(lib.defines);
+    settings.additionalIncludeDirs.Merge(lib.additionalIncludeDirs);
+    settings.additionalLibDirs.Merge(lib.additionalLibDirs);
+    settings.debugLinks.Merge(lib.debugLinks);
+    settings.globalLinks.Merge(lib.globalLinks);
+    settings.releaseLinks.Merge(lib.releaseLinks);
+    settings.sourceLibraries.Merge(lib.sourceLibraries);
+    settings.modules.Merge(lib.modules);
+}
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
+#include <istream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 enum class ProjectKind : uint8_t
@@ -12,6 +16,68 @@ enum class ProjectKind : uint8_t
 	SharedLib,
 };
 
+// Process-wide string pool: every distinct string is stored once and named by a dense id. Strings are
+// never freed, so ids and references stay valid while a server keeps settings cached between requests.
+class StringInterner
+{
+public:
+	static StringInterner& Global();
+
+	static constexpr uint32_t npos = UINT32_MAX;
+
+	uint32_t Intern(std::string_view str);
+	uint32_t Find(std::string_view str) const; // npos if str was never interned
+	const std::string& Get(uint32_t id) const { return m_strings[id]; }
+	size_t Size() const { return m_strings.size(); }
+
+private:
+	std::deque<std::string> m_strings; // a deque never moves its elements, so the keys below stay valid
+	std::unordered_map<std::string_view, uint32_t> m_ids;
+};
+
+// Insertion-ordered set of interned strings. Small sets are searched linearly, larger ones keep an
+// open-addressing index over their ids, so adding n strings is linear either way. Copies only copy ids.
+class StringSet
+{
+public:
+	class Iterator
+	{
+	public:
+		Iterator(const uint32_t* id) : m_id(id) {}
+		const std::string& operator*() const { return StringInterner::Global().Get(*m_id); }
+		const std::string* operator->() const { return &**this; }
+		Iterator& operator++() { ++m_id; return *this; }
+		bool operator!=(const Iterator& other) const { return m_id != other.m_id; }
+		bool operator==(const Iterator& other) const { return m_id == other.m_id; }
+
+	private:
+		const uint32_t* m_id;
+	};
+
+	// Returns false if str is already in the set
+	bool Insert(std::string_view str);
+	bool InsertId(uint32_t id);
+	// Appends the strings of other that this set doesn't contain yet, keeping their order
+	void Merge(const StringSet& other);
+	bool Contains(std::string_view str) const;
+
+	size_t size() const { return m_ids.size(); }
+	bool empty() const { return m_ids.empty(); }
+	const std::string& operator[](size_t index) const { return StringInterner::Global().Get(m_ids[index]); }
+	Iterator begin() const { return m_ids.data(); }
+	Iterator end() const { return m_ids.data() + m_ids.size(); }
+
+	const std::vector<uint32_t>& Ids() const { return m_ids; }
+	std::vector<std::string> ToVector() const;
+
+private:
+	std::vector<uint32_t> m_ids;
+	std::vector<uint32_t> m_slots; // id + 1, 0 = empty; only used past a few entries
+
+	bool ContainsId(uint32_t id) const;
+	void RebuildSlots(size_t slotCount);
+};
+
 struct ProjectSettings
 {
 	std::string name = "Core";
@@ -19,10 +85,29 @@ struct ProjectSettings
 	std::string targetName = "%{prj.name}";
 	uint8_t dialect = 17;
 
-	std::vector<std::string> additionalIncludeDirs;
-	std::vector<std::string> additionalLibDirs;
-	std::vector<std::string> globalLinks;
-	std::vector<std::string> debugLinks;
-	std::vector<std::string> releaseLinks;
-	std::vector<std::string> defines;
-};
\ No newline at end of file
+	StringSet additionalIncludeDirs;
+	StringSet additionalLibDirs;
+	StringSet globalLinks;
+	StringSet debugLinks;
+	StringSet releaseLinks;
+	StringSet defines;
+
+	// Libraries that ship a "src" tree, each built as its own StaticLib project and linked in
+	StringSet sourceLibraries;
+
+	// Public headers (relative to include/) that "-modules" wraps into each library's module interface unit
+	StringSet modules;
+};
+
+std::string KindString(ProjectKind kind);
+
+bool IsWhiteSpace(const std::string& str);
+void CheckAndPush(std::vector<std::string>& vec, const std::string& str);
+
+// Reads the @-tagged sections of a library.info file into settings
+bool ParseLibInfo(ProjectSettings& settings, std::istream& info);
+// Checks that a library.info file would parse, without reading it into settings (safe on any thread).
+// error names the first problem.
+bool CheckLibInfo(std::istream& info, std::string& error);
+// Adds the library.info lists of lib that settings does not contain yet
+void MergeLibInfo(ProjectSettings& settings, const ProjectSettings& lib);
@@ -0,0 +1,551 @@
+#include "Server.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr const char* PROTOCOL_TAG = "premake-gen/1";
+    constexpr uint32_t MAX_STRINGS = 4096;
+    constexpr uint32_t MAX_STRING_SIZE = 64 * 1024 * 1024;
+
+#ifdef _WIN32
+    using Handle = HANDLE;
+    constexpr DWORD PIPE_BUFFER_SIZE = 64 * 1024;
+
+    bool WriteAll(HANDLE pipe, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            DWORD written = 0;
+            if (!WriteFile(pipe, data, (DWORD)std::min<size_t>(size, 1 << 20), &written, nullptr))
+                return false;
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool ReadAll(HANDLE pipe, char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            DWORD read = 0;
+            if (!ReadFile(pipe, data, (DWORD)std::min<size_t>(size, 1 << 20), &read, nullptr) || read == 0)
+                return false;
+            data += read;
+            size -= read;
+        }
+        return true;
+    }
+#else
+    using Handle = int;
+
+    bool WriteAll(int socket, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t written = send(socket, data, size, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            data += written;
+            size -= (size_t)written;
+        }
+        return true;
+    }
+
+    bool ReadAll(int socket, char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t read = recv(socket, data, size, 0);
+            if (read < 0 && errno == EINTR)
+                continue;
+            if (read <= 0)
+                return false;
+            data += read;
+            size -= (size_t)read;
+        }
+        return true;
+    }
+#endif
+
+    void PutU32(std::string& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            out.push_back((char)(value >> (8 * i)));
+    }
+
+    bool ReadU32(Handle handle, uint32_t& value)
+    {
+        unsigned char bytes[4];
+        if (!ReadAll(handle, reinterpret_cast<char*>(bytes), sizeof(bytes)))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        return true;
+    }
+
+    bool SendStrings(Handle handle, const std::vector<std::string>& strings)
+    {
+        std::string message;
+        PutU32(message, (uint32_t)strings.size());
+        for (const std::string& str : strings)
+        {
+            PutU32(message, (uint32_t)str.size());
+            message += str;
+        }
+        return WriteAll(handle, message.data(), message.size());
+    }
+
+    bool ReceiveStrings(Handle handle, std::vector<std::string>& strings)
+    {
+        uint32_t count = 0;
+        if (!ReadU32(handle, count) || count > MAX_STRINGS)
+            return false;
+
+        strings.resize(count);
+        for (std::string& str : strings)
+        {
+            uint32_t size = 0;
+            if (!ReadU32(handle, size) || size > MAX_STRING_SIZE)
+                return false;
+            str.resize(size);
+            if (size > 0 && !ReadAll(handle, &str[0], size))
+                return false;
+        }
+        return true;
+    }
+
+    bool ParseRequest(const std::vector<std::string>& strings, ServerRequest& request)
+    {
+        if (strings.size() < 2 || strings[0] != PROTOCOL_TAG)
+            return false;
+
+        request.workingDirectory = strings[1];
+        request.args.assign(strings.begin() + 2, strings.end());
+        return true;
+    }
+}
+
+ServerEndpoint::~ServerEndpoint()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+std::string ServerEndpoint::Address()
+{
+    char user[256] = {};
+    const DWORD length = GetEnvironmentVariableA("USERNAME", user, sizeof(user));
+    return std::string("\\\\.\\pipe\\premake-gen-") + ((length > 0 && length < sizeof(user)) ? user : "default");
+}
+
+bool ServerEndpoint::Listen()
+{
+    Close();
+
+    // FILE_FLAG_FIRST_PIPE_INSTANCE fails if another server already owns the name
+    HANDLE pipe = CreateNamedPipeA(Address().c_str(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        1, PIPE_BUFFER_SIZE, PIPE_BUFFER_SIZE, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE)
+        return false;
+
+    m_pipe = pipe;
+    return true;
+}
+
+bool ServerEndpoint::Accept(ServerRequest& request)
+{
+    HANDLE pipe = static_cast<HANDLE>(m_pipe);
+    if (pipe == nullptr)
+        return false;
+
+    while (true)
+    {
+        if (!ConnectNamedPipe(pipe, nullptr))
+        {
+            const DWORD error = GetLastError();
+            if (error == ERROR_NO_DATA) // client connected and left again
+            {
+                DisconnectNamedPipe(pipe);
+                continue;
+            }
+            if (error != ERROR_PIPE_CONNECTED)
+                return false;
+        }
+
+        std::vector<std::string> strings;
+        if (ReceiveStrings(pipe, strings) && ParseRequest(strings, request))
+            return true;
+        DisconnectNamedPipe(pipe);
+    }
+}
+
+bool ServerEndpoint::Respond(int exitCode, const std::string& output)
+{
+    HANDLE pipe = static_cast<HANDLE>(m_pipe);
+    if (pipe == nullptr)
+        return false;
+
+    const bool sent = SendStrings(pipe, { std::to_string(exitCode), output });
+    FlushFileBuffers(pipe);
+    DisconnectNamedPipe(pipe);
+    return sent;
+}
+
+void ServerEndpoint::Close()
+{
+    if (m_pipe != nullptr)
+        CloseHandle(static_cast<HANDLE>(m_pipe));
+    m_pipe = nullptr;
+}
+
+bool ForwardToServer(const std::vector<std::string>& args, int& exitCode, std::string& output)
+{
+    const std::string address = ServerEndpoint::Address();
+    HANDLE pipe = CreateFileA(address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY && WaitNamedPipeA(address.c_str(), 5000))
+        pipe = CreateFileA(address.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE)
+        return false;
+
+    std::error_code ec;
+    std::vector<std::string> strings = { PROTOCOL_TAG, std::filesystem::current_path(ec).u8string() };
+    strings.insert(strings.end(), args.begin(), args.end());
+
+    const bool ok = SendStrings(pipe, strings) && ReceiveStrings(pipe, strings) && strings.size() == 2;
+    CloseHandle(pipe);
+    if (!ok)
+        return false;
+
+    exitCode = (int)std::strtol(strings[0].c_str(), nullptr, 10);
+    output = std::move(strings[1]);
+    return true;
+}
+
+ChangeWatcher::~ChangeWatcher()
+{
+    Stop();
+}
+
+bool ChangeWatcher::Watch(const std::string& settingsDirectory, const std::string& libDirectory)
+{
+    Stop();
+    m_libDirectory = libDirectory;
+
+    HANDLE settings = FindFirstChangeNotificationA(settingsDirectory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    HANDLE libraries = FindFirstChangeNotificationA(libDirectory.c_str(), TRUE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE);
+    m_settingsHandle = (settings == INVALID_HANDLE_VALUE) ? nullptr : settings;
+    m_libraryHandle = (libraries == INVALID_HANDLE_VALUE) ? nullptr : libraries;
+    if (m_settingsHandle == nullptr || m_libraryHandle == nullptr)
+    {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+bool ChangeWatcher::WatchLibrary(const std::string&)
+{
+    // The library directory watch is recursive already
+    return false;
+}
+
+void ChangeWatcher::Stop()
+{
+    if (m_settingsHandle != nullptr)
+        FindCloseChangeNotification(static_cast<HANDLE>(m_settingsHandle));
+    if (m_libraryHandle != nullptr)
+        FindCloseChangeNotification(static_cast<HANDLE>(m_libraryHandle));
+    m_settingsHandle = nullptr;
+    m_libraryHandle = nullptr;
+}
+
+bool ChangeWatcher::Poll(std::vector<std::string>&)
+{
+    if (m_settingsHandle == nullptr || m_libraryHandle == nullptr)
+        return true;
+
+    // Change handles don't say what changed, so any signal reloads everything
+    bool reloadAll = false;
+    for (void* handle : { m_settingsHandle, m_libraryHandle })
+    {
+        if (WaitForSingleObject(static_cast<HANDLE>(handle), 0) == WAIT_OBJECT_0)
+        {
+            reloadAll = true;
+            FindNextChangeNotification(static_cast<HANDLE>(handle));
+        }
+    }
+    return reloadAll;
+}
+
+#else // _WIN32
+
+std::string ServerEndpoint::Address()
+{
+    const char* runtimeDirectory = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDirectory != nullptr && runtimeDirectory[0] != '\0')
+        return std::string(runtimeDirectory) + "/premake-gen.sock";
+    return "/tmp/premake-gen-" + std::to_string(getuid()) + ".sock";
+}
+
+namespace
+{
+    bool MakeSocketAddress(const std::string& path, sockaddr_un& address)
+    {
+        address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+        std::copy(path.begin(), path.end(), address.sun_path);
+        return true;
+    }
+
+    int ConnectSocket(const std::string& path)
+    {
+        sockaddr_un address;
+        if (!MakeSocketAddress(path, address))
+            return -1;
+
+        const int socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (socket < 0)
+            return -1;
+        if (connect(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close(socket);
+            return -1;
+        }
+        return socket;
+    }
+}
+
+bool ServerEndpoint::Listen()
+{
+    Close();
+
+    const std::string path = Address();
+    sockaddr_un address;
+    if (!MakeSocketAddress(path, address))
+        return false;
+
+    // A live server still accepts connections; a dead one only leaves its socket file behind
+    const int probe = ConnectSocket(path);
+    if (probe >= 0)
+    {
+        close(probe);
+        return false;
+    }
+    unlink(path.c_str());
+
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_socket < 0)
+        return false;
+
+    const mode_t mask = umask(0077);
+    const bool bound = bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    umask(mask);
+    if (!bound || listen(m_socket, 8) != 0)
+    {
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ServerEndpoint::Accept(ServerRequest& request)
+{
+    while (m_socket >= 0)
+    {
+        const int client = accept(m_socket, nullptr, nullptr);
+        if (client < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return false;
+        }
+
+        std::vector<std::string> strings;
+        if (ReceiveStrings(client, strings) && ParseRequest(strings, request))
+        {
+            m_client = client;
+            return true;
+        }
+        close(client);
+    }
+    return false;
+}
+
+bool ServerEndpoint::Respond(int exitCode, const std::string& output)
+{
+    if (m_client < 0)
+        return false;
+
+    const bool sent = SendStrings(m_client, { std::to_string(exitCode), output });
+    close(m_client);
+    m_client = -1;
+    return sent;
+}
+
+void ServerEndpoint::Close()
+{
+    if (m_client >= 0)
+        close(m_client);
+    m_client = -1;
+
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+        unlink(Address().c_str());
+    }
+    m_socket = -1;
+}
+
+bool ForwardToServer(const std::vector<std::string>& args, int& exitCode, std::string& output)
+{
+    const int socket = ConnectSocket(ServerEndpoint::Address());
+    if (socket < 0)
+        return false;
+
+    std::error_code ec;
+    std::vector<std::string> strings = { PROTOCOL_TAG, std::filesystem::current_path(ec).u8string() };
+    strings.insert(strings.end(), args.begin(), args.end());
+
+    const bool ok = SendStrings(socket, strings) && ReceiveStrings(socket, strings) && strings.size() == 2;
+    close(socket);
+    if (!ok)
+        return false;
+
+    exitCode = (int)std::strtol(strings[0].c_str(), nullptr, 10);
+    output = std::move(strings[1]);
+    return true;
+}
+
+namespace
+{
+    constexpr uint32_t SETTINGS_EVENTS = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO;
+    constexpr uint32_t LIBRARY_EVENTS = SETTINGS_EVENTS | IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+}
+
+ChangeWatcher::~ChangeWatcher()
+{
+    Stop();
+}
+
+bool ChangeWatcher::Watch(const std::string& settingsDirectory, const std::string& libDirectory)
+{
+    Stop();
+    m_libDirectory = libDirectory;
+
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+        return false;
+
+    m_settingsWatch = inotify_add_watch(m_fd, settingsDirectory.c_str(), SETTINGS_EVENTS);
+    m_libraryWatch = inotify_add_watch(m_fd, libDirectory.c_str(), LIBRARY_EVENTS);
+    if (m_settingsWatch < 0 || m_libraryWatch < 0)
+    {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+bool ChangeWatcher::WatchLibrary(const std::string& name)
+{
+    if (m_fd < 0)
+        return false;
+
+    // Re-adding an existing watch returns the same descriptor
+    const int watch = inotify_add_watch(m_fd, (m_libDirectory + "/" + name).c_str(), LIBRARY_EVENTS);
+    if (watch < 0)
+        return false;
+    return m_libraryWatches.insert_or_assign(watch, name).second;
+}
+
+void ChangeWatcher::Stop()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+    m_settingsWatch = -1;
+    m_libraryWatch = -1;
+    m_libraryWatches.clear();
+}
+
+bool ChangeWatcher::Poll(std::vector<std::string>& changedLibraries)
+{
+    if (m_fd < 0)
+        return true;
+
+    bool reloadAll = false;
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true)
+    {
+        const ssize_t size = read(m_fd, buffer, sizeof(buffer));
+        if (size <= 0)
+            break;
+
+        for (ssize_t offset = 0; offset < size;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+            const std::string name = (event->len > 0) ? std::string(event->name) : std::string();
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                reloadAll = true;
+            }
+            else if (event->wd == m_settingsWatch)
+            {
+                if (name == "settings.info")
+                    reloadAll = true;
+            }
+            else if (event->wd == m_libraryWatch)
+            {
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+                    reloadAll = true;
+                else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".zip") == 0)
+                    changedLibraries.push_back(name.substr(0, name.size() - 4));
+                else if (!name.empty())
+                    changedLibraries.push_back(name);
+            }
+            else
+            {
+                auto library = m_libraryWatches.find(event->wd);
+                if (library == m_libraryWatches.end())
+                    continue;
+                // Only library.info is cached, the rest of a folder library is copied straight from disk
+                if (name.empty() || name == "library.info")
+                    changedLibraries.push_back(library->second);
+                if (event->mask & IN_IGNORED)
+                    m_libraryWatches.erase(library);
+            }
+        }
+    }
+    return reloadAll;
+}
+
+#endif // else _WIN32
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Local IPC for "premake-gen --serve": a named pipe on Windows, a Unix domain socket elsewhere.
+// Both directions send a length-prefixed list of strings. A request is the client's working
+// directory followed by its arguments; a response is the exit code followed by everything the
+// server printed while handling the request.
+
+struct ServerRequest
+{
+	std::string workingDirectory;
+	std::vector<std::string> args;
+};
+
+class ServerEndpoint
+{
+public:
+	ServerEndpoint() = default;
+	~ServerEndpoint();
+
+	ServerEndpoint(const ServerEndpoint&) = delete;
+	ServerEndpoint& operator=(const ServerEndpoint&) = delete;
+
+	// False if the endpoint cannot be created, e.g. because another server owns it
+	bool Listen();
+	// Blocks until a client sends a well-formed request
+	bool Accept(ServerRequest& request);
+	bool Respond(int exitCode, const std::string& output);
+	void Close();
+
+	static std::string Address();
+
+private:
+#ifdef _WIN32
+	void* m_pipe = nullptr;
+#else
+	int m_socket = -1;
+	int m_client = -1;
+#endif
+};
+
+// Hands args to a running server; false if there is none (the caller then runs them itself)
+bool ForwardToServer(const std::vector<std::string>& args, int& exitCode, std::string& output);
+
+// Reports changes to settings.info and to the libraries in the library directory.
+// inotify reports which library changed; on Windows any change reloads everything.
+class ChangeWatcher
+{
+public:
+	ChangeWatcher() = default;
+	~ChangeWatcher();
+
+	ChangeWatcher(const ChangeWatcher&) = delete;
+	ChangeWatcher& operator=(const ChangeWatcher&) = delete;
+
+	bool Watch(const std::string& settingsDirectory, const std::string& libDirectory);
+	// Folder libraries keep library.info one level down, so they need their own watch.
+	// True if the library was not watched before.
+	bool WatchLibrary(const std::string& name);
+	void Stop();
+
+	// Appends the libraries changed since the last poll; true if everything must be reloaded
+	bool Poll(std::vector<std::string>& changedLibraries);
+
+private:
+	std::string m_libDirectory;
+#ifdef _WIN32
+	void* m_settingsHandle = nullptr;
+	void* m_libraryHandle = nullptr;
+#else
+	int m_fd = -1;
+	int m_settingsWatch = -1;
+	int m_libraryWatch = -1;
+	std::unordered_map<int, std::string> m_libraryWatches;
+#endif
+};
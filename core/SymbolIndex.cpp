@@ -0,0 +1,618 @@
+#include "SymbolIndex.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+namespace
+{
+    constexpr char AR_MAGIC[] = "!<arch>\n";
+    constexpr size_t AR_MAGIC_SIZE = 8;
+    constexpr size_t AR_HEADER_SIZE = 60;
+    // Guards against corrupt headers asking for absurd buffers; such members are skipped
+    constexpr uint64_t MAX_MEMBER_SIZE = 256 * 1024 * 1024;
+
+    constexpr uint8_t COFF_CLASS_EXTERNAL = 2;
+    constexpr size_t COFF_HEADER_SIZE = 20;
+    constexpr size_t COFF_SYMBOL_SIZE = 18;
+    constexpr size_t BIGOBJ_HEADER_SIZE = 56;
+    constexpr size_t BIGOBJ_SYMBOL_SIZE = 20;
+    // {D1BAA1C7-BAEE-4BA9-AF20-FAF66AA4DCB8}, the class id of /bigobj files
+    constexpr uint8_t BIGOBJ_CLASS_ID[16] = { 0xC7, 0xA1, 0xBA, 0xD1, 0xEE, 0xBA, 0xA9, 0x4B, 0xAF, 0x20, 0xFA, 0xF6, 0x6A, 0xA4, 0xDC, 0xB8 };
+
+    constexpr uint16_t ELF_REL = 1;
+    constexpr uint32_t ELF_SHT_SYMTAB = 2;
+    constexpr uint16_t ELF_SHN_UNDEF = 0;
+    constexpr uint8_t ELF_STB_GLOBAL = 1;
+    constexpr uint8_t ELF_STB_WEAK = 2;
+    constexpr uint8_t ELF_STB_GNU_UNIQUE = 10;
+
+    std::string Lower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+        return text;
+    }
+
+    // Bounds-checked reads of a file image; Has() must be checked before Read()
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, uint64_t size, bool bigEndian = false) : m_data(data), m_size(size), m_bigEndian(bigEndian) {}
+
+        uint64_t Size() const { return m_size; }
+        const uint8_t* Data() const { return m_data; }
+        bool Has(uint64_t offset, uint64_t count) const { return offset <= m_size && count <= m_size - offset; }
+
+        uint64_t Read(uint64_t offset, int bytes) const
+        {
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i)
+                value = (value << 8) | m_data[offset + (m_bigEndian ? i : bytes - 1 - i)];
+            return value;
+        }
+        uint16_t U16(uint64_t offset) const { return (uint16_t)Read(offset, 2); }
+        uint32_t U32(uint64_t offset) const { return (uint32_t)Read(offset, 4); }
+
+        // NUL terminated, at most maxLength characters, clipped to the end of the image
+        std::string String(uint64_t offset, uint64_t maxLength = UINT64_MAX) const
+        {
+            if (offset >= m_size)
+                return "";
+            const uint64_t limit = std::min(m_size - offset, maxLength);
+            const uint8_t* begin = m_data + offset;
+            const uint8_t* end = std::find(begin, begin + limit, 0);
+            return std::string(begin, end);
+        }
+
+    private:
+        const uint8_t* m_data;
+        uint64_t m_size;
+        bool m_bigEndian;
+    };
+
+    bool IsCoffMachine(uint16_t machine)
+    {
+        switch (machine)
+        {
+        case 0x014C: // x86
+        case 0x8664: // x64
+        case 0x01C0: // ARM
+        case 0x01C4: // ARMv7 Thumb
+        case 0xAA64: // ARM64
+        case 0xA641: // ARM64EC
+        case 0xA64E: // ARM64X
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool ReadCoffSymbols(const Reader& image, uint64_t symbols, uint64_t count, size_t recordSize, bool bigObj, SymbolSets& sets)
+    {
+        if (count > image.Size() / recordSize || !image.Has(symbols, count * recordSize))
+            return false;
+
+        const uint64_t strings = symbols + count * recordSize;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            const uint64_t record = symbols + i * recordSize;
+            const uint8_t storageClass = image.Data()[record + recordSize - 2];
+            const uint8_t auxCount = image.Data()[record + recordSize - 1];
+            i += auxCount;
+            if (storageClass != COFF_CLASS_EXTERNAL)
+                continue;
+
+            // Names longer than 8 characters live in the string table
+            const std::string name = image.U32(record) == 0 ? image.String(strings + image.U32(record + 4)) : image.String(record, 8);
+            const uint32_t value = image.U32(record + 8);
+            const int32_t section = bigObj ? (int32_t)image.U32(record + 12) : (int16_t)image.U16(record + 12);
+            if (name.empty())
+                continue;
+
+            // Long-format import libraries describe each DLL with an import descriptor object
+            static const std::string descriptor = "__IMPORT_DESCRIPTOR_";
+            if (section > 0 && name.compare(0, descriptor.size(), descriptor) == 0 && name.size() > descriptor.size())
+                sets.dlls.insert(Lower(name.substr(descriptor.size())) + ".dll");
+
+            // Section 0 with a value is a common symbol, which defines it; -2 marks debug records
+            if (section == 0 && value == 0)
+                sets.undefined.insert(name);
+            else if (section != -2)
+                sets.defined.insert(name);
+        }
+        return true;
+    }
+
+    bool ParseCoff(const Reader& image, SymbolSets& sets)
+    {
+        if (!image.Has(0, COFF_HEADER_SIZE))
+            return false;
+
+        const uint16_t sig1 = image.U16(0);
+        const uint16_t sig2 = image.U16(2);
+        if (sig1 == 0 && sig2 == 0xFFFF)
+        {
+            const uint16_t version = image.U16(4);
+            if (version == 0)
+            {
+                // Short import object: the header is followed by the symbol and DLL names
+                const std::string name = image.String(COFF_HEADER_SIZE);
+                const std::string dll = image.String(COFF_HEADER_SIZE + name.size() + 1);
+                if (name.empty() || dll.empty())
+                    return false;
+                sets.dlls.insert(Lower(dll));
+                sets.defined.insert("__imp_" + name);
+                if ((image.U16(18) & 0x3) == 0) // code, which also gets a thunk under the plain name
+                    sets.defined.insert(name);
+                return true;
+            }
+            if (version >= 2 && image.Has(0, BIGOBJ_HEADER_SIZE) && std::memcmp(image.Data() + 12, BIGOBJ_CLASS_ID, sizeof(BIGOBJ_CLASS_ID)) == 0)
+                return ReadCoffSymbols(image, image.U32(48), image.U32(52), BIGOBJ_SYMBOL_SIZE, true, sets);
+
+            // Anonymous objects, e.g. compiled with /GL for link-time code generation
+            return false;
+        }
+
+        if (!IsCoffMachine(sig1) || image.U16(16) != 0) // objects have no optional header
+            return false;
+        return ReadCoffSymbols(image, image.U32(8), image.U32(12), COFF_SYMBOL_SIZE, false, sets);
+    }
+
+    bool ParseElf(const Reader& file, SymbolSets& sets)
+    {
+        if (!file.Has(0, 64) || file.Data()[4] < 1 || file.Data()[4] > 2 || file.Data()[5] < 1 || file.Data()[5] > 2)
+            return false;
+
+        const bool is64 = file.Data()[4] == 2;
+        const Reader image(file.Data(), file.Size(), file.Data()[5] == 2);
+        if (image.U16(16) != ELF_REL)
+            return false;
+
+        const uint64_t sectionTable = is64 ? image.Read(0x28, 8) : image.U32(0x20);
+        const uint16_t sectionSize = image.U16(is64 ? 0x3A : 0x2E);
+        uint64_t sectionCount = image.U16(is64 ? 0x3C : 0x30);
+        if (sectionSize < (is64 ? 64 : 40) || !image.Has(sectionTable, sectionSize))
+            return sectionCount == 0;
+        if (sectionCount == 0) // more sections than the header field holds: the count is in section 0
+            sectionCount = is64 ? image.Read(sectionTable + 0x20, 8) : image.U32(sectionTable + 0x14);
+        if (sectionCount > image.Size() / sectionSize || !image.Has(sectionTable, sectionCount * sectionSize))
+            return false;
+
+        auto sectionOffset = [&](uint64_t section) { return is64 ? image.Read(section + 0x18, 8) : image.U32(section + 0x10); };
+        auto sectionLength = [&](uint64_t section) { return is64 ? image.Read(section + 0x20, 8) : image.U32(section + 0x14); };
+        const uint64_t symbolSize = is64 ? 24 : 16;
+
+        for (uint64_t i = 0; i < sectionCount; ++i)
+        {
+            const uint64_t section = sectionTable + i * sectionSize;
+            if (image.U32(section + 4) != ELF_SHT_SYMTAB)
+                continue;
+
+            const uint32_t link = image.U32(section + (is64 ? 0x28 : 0x18));
+            if (link >= sectionCount)
+                return false;
+            const uint64_t strings = sectionOffset(sectionTable + link * sectionSize);
+            const uint64_t begin = sectionOffset(section);
+            const uint64_t length = sectionLength(section);
+            uint64_t entrySize = is64 ? image.Read(section + 0x38, 8) : image.U32(section + 0x24);
+            if (entrySize < symbolSize)
+                entrySize = symbolSize;
+            if (!image.Has(begin, length))
+                return false;
+
+            // Entry 0 is the reserved null symbol
+            for (uint64_t symbol = begin + entrySize; symbol + symbolSize <= begin + length; symbol += entrySize)
+            {
+                const uint8_t info = image.Data()[symbol + (is64 ? 4 : 12)];
+                const uint16_t sectionIndex = image.U16(symbol + (is64 ? 6 : 14));
+                const uint8_t binding = info >> 4;
+                if (binding != ELF_STB_GLOBAL && binding != ELF_STB_WEAK && binding != ELF_STB_GNU_UNIQUE)
+                    continue;
+
+                const std::string name = image.String(strings + image.U32(symbol));
+                if (name.empty())
+                    continue;
+                // A weak reference doesn't pull an archive member in
+                if (sectionIndex == ELF_SHN_UNDEF)
+                {
+                    if (binding == ELF_STB_GLOBAL)
+                        sets.undefined.insert(name);
+                }
+                else
+                {
+                    sets.defined.insert(name);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool ParseObject(const Reader& image, SymbolSets& sets)
+    {
+        if (image.Has(0, 4) && std::memcmp(image.Data(), "\x7F" "ELF", 4) == 0)
+            return ParseElf(image, sets);
+        return ParseCoff(image, sets);
+    }
+
+    // Symbol names of an ar index: a big-endian count, one member offset per symbol, then the names
+    bool ParseArchiveIndex(const Reader& member, int width, SymbolSets& index)
+    {
+        const Reader image(member.Data(), member.Size(), true);
+        if (!image.Has(0, width))
+            return false;
+        const uint64_t count = image.Read(0, width);
+        if (count > image.Size() / width || !image.Has(width, count * width))
+            return false;
+
+        uint64_t offset = width + count * width;
+        for (uint64_t i = 0; i < count && offset < image.Size(); ++i)
+        {
+            std::string name = image.String(offset);
+            offset += name.size() + 1;
+            if (!name.empty())
+                index.defined.insert(std::move(name));
+        }
+        return true;
+    }
+
+    std::vector<std::string> Sorted(const std::unordered_set<std::string>& set)
+    {
+        std::vector<std::string> list(set.begin(), set.end());
+        std::sort(list.begin(), list.end());
+        return list;
+    }
+
+    void Finish(const SymbolSets& sets, SymbolTable& table)
+    {
+        table.defined = Sorted(sets.defined);
+        table.undefined.clear();
+        for (const std::string& name : sets.undefined)
+        {
+            if (sets.defined.find(name) == sets.defined.end())
+                table.undefined.push_back(name);
+        }
+        std::sort(table.undefined.begin(), table.undefined.end());
+        table.dlls = Sorted(sets.dlls);
+    }
+
+    bool LoadSymbolCache(const std::string& file, const std::string& fingerprint, std::unordered_map<std::string, SymbolTable>& archives)
+    {
+        std::ifstream in(std::filesystem::u8path(file));
+        std::string line;
+        if (!std::getline(in, line) || line != "@premake-gen symbols 2" || !std::getline(in, line) || line != fingerprint)
+            return false;
+
+        // "@archive", its workspace path, "complete" or "incomplete", then "+defined", "-undefined" and "*dll" lines
+        std::unordered_map<std::string, SymbolTable> loaded;
+        SymbolTable* table = nullptr;
+        while (std::getline(in, line))
+        {
+            if (line == "@archive")
+            {
+                std::string path;
+                std::string state;
+                if (!std::getline(in, path) || !std::getline(in, state))
+                    return false;
+                table = &loaded[path];
+                table->complete = state == "complete";
+            }
+            else if (table != nullptr && line.size() > 1 && line[0] == '+')
+                table->defined.push_back(line.substr(1));
+            else if (table != nullptr && line.size() > 1 && line[0] == '-')
+                table->undefined.push_back(line.substr(1));
+            else if (table != nullptr && line.size() > 1 && line[0] == '*')
+                table->dlls.push_back(line.substr(1));
+            else
+                return false;
+        }
+        archives = std::move(loaded);
+        return true;
+    }
+
+    bool SaveSymbolCache(const std::string& file, const std::string& fingerprint, const std::unordered_map<std::string, SymbolTable>& archives)
+    {
+        const std::filesystem::path path = std::filesystem::u8path(file);
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        // Written aside and renamed, so an interrupted save never leaves a truncated index behind
+        std::filesystem::path staging = path;
+        staging += ".tmp";
+        {
+            std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+            out << "@premake-gen symbols 2\n" << fingerprint << '\n';
+            for (const auto& [archive, table] : archives)
+            {
+                out << "@archive\n" << archive << '\n' << (table.complete ? "complete" : "incomplete") << '\n';
+                for (const std::string& name : table.defined)
+                    out << '+' << name << '\n';
+                for (const std::string& name : table.undefined)
+                    out << '-' << name << '\n';
+                for (const std::string& dll : table.dlls)
+                    out << '*' << dll << '\n';
+            }
+            if (!out)
+                return false;
+        }
+        std::filesystem::rename(staging, path, ec);
+        return !ec;
+    }
+}
+
+bool ArchiveSymbolReader::Feed(const uint8_t* data, size_t size)
+{
+    while (size > 0 && !m_failed)
+    {
+        if (!m_inMember && m_padding > 0)
+        {
+            const size_t take = (size_t)std::min<uint64_t>(size, m_padding);
+            m_padding -= take;
+            data += take;
+            size -= take;
+            continue;
+        }
+
+        if (m_inMember)
+        {
+            const size_t take = (size_t)std::min<uint64_t>(size, m_remaining);
+            if (m_keep)
+                m_member.insert(m_member.end(), data, data + take);
+            m_remaining -= take;
+            data += take;
+            size -= take;
+        }
+        else
+        {
+            const size_t needed = m_magicRead ? AR_HEADER_SIZE : AR_MAGIC_SIZE;
+            const size_t take = std::min(size, needed - m_headerSize);
+            std::memcpy(m_header + m_headerSize, data, take);
+            m_headerSize += take;
+            data += take;
+            size -= take;
+            if (m_headerSize < needed)
+                continue;
+
+            m_headerSize = 0;
+            if (!m_magicRead)
+            {
+                m_magicRead = true;
+                m_failed = std::memcmp(m_header, AR_MAGIC, AR_MAGIC_SIZE) != 0;
+                continue;
+            }
+            m_failed = !ReadHeader();
+        }
+
+        if (m_inMember && m_remaining == 0)
+        {
+            if (m_keep)
+                ParseMember();
+            m_inMember = false;
+        }
+    }
+    return !m_failed;
+}
+
+bool ArchiveSymbolReader::ReadHeader()
+{
+    const char* header = reinterpret_cast<const char*>(m_header);
+    if (header[58] != '`' || header[59] != '\n')
+        return false;
+
+    m_name.assign(header, 16);
+    m_name.erase(m_name.find_last_not_of(' ') + 1);
+    m_remaining = std::strtoull(std::string(header + 48, 10).c_str(), nullptr, 10);
+    m_padding = m_remaining & 1;
+    m_inMember = true;
+
+    // Long name tables and lib.exe's extra tables (the second "/" index, /<ECSYMBOLS>/, ...) add nothing
+    m_isIndex = m_name == "/" || m_name == "/SYM64/";
+    m_keep = !((m_isIndex && m_hasIndex) || m_name == "//" || m_name.compare(0, 2, "/<") == 0);
+    if (m_keep && m_remaining > MAX_MEMBER_SIZE)
+    {
+        m_keep = false;
+        m_complete = m_isIndex ? m_complete : false;
+    }
+    m_member.clear();
+    return true;
+}
+
+void ArchiveSymbolReader::ParseMember()
+{
+    const Reader member(m_member.data(), m_member.size());
+    if (m_isIndex)
+    {
+        m_hasIndex = ParseArchiveIndex(member, m_name == "/" ? 4 : 8, m_index);
+        return;
+    }
+
+    // BSD archives store long member names in front of the data
+    uint64_t nameLength = 0;
+    if (m_name.compare(0, 3, "#1/") == 0)
+    {
+        nameLength = std::strtoull(m_name.c_str() + 3, nullptr, 10);
+        if (nameLength > member.Size())
+        {
+            m_failed = true;
+            return;
+        }
+        m_name = member.String(0, nameLength);
+    }
+    if (m_name.compare(0, 9, "__.SYMDEF") == 0)
+        return;
+
+    if (!ParseObject(Reader(m_member.data() + nameLength, m_member.size() - nameLength), m_members))
+        m_complete = false;
+}
+
+bool ArchiveSymbolReader::Finish(SymbolTable& table)
+{
+    if (m_failed || !m_magicRead || (m_inMember && m_remaining > 0))
+        return false;
+
+    // The index lists what the linker can resolve from this archive, which is what matters for pruning
+    if (m_hasIndex)
+        m_members.defined.insert(m_index.defined.begin(), m_index.defined.end());
+    table = SymbolTable();
+    ::Finish(m_members, table);
+    table.complete = m_complete;
+    return true;
+}
+
+bool ReadArchiveSymbols(const std::string& path, SymbolTable& table)
+{
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    ArchiveSymbolReader reader;
+    std::vector<char> buffer(64 * 1024);
+    while (file)
+    {
+        file.read(buffer.data(), buffer.size());
+        const size_t got = (size_t)file.gcount();
+        if (got == 0 || !reader.Feed(reinterpret_cast<const uint8_t*>(buffer.data()), got))
+            break;
+    }
+    return reader.Finish(table);
+}
+
+bool ReadObjectSymbols(const std::string& path, SymbolTable& table)
+{
+    std::ifstream file(std::filesystem::u8path(path), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    std::vector<uint8_t> data((size_t)file.tellg());
+    file.seekg(0);
+    if (!data.empty() && !file.read(reinterpret_cast<char*>(data.data()), (std::streamsize)data.size()))
+        return false;
+
+    SymbolSets sets;
+    if (!ParseObject(Reader(data.data(), data.size()), sets))
+        return false;
+    table = SymbolTable();
+    Finish(sets, table);
+    return true;
+}
+
+void ResolveLinks(const SymbolTable& objects, const std::vector<std::vector<std::string>>& configurations, std::vector<LinkEntry>& entries)
+{
+    for (const std::vector<std::string>& links : configurations)
+    {
+        std::vector<LinkEntry*> linked;
+        for (const std::string& link : links)
+        {
+            const auto entry = std::find_if(entries.begin(), entries.end(), [&](const LinkEntry& e) { return e.name == link; });
+            if (entry != entries.end())
+                linked.push_back(&*entry);
+        }
+
+        std::unordered_set<std::string> defined(objects.defined.begin(), objects.defined.end());
+        std::unordered_set<std::string> needed;
+        for (const std::string& name : objects.undefined)
+        {
+            if (defined.find(name) == defined.end())
+                needed.insert(name);
+        }
+
+        // Resolve in link order; a used archive needs what its members reference in turn
+        std::vector<bool> used(linked.size(), false);
+        bool opaque = false;
+        for (bool resolved = true; resolved;)
+        {
+            resolved = false;
+            for (size_t i = 0; i < linked.size(); ++i)
+            {
+                if (used[i])
+                    continue;
+                for (const SymbolTable* table : linked[i]->archives)
+                {
+                    used[i] = used[i] || std::any_of(table->defined.begin(), table->defined.end(), [&](const std::string& name) { return needed.find(name) != needed.end(); });
+                }
+                if (!used[i])
+                    continue;
+
+                resolved = true;
+                for (const SymbolTable* table : linked[i]->archives)
+                {
+                    for (const std::string& name : table->defined)
+                    {
+                        needed.erase(name);
+                        defined.insert(name);
+                    }
+                    opaque = opaque || !table->complete;
+                }
+                for (const SymbolTable* table : linked[i]->archives)
+                {
+                    for (const std::string& name : table->undefined)
+                    {
+                        if (defined.find(name) == defined.end())
+                            needed.insert(name);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < linked.size(); ++i)
+        {
+            linked[i]->used = linked[i]->used || used[i];
+            linked[i]->opaque = linked[i]->opaque || opaque;
+        }
+    }
+}
+
+SymbolCache::SymbolCache(std::string folder)
+    : m_folder(std::move(folder))
+{
+}
+
+const SymbolTable* SymbolCache::Get(const std::string& archive, const std::string& library, const std::string& fingerprint,
+    const std::function<bool(SymbolTable&)>& read)
+{
+    std::unordered_map<std::string, SymbolTable>* tables = &m_uncached;
+    if (!library.empty())
+    {
+        const auto [found, inserted] = m_libraries.try_emplace(library);
+        Library& cache = found->second;
+        if (inserted)
+        {
+            cache.fingerprint = fingerprint;
+            LoadSymbolCache(m_folder + "/" + library + ".idx", fingerprint, cache.archives);
+        }
+        tables = &cache.archives;
+
+        const auto cached = tables->find(archive);
+        if (cached != tables->end())
+            return &cached->second;
+        cache.changed = true;
+    }
+    else
+    {
+        const auto cached = tables->find(archive);
+        if (cached != tables->end())
+            return &cached->second;
+    }
+
+    SymbolTable table;
+    if (!read(table))
+        return nullptr;
+    SymbolTable& stored = (*tables)[archive];
+    stored = std::move(table);
+    return &stored;
+}
+
+bool SymbolCache::Save() const
+{
+    bool saved = true;
+    for (const auto& [library, cache] : m_libraries)
+    {
+        if (cache.changed)
+            saved = SaveSymbolCache(m_folder + "/" + library + ".idx", cache.fingerprint, cache.archives) && saved;
+    }
+    return saved;
+}
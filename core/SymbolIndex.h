@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// External symbols of a static library, import library or object file, read straight from the file:
+// COFF objects (including /bigobj and short import objects), ELF relocatable objects, and ar archives
+// as written by lib.exe, llvm-ar and GNU ar. Used by --prune-links to find link entries nothing needs,
+// and by -prune-dlls to find the DLLs the linked import libraries bind to.
+struct SymbolTable
+{
+	std::vector<std::string> defined;   // sorted, unique
+	std::vector<std::string> undefined; // sorted, unique; what the file needs and doesn't define itself
+	std::vector<std::string> dlls;      // sorted, lower case; the DLLs an import library binds to
+
+	// False if a member could not be read (e.g. link-time code generation objects), so undefined may
+	// miss symbols the file pulls in
+	bool complete = true;
+};
+
+// The unsorted sets a SymbolTable is made from while files are parsed
+struct SymbolSets
+{
+	std::unordered_set<std::string> defined;
+	std::unordered_set<std::string> undefined;
+	std::unordered_set<std::string> dlls;
+};
+
+// Reads the symbols of an ar archive fed front to back, e.g. while a library ZIP entry is inflated. Only the
+// member being parsed is held in memory, never the whole archive, and members too large to parse leave the
+// table incomplete. defined comes from the archive's symbol index (its members if it has none), undefined
+// from its members.
+class ArchiveSymbolReader
+{
+public:
+	// False once the data turned out to be no ar archive or a member header is damaged
+	bool Feed(const uint8_t* data, size_t size);
+	// False if Feed() failed or the data ended inside a member
+	bool Finish(SymbolTable& table);
+
+private:
+	uint8_t m_header[60];
+	size_t m_headerSize = 0;      // bytes of the magic or the next member header read so far
+	bool m_magicRead = false;
+	bool m_failed = false;
+	uint64_t m_remaining = 0;     // data bytes of the current member still to come
+	uint64_t m_padding = 0;       // byte after an odd-sized member, as members are 2-byte aligned
+	bool m_inMember = false;
+	bool m_keep = false;          // the current member is parsed, not skipped
+	bool m_isIndex = false;
+	std::string m_name;
+	std::vector<uint8_t> m_member;
+	bool m_hasIndex = false;
+	bool m_complete = true;
+	SymbolSets m_index;
+	SymbolSets m_members;
+
+	bool ReadHeader();
+	void ParseMember();
+};
+
+bool ReadArchiveSymbols(const std::string& path, SymbolTable& table);
+// False if path is not a COFF or ELF object
+bool ReadObjectSymbols(const std::string& path, SymbolTable& table);
+
+// A link entry of the workspace and the archives it resolves to in the library directories
+struct LinkEntry
+{
+	std::string name;
+	std::vector<const SymbolTable*> archives;
+	bool unreadable = false; // one of its archives could not be read
+	bool used = false;       // defines something a configuration that links it needs
+	bool opaque = false;     // a configuration that links it uses an archive that can't be fully analyzed
+};
+
+// Marks the entries the objects pull in. Each configuration lists the names of the entries it links, in
+// link order, and is resolved on its own: a debug/release pair of libraries defines the same symbols, so
+// both are used although one configuration never needs the other's. Marks add up, so calling it for
+// every executable that links the entries keeps the ones any of them needs.
+void ResolveLinks(const SymbolTable& objects, const std::vector<std::vector<std::string>>& configurations, std::vector<LinkEntry>& entries);
+
+// Symbol tables of workspace archives, kept in one file per library under folder and reused while
+// that library's fingerprint stays the same. Archives no library ships are read on every run.
+class SymbolCache
+{
+public:
+	explicit SymbolCache(std::string folder);
+
+	// The table of archive (a workspace path), filled by read if it isn't cached; nullptr if read fails.
+	// library and fingerprint are empty for archives that don't come from a library.
+	const SymbolTable* Get(const std::string& archive, const std::string& library, const std::string& fingerprint,
+		const std::function<bool(SymbolTable&)>& read);
+	// Writes the files of the libraries that had archives read; false if one could not be written
+	bool Save() const;
+
+private:
+	struct Library
+	{
+		std::string fingerprint;
+		std::unordered_map<std::string, SymbolTable> archives;
+		bool changed = false;
+	};
+
+	std::string m_folder;
+	std::unordered_map<std::string, Library> m_libraries;
+	std::unordered_map<std::string, SymbolTable> m_uncached;
+};
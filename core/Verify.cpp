@@ -0,0 +1,129 @@
+#include "Verify.h"
+
+#include "Crc32.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    struct VerifyResult
+    {
+        bool ok = true;
+        std::string message;
+        uint64_t bytes = 0;
+    };
+
+    bool HashFile(const std::string& path, std::vector<char>& buffer, uint32_t& crc, uint64_t& size)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        crc = 0;
+        size = 0;
+        while (file)
+        {
+            file.read(buffer.data(), buffer.size());
+            const size_t got = (size_t)file.gcount();
+            if (got == 0)
+                break;
+            crc = Crc32(buffer.data(), got, crc);
+            size += got;
+        }
+        return !file.bad();
+    }
+
+    std::string Hex(uint32_t value)
+    {
+        char text[9];
+        std::snprintf(text, sizeof(text), "%08x", value);
+        return text;
+    }
+
+    VerifyResult Verify(const VerifyJob& job, std::vector<char>& buffer)
+    {
+        VerifyResult result;
+        uint32_t crc = 0;
+        uint64_t size = 0;
+        if (!HashFile(job.destination, buffer, crc, size))
+        {
+            result.ok = false;
+            result.message = "Missing or unreadable: " + job.destination;
+            return result;
+        }
+        result.bytes = size;
+
+        uint32_t expectedCrc = job.crc32;
+        uint64_t expectedSize = job.size;
+        if (!job.source.empty())
+        {
+            if (!HashFile(job.source, buffer, expectedCrc, expectedSize))
+            {
+                result.ok = false;
+                result.message = "Could not read source: " + job.source;
+                return result;
+            }
+            result.bytes += expectedSize;
+        }
+
+        if (size != expectedSize)
+        {
+            result.ok = false;
+            result.message = "Size mismatch: " + job.destination + " (expected " + std::to_string(expectedSize) + ", found " + std::to_string(size) + ")";
+        }
+        else if (crc != expectedCrc)
+        {
+            result.ok = false;
+            result.message = "CRC mismatch: " + job.destination + " (expected " + Hex(expectedCrc) + ", found " + Hex(crc) + ")";
+        }
+        return result;
+    }
+}
+
+bool VerifyFiles(const std::vector<VerifyJob>& jobs, const IoLimits& limits)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<VerifyResult> results(jobs.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]()
+    {
+        std::vector<char> buffer(limits.bufferSize);
+        for (size_t i = next++; i < jobs.size(); i = next++)
+            results[i] = Verify(jobs[i], buffer);
+    };
+
+    const size_t threadCount = std::max<size_t>(1, std::min({ (size_t)std::thread::hardware_concurrency(), jobs.size(), limits.MaxStreams() }));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    size_t failures = 0;
+    uint64_t bytes = 0;
+    for (const VerifyResult& result : results)
+    {
+        bytes += result.bytes;
+        if (result.ok)
+            continue;
+        ++failures;
+        std::cout << "[ERR] " << result.message << '\n';
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double megabytes = double(bytes) / (1024.0 * 1024.0);
+    std::cout << "Verified " << jobs.size() << " files (" << (uint64_t)megabytes << " MB hashed) in " << seconds << "s, "
+        << (uint64_t)(seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s [" << Crc32Implementation() << ", "
+        << threadCount << " threads]\n";
+    if (failures > 0)
+        std::cout << "[ERR] " << failures << " file(s) failed verification\n";
+    return failures == 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "IoLimits.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A materialized file and what it has to match: the CRC-32 and size stored in the source zip,
+// or the source file itself for folder libraries
+struct VerifyJob
+{
+	std::string destination;
+	std::string source; // empty for zip sources
+	uint32_t crc32 = 0;
+	uint64_t size = 0;
+};
+
+// Checks all jobs in parallel, as many at once as limits allow, and reports every mismatch plus the
+// throughput. False if any file is missing or differs.
+bool VerifyFiles(const std::vector<VerifyJob>& jobs, const IoLimits& limits);
@@ -0,0 +1,826 @@
+#include "ZipArchive.h"
+
+#include "Crc32.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+    constexpr uint32_t EOCD_SIGNATURE = 0x06054b50;
+    constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+    constexpr uint32_t ZIP64_EOCD_SIGNATURE = 0x06064b50;
+    constexpr uint32_t CENTRAL_SIGNATURE = 0x02014b50;
+    constexpr uint32_t LOCAL_SIGNATURE = 0x04034b50;
+
+    constexpr size_t EOCD_SIZE = 22;
+    constexpr size_t CENTRAL_HEADER_SIZE = 46;
+    constexpr size_t LOCAL_HEADER_SIZE = 30;
+
+    constexpr char INDEX_MAGIC[8] = { 'P', 'G', 'Z', 'I', 'D', 'X', '0', '1' };
+    constexpr size_t INDEX_HEADER_SIZE = 8 + 4 * 4;
+    constexpr size_t INDEX_ENTRY_SIZE = 4 * 5 + 1 + 2 + 2 + 4 + 4 + 8 * 3;
+    constexpr const char* INDEX_COMMENT_PREFIX = "premake-gen index v1";
+
+    uint16_t ReadU16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+    uint32_t ReadU32(const uint8_t* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+    uint64_t ReadU64(const uint8_t* p) { return uint64_t(ReadU32(p)) | (uint64_t(ReadU32(p + 4)) << 32); }
+
+    void PutU16(std::vector<uint8_t>& out, uint16_t value)
+    {
+        out.push_back((uint8_t)value);
+        out.push_back((uint8_t)(value >> 8));
+    }
+    void PutU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        PutU16(out, (uint16_t)value);
+        PutU16(out, (uint16_t)(value >> 16));
+    }
+    void PutU64(std::vector<uint8_t>& out, uint64_t value)
+    {
+        PutU32(out, (uint32_t)value);
+        PutU32(out, (uint32_t)(value >> 32));
+    }
+
+    uint32_t HashSegment(std::string_view segment)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char c : segment)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Splits "a/b\\c" into segments, skipping empty and "." segments
+    template <typename Func>
+    bool ForEachSegment(std::string_view path, Func&& func)
+    {
+        size_t start = 0;
+        while (start <= path.size())
+        {
+            size_t end = path.find_first_of("/\\", start);
+            if (end == std::string_view::npos)
+                end = path.size();
+            const std::string_view segment = path.substr(start, end - start);
+            if (!segment.empty() && segment != ".")
+            {
+                if (!func(segment))
+                    return false;
+            }
+            start = end + 1;
+        }
+        return true;
+    }
+}
+
+ZipArchive::ZipArchive(const std::string& path)
+{
+    Open(path);
+}
+
+bool ZipArchive::Open(const std::string& path)
+{
+    Close();
+
+    m_file.open(path, std::ios::binary);
+    if (!m_file.is_open())
+        return false;
+    m_filePath = path;
+
+    uint64_t entryCount = 0;
+    uint64_t directorySize = 0;
+    uint64_t directoryOffset = 0;
+    std::string comment;
+    if (!ReadEndOfDirectory(entryCount, directorySize, directoryOffset, comment))
+    {
+        Close();
+        return false;
+    }
+    m_comment = comment;
+
+    if (LoadIndex(comment, directoryOffset))
+    {
+        m_loadedFromIndex = true;
+        return true;
+    }
+
+    std::vector<uint8_t> directory((size_t)directorySize);
+    m_file.clear();
+    m_file.seekg(directoryOffset);
+    m_file.read(reinterpret_cast<char*>(directory.data()), directory.size());
+    if (!m_file || !BuildTable(directory, entryCount))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ZipArchive::Close()
+{
+    if (m_file.is_open())
+        m_file.close();
+    m_file.clear();
+    m_filePath.clear();
+    m_comment.clear();
+    m_entries.clear();
+    m_children.clear();
+    m_names.clear();
+    m_segments.clear();
+    m_internSlots.clear();
+    m_loadedFromIndex = false;
+}
+
+bool ZipArchive::IsOpen() const
+{
+    return !m_entries.empty();
+}
+
+const std::string& ZipArchive::FilePath() const
+{
+    return m_filePath;
+}
+
+size_t ZipArchive::Size() const
+{
+    return m_entries.empty() ? 0 : m_entries.size() - 1;
+}
+
+uint32_t ZipArchive::Find(std::string_view path) const
+{
+    if (m_entries.empty())
+        return npos;
+
+    uint32_t index = Root();
+    const bool found = ForEachSegment(path, [&](std::string_view segment)
+        {
+            index = FindChild(index, segment);
+            return index != npos;
+        });
+    return found ? index : npos;
+}
+
+bool ZipArchive::Contains(std::string_view path) const
+{
+    return Find(path) != npos;
+}
+
+const ZipArchive::Entry& ZipArchive::operator[](uint32_t index) const
+{
+    return m_entries[index];
+}
+
+std::string_view ZipArchive::Name(uint32_t index) const
+{
+    const Segment& segment = m_segments[m_entries[index].segment];
+    return std::string_view(m_names.data() + segment.offset, segment.length);
+}
+
+ZipArchive::ChildRange ZipArchive::Children(uint32_t index) const
+{
+    const Entry& entry = m_entries[index];
+    const uint32_t* first = m_children.data() + entry.firstChild;
+    return { first, first + entry.childCount };
+}
+
+ZipArchive::SubtreeRange ZipArchive::Subtree(uint32_t index, bool includeRoot) const
+{
+    return { includeRoot ? index : index + 1, m_entries[index].subtreeEnd };
+}
+
+void ZipArchive::RelativePath(uint32_t index, uint32_t ancestor, std::string& out) const
+{
+    size_t length = 0;
+    for (uint32_t i = index; i != ancestor && i != Root(); i = m_entries[i].parent)
+        length += m_segments[m_entries[i].segment].length + 1;
+    if (length > 0)
+        --length;
+
+    out.resize(length);
+    size_t pos = length;
+    for (uint32_t i = index; i != ancestor && i != Root(); i = m_entries[i].parent)
+    {
+        const std::string_view name = Name(i);
+        pos -= name.size();
+        std::memcpy(&out[pos], name.data(), name.size());
+        if (pos > 0)
+            out[--pos] = '/';
+    }
+}
+
+std::string ZipArchive::PathOf(uint32_t index) const
+{
+    std::string path;
+    RelativePath(index, Root(), path);
+    return path;
+}
+
+bool ZipArchive::ExtractToSink(uint32_t index, InflateSink sink, void* userData)
+{
+    const Entry& entry = m_entries[index];
+    if (!entry.isFile || (entry.flags & 1) != 0) // directories and encrypted entries
+        return false;
+    if (!SeekToData(entry))
+        return false;
+
+    // The directory entry is all a damaged or crafted stream is checked against
+    struct Checked
+    {
+        InflateSink sink;
+        void* userData;
+        uint64_t size;
+        uint32_t crc;
+    } checked{ sink, userData, 0, 0 };
+    const InflateSink checkedSink = [](const uint8_t* data, size_t size, void* userData)
+    {
+        Checked& checked = *static_cast<Checked*>(userData);
+        checked.size += size;
+        checked.crc = Crc32(data, size, checked.crc);
+        return checked.sink(data, size, checked.userData);
+    };
+
+    bool extracted = false;
+    switch (entry.method)
+    {
+    case 0:
+        extracted = m_inflater.Copy(m_file, entry.compressedSize, checkedSink, &checked);
+        break;
+    case 8:
+        extracted = m_inflater.Inflate(m_file, entry.compressedSize, checkedSink, &checked);
+        break;
+    default:
+        return false;
+    }
+    return extracted && checked.size == entry.uncompressedSize && checked.crc == entry.crc32;
+}
+
+bool ZipArchive::ExtractToFile(uint32_t index, const std::string& filePath)
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    const bool extracted = ExtractToSink(index, [](const uint8_t* data, size_t size, void* userData)
+        {
+            std::ofstream& file = *static_cast<std::ofstream*>(userData);
+            file.write(reinterpret_cast<const char*>(data), size);
+            return file.good();
+        }, &file);
+
+    file.close();
+    return extracted && !file.fail();
+}
+
+bool ZipArchive::ExtractToString(uint32_t index, std::string& buffer, size_t maxSize)
+{
+    buffer.clear();
+    if (m_entries[index].uncompressedSize > maxSize)
+        return false;
+    buffer.reserve((size_t)m_entries[index].uncompressedSize);
+
+    struct Target
+    {
+        std::string* buffer;
+        size_t maxSize;
+    } target{ &buffer, maxSize };
+    return ExtractToSink(index, [](const uint8_t* data, size_t size, void* userData)
+        {
+            Target& target = *static_cast<Target*>(userData);
+            for (size_t i = 0; i < size; ++i)
+            {
+                if (data[i] != '\r')
+                    target.buffer->push_back((char)data[i]);
+            }
+            // Don't trust the size in the header
+            return target.buffer->size() <= target.maxSize;
+        }, &target);
+}
+
+bool ZipArchive::LoadedFromIndex() const
+{
+    return m_loadedFromIndex;
+}
+
+bool ZipArchive::BuildIndex(const std::vector<uint8_t>& directory, uint64_t entryCount, std::vector<uint8_t>& index)
+{
+    ZipArchive archive;
+    if (!archive.BuildTable(directory, entryCount))
+        return false;
+    archive.SerializeTable(index);
+    return true;
+}
+
+std::string ZipArchive::IndexComment(uint64_t indexOffset, const std::vector<uint8_t>& index, uint64_t directoryOffset)
+{
+    std::ostringstream comment;
+    comment << INDEX_COMMENT_PREFIX << ' ' << indexOffset << ' ' << index.size() << ' '
+        << Crc32(index.data(), index.size()) << ' ' << directoryOffset;
+    return comment.str();
+}
+
+bool ZipArchive::ReadEndOfDirectory(uint64_t& entryCount, uint64_t& directorySize, uint64_t& directoryOffset, std::string& comment)
+{
+    m_file.seekg(0, std::ios::end);
+    const uint64_t fileSize = (uint64_t)m_file.tellg();
+    if (fileSize < EOCD_SIZE)
+        return false;
+
+    // End of central directory record: last 22 bytes plus an optional comment of up to 64KB
+    const size_t tailSize = (size_t)std::min<uint64_t>(fileSize, EOCD_SIZE + 0xFFFF);
+    std::vector<uint8_t> tail(tailSize);
+    m_file.seekg(fileSize - tailSize);
+    m_file.read(reinterpret_cast<char*>(tail.data()), tailSize);
+    if (!m_file)
+        return false;
+
+    size_t eocd = tailSize - EOCD_SIZE + 1;
+    do
+    {
+        --eocd;
+        if (ReadU32(&tail[eocd]) == EOCD_SIGNATURE)
+            break;
+    } while (eocd > 0);
+    if (ReadU32(&tail[eocd]) != EOCD_SIGNATURE)
+        return false;
+
+    entryCount = ReadU16(&tail[eocd + 10]);
+    directorySize = ReadU32(&tail[eocd + 12]);
+    directoryOffset = ReadU32(&tail[eocd + 16]);
+
+    const size_t commentLength = std::min<size_t>(ReadU16(&tail[eocd + 20]), tailSize - eocd - EOCD_SIZE);
+    comment.assign(reinterpret_cast<const char*>(&tail[eocd + EOCD_SIZE]), commentLength);
+
+    if (entryCount == 0xFFFF || directorySize == 0xFFFFFFFF || directoryOffset == 0xFFFFFFFF)
+    {
+        const uint64_t eocdPosition = fileSize - tailSize + eocd;
+        if (eocdPosition < 20)
+            return false;
+
+        uint8_t locator[20];
+        m_file.seekg(eocdPosition - 20);
+        m_file.read(reinterpret_cast<char*>(locator), sizeof(locator));
+        if (!m_file || ReadU32(locator) != ZIP64_LOCATOR_SIGNATURE)
+            return false;
+
+        uint8_t record[56];
+        m_file.seekg(ReadU64(locator + 8));
+        m_file.read(reinterpret_cast<char*>(record), sizeof(record));
+        if (!m_file || ReadU32(record) != ZIP64_EOCD_SIGNATURE)
+            return false;
+
+        entryCount = ReadU64(record + 32);
+        directorySize = ReadU64(record + 40);
+        directoryOffset = ReadU64(record + 48);
+    }
+
+    return directoryOffset + directorySize <= fileSize;
+}
+
+bool ZipArchive::BuildTable(const std::vector<uint8_t>& directory, uint64_t entryCount)
+{
+    // Every record takes at least a header, so a larger count comes from a damaged end record
+    if (entryCount > directory.size() / CENTRAL_HEADER_SIZE)
+        return false;
+
+    // Names can never take more room than the directory that contains them
+    m_names.reserve(directory.size());
+    m_segments.reserve((size_t)entryCount + 1);
+
+    std::vector<Entry> nodes;
+    nodes.reserve((size_t)entryCount + 1);
+    nodes.emplace_back().segment = Intern("");
+
+    // (parent, segment) -> node, open addressing
+    std::vector<uint32_t> childSlots(64, 0);
+    auto slotHash = [](uint32_t parent, uint32_t segment)
+        {
+            return (parent * 0x9E3779B1u) ^ (segment * 0x85EBCA77u);
+        };
+    auto findOrAddChild = [&](uint32_t parent, uint32_t segment)
+        {
+            if ((nodes.size() + 1) * 2 > childSlots.size())
+            {
+                std::vector<uint32_t> grown(childSlots.size() * 2, 0);
+                for (uint32_t i = 1; i < (uint32_t)nodes.size(); ++i)
+                {
+                    size_t slot = slotHash(nodes[i].parent, nodes[i].segment) & (grown.size() - 1);
+                    while (grown[slot] != 0)
+                        slot = (slot + 1) & (grown.size() - 1);
+                    grown[slot] = i + 1;
+                }
+                childSlots.swap(grown);
+            }
+
+            size_t slot = slotHash(parent, segment) & (childSlots.size() - 1);
+            while (childSlots[slot] != 0)
+            {
+                const uint32_t node = childSlots[slot] - 1;
+                if (nodes[node].parent == parent && nodes[node].segment == segment)
+                    return node;
+                slot = (slot + 1) & (childSlots.size() - 1);
+            }
+
+            const uint32_t node = (uint32_t)nodes.size();
+            Entry& entry = nodes.emplace_back();
+            entry.segment = segment;
+            entry.parent = parent;
+            childSlots[slot] = node + 1;
+            return node;
+        };
+
+    size_t pos = 0;
+    for (uint64_t record = 0; record < entryCount; ++record)
+    {
+        if (pos + CENTRAL_HEADER_SIZE > directory.size())
+            return false;
+        const uint8_t* header = &directory[pos];
+        if (ReadU32(header) != CENTRAL_SIGNATURE)
+            return false;
+
+        const uint16_t nameLength = ReadU16(header + 28);
+        const uint16_t extraLength = ReadU16(header + 30);
+        const uint16_t commentLength = ReadU16(header + 32);
+        const size_t recordSize = CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+        if (pos + recordSize > directory.size())
+            return false;
+
+        const std::string_view name(reinterpret_cast<const char*>(header + CENTRAL_HEADER_SIZE), nameLength);
+        pos += recordSize;
+
+        if (name == INDEX_ENTRY_NAME)
+            continue;
+
+        // Never let an entry escape its destination folder
+        bool unsafe = false;
+        ForEachSegment(name, [&](std::string_view segment)
+            {
+                unsafe = (segment == "..");
+                return !unsafe;
+            });
+        if (unsafe)
+            continue;
+
+        uint32_t node = Root();
+        ForEachSegment(name, [&](std::string_view segment)
+            {
+                node = findOrAddChild(node, Intern(segment));
+                return true;
+            });
+        if (node == Root())
+            continue;
+
+        Entry& entry = nodes[node];
+        entry.isFile = !(name.back() == '/' || name.back() == '\\');
+        entry.flags = ReadU16(header + 8);
+        entry.method = ReadU16(header + 10);
+        entry.dosDateTime = ReadU32(header + 12);
+        entry.crc32 = ReadU32(header + 16);
+        entry.compressedSize = ReadU32(header + 20);
+        entry.uncompressedSize = ReadU32(header + 24);
+        entry.localHeaderOffset = ReadU32(header + 42);
+        // Host system 3 (Unix) keeps the file mode in the high half of the external attributes
+        if (ReadU16(header + 4) >> 8 == 3)
+            entry.unixMode = (uint16_t)((ReadU32(header + 38) >> 16) & 0777);
+
+        // ZIP64 extended information replaces the fields that are saturated
+        const uint8_t* extra = header + CENTRAL_HEADER_SIZE + nameLength;
+        const uint8_t* extraEnd = extra + extraLength;
+        while (extra + 4 <= extraEnd)
+        {
+            const uint16_t id = ReadU16(extra);
+            const uint16_t size = ReadU16(extra + 2);
+            const uint8_t* field = extra + 4;
+            const uint8_t* fieldEnd = std::min(field + size, extraEnd);
+            if (id == 0x0001)
+            {
+                if (entry.uncompressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                {
+                    entry.uncompressedSize = ReadU64(field);
+                    field += 8;
+                }
+                if (entry.compressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                {
+                    entry.compressedSize = ReadU64(field);
+                    field += 8;
+                }
+                if (entry.localHeaderOffset == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                    entry.localHeaderOffset = ReadU64(field);
+                break;
+            }
+            extra = field + size;
+        }
+    }
+
+    // Lay the tree out depth-first with name-sorted children
+    const uint32_t count = (uint32_t)nodes.size();
+    std::vector<uint32_t> sorted(count - 1);
+    for (uint32_t i = 1; i < count; ++i)
+        sorted[i - 1] = i;
+    std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b)
+        {
+            if (nodes[a].parent != nodes[b].parent)
+                return nodes[a].parent < nodes[b].parent;
+            const Segment& sa = m_segments[nodes[a].segment];
+            const Segment& sb = m_segments[nodes[b].segment];
+            return std::string_view(m_names.data() + sa.offset, sa.length) < std::string_view(m_names.data() + sb.offset, sb.length);
+        });
+
+    std::vector<uint32_t> childStart(count + 1, 0);
+    for (const uint32_t node : sorted)
+        ++childStart[nodes[node].parent + 1];
+    for (uint32_t i = 0; i < count; ++i)
+        childStart[i + 1] += childStart[i];
+
+    std::vector<uint32_t> preorder;
+    preorder.reserve(count);
+    std::vector<uint32_t> stack;
+    stack.push_back(Root());
+    while (!stack.empty())
+    {
+        const uint32_t node = stack.back();
+        stack.pop_back();
+        preorder.push_back(node);
+        for (uint32_t i = childStart[node + 1]; i > childStart[node]; --i)
+            stack.push_back(sorted[i - 1]);
+    }
+
+    std::vector<uint32_t> newIndex(count);
+    for (uint32_t i = 0; i < count; ++i)
+        newIndex[preorder[i]] = i;
+
+    std::vector<uint32_t> subtreeSize(count, 1);
+    for (uint32_t i = count; i-- > 1;)
+        subtreeSize[nodes[preorder[i]].parent] += subtreeSize[preorder[i]];
+
+    m_entries.resize(count);
+    m_children.resize(count - 1);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t node = preorder[i];
+        Entry& entry = m_entries[i];
+        entry = nodes[node];
+        entry.parent = (node == Root()) ? npos : newIndex[nodes[node].parent];
+        entry.subtreeEnd = i + subtreeSize[node];
+        entry.firstChild = childStart[node];
+        entry.childCount = childStart[node + 1] - childStart[node];
+        for (uint32_t c = childStart[node]; c < childStart[node + 1]; ++c)
+            m_children[c] = newIndex[sorted[c]];
+    }
+    return true;
+}
+
+void ZipArchive::SerializeTable(std::vector<uint8_t>& index) const
+{
+    index.clear();
+    index.reserve(INDEX_HEADER_SIZE + m_entries.size() * INDEX_ENTRY_SIZE + m_children.size() * 4 + m_segments.size() * 8 + m_names.size());
+    index.insert(index.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+    PutU32(index, (uint32_t)m_entries.size());
+    PutU32(index, (uint32_t)m_children.size());
+    PutU32(index, (uint32_t)m_segments.size());
+    PutU32(index, (uint32_t)m_names.size());
+
+    for (const Entry& entry : m_entries)
+    {
+        PutU32(index, entry.segment);
+        PutU32(index, entry.parent);
+        PutU32(index, entry.subtreeEnd);
+        PutU32(index, entry.firstChild);
+        PutU32(index, entry.childCount);
+        index.push_back(entry.isFile ? 1 : 0);
+        PutU16(index, entry.method);
+        PutU16(index, entry.flags);
+        PutU32(index, entry.crc32);
+        PutU32(index, entry.dosDateTime);
+        PutU64(index, entry.compressedSize);
+        PutU64(index, entry.uncompressedSize);
+        PutU64(index, entry.localHeaderOffset);
+    }
+    for (const uint32_t child : m_children)
+        PutU32(index, child);
+    for (const Segment& segment : m_segments)
+    {
+        PutU32(index, segment.offset);
+        PutU32(index, segment.length);
+    }
+    index.insert(index.end(), m_names.begin(), m_names.end());
+}
+
+bool ZipArchive::LoadIndex(const std::string& comment, uint64_t directoryOffset)
+{
+    if (comment.compare(0, std::strlen(INDEX_COMMENT_PREFIX), INDEX_COMMENT_PREFIX) != 0)
+        return false;
+
+    std::istringstream fields(comment.substr(std::strlen(INDEX_COMMENT_PREFIX)));
+    uint64_t indexOffset = 0;
+    uint64_t indexSize = 0;
+    uint32_t indexCrc = 0;
+    uint64_t indexDirectoryOffset = 0;
+    if (!(fields >> indexOffset >> indexSize >> indexCrc >> indexDirectoryOffset))
+        return false;
+    // The archive was rewritten by another tool after packing
+    if (indexDirectoryOffset != directoryOffset || indexSize < INDEX_HEADER_SIZE || indexOffset >= directoryOffset)
+        return false;
+
+    uint8_t header[LOCAL_HEADER_SIZE];
+    m_file.clear();
+    m_file.seekg(indexOffset);
+    m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!m_file || ReadU32(header) != LOCAL_SIGNATURE || ReadU16(header + 8) != 0)
+        return false;
+    // The index entry lies before the central directory; a size from a damaged comment must not decide the allocation
+    const uint64_t indexData = indexOffset + LOCAL_HEADER_SIZE + ReadU16(header + 26) + ReadU16(header + 28);
+    if (indexData > directoryOffset || indexSize > directoryOffset - indexData)
+        return false;
+    m_file.seekg(indexData);
+
+    std::vector<uint8_t> index((size_t)indexSize);
+    m_file.read(reinterpret_cast<char*>(index.data()), index.size());
+    if (!m_file || Crc32(index.data(), index.size()) != indexCrc ||
+        std::memcmp(index.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+        return false;
+
+    const uint8_t* p = index.data() + sizeof(INDEX_MAGIC);
+    const uint32_t entryCount = ReadU32(p);
+    const uint32_t childCount = ReadU32(p + 4);
+    const uint32_t segmentCount = ReadU32(p + 8);
+    const uint32_t namesSize = ReadU32(p + 12);
+    p += 16;
+    if (entryCount == 0 || indexSize != INDEX_HEADER_SIZE + uint64_t(entryCount) * INDEX_ENTRY_SIZE +
+        uint64_t(childCount) * 4 + uint64_t(segmentCount) * 8 + namesSize)
+        return false;
+
+    m_entries.resize(entryCount);
+    for (Entry& entry : m_entries)
+    {
+        entry.segment = ReadU32(p);
+        entry.parent = ReadU32(p + 4);
+        entry.subtreeEnd = ReadU32(p + 8);
+        entry.firstChild = ReadU32(p + 12);
+        entry.childCount = ReadU32(p + 16);
+        entry.isFile = p[20] != 0;
+        entry.method = ReadU16(p + 21);
+        entry.flags = ReadU16(p + 23);
+        entry.crc32 = ReadU32(p + 25);
+        entry.dosDateTime = ReadU32(p + 29);
+        entry.compressedSize = ReadU64(p + 33);
+        entry.uncompressedSize = ReadU64(p + 41);
+        entry.localHeaderOffset = ReadU64(p + 49);
+        p += INDEX_ENTRY_SIZE;
+    }
+    m_children.resize(childCount);
+    for (uint32_t& child : m_children)
+    {
+        child = ReadU32(p);
+        p += 4;
+    }
+    m_segments.resize(segmentCount);
+    for (Segment& segment : m_segments)
+    {
+        segment.offset = ReadU32(p);
+        segment.length = ReadU32(p + 4);
+        p += 8;
+    }
+    m_names.assign(p, p + namesSize);
+
+    // Never trust indices from disk
+    bool valid = true;
+    for (uint32_t i = 0; i < entryCount && valid; ++i)
+    {
+        const Entry& entry = m_entries[i];
+        valid = entry.segment < segmentCount &&
+            (i == 0 ? entry.parent == npos : entry.parent < i) &&
+            entry.subtreeEnd > i && entry.subtreeEnd <= entryCount &&
+            uint64_t(entry.firstChild) + entry.childCount <= childCount;
+    }
+    for (uint32_t i = 0; i < childCount && valid; ++i)
+        valid = m_children[i] > 0 && m_children[i] < entryCount;
+    for (uint32_t i = 0; i < segmentCount && valid; ++i)
+        valid = uint64_t(m_segments[i].offset) + m_segments[i].length <= namesSize;
+    // Names become destination paths, so hold them to the rules BuildTable applies to the central directory
+    for (uint32_t i = 1; i < entryCount && valid; ++i)
+    {
+        const Segment& segment = m_segments[m_entries[i].segment];
+        const std::string_view name(m_names.data() + segment.offset, segment.length);
+        valid = !name.empty() && name != "." && name != ".." && name.find_first_of("/\\") == std::string_view::npos;
+    }
+    if (!valid)
+    {
+        m_entries.clear();
+        m_children.clear();
+        m_segments.clear();
+        m_names.clear();
+        return false;
+    }
+
+    size_t slotCount = 64;
+    while (slotCount < (m_segments.size() + 1) * 2)
+        slotCount *= 2;
+    RebuildInternSlots(slotCount);
+    return true;
+}
+
+void ZipArchive::RebuildInternSlots(size_t slotCount)
+{
+    std::vector<uint32_t> slots(slotCount, 0);
+    for (uint32_t id = 0; id < (uint32_t)m_segments.size(); ++id)
+    {
+        const Segment& s = m_segments[id];
+        size_t slot = HashSegment(std::string_view(m_names.data() + s.offset, s.length)) & (slots.size() - 1);
+        while (slots[slot] != 0)
+            slot = (slot + 1) & (slots.size() - 1);
+        slots[slot] = id + 1;
+    }
+    m_internSlots.swap(slots);
+}
+
+uint32_t ZipArchive::Intern(std::string_view segment)
+{
+    if ((m_segments.size() + 1) * 2 > m_internSlots.size())
+        RebuildInternSlots(std::max<size_t>(64, m_internSlots.size() * 2));
+
+    size_t slot = HashSegment(segment) & (m_internSlots.size() - 1);
+    while (m_internSlots[slot] != 0)
+    {
+        const uint32_t id = m_internSlots[slot] - 1;
+        const Segment& s = m_segments[id];
+        if (std::string_view(m_names.data() + s.offset, s.length) == segment)
+            return id;
+        slot = (slot + 1) & (m_internSlots.size() - 1);
+    }
+
+    const uint32_t id = (uint32_t)m_segments.size();
+    m_segments.push_back({ (uint32_t)m_names.size(), (uint32_t)segment.size() });
+    m_names.insert(m_names.end(), segment.begin(), segment.end());
+    m_internSlots[slot] = id + 1;
+    return id;
+}
+
+uint32_t ZipArchive::FindSegment(std::string_view segment) const
+{
+    if (m_internSlots.empty())
+        return npos;
+
+    size_t slot = HashSegment(segment) & (m_internSlots.size() - 1);
+    while (m_internSlots[slot] != 0)
+    {
+        const uint32_t id = m_internSlots[slot] - 1;
+        const Segment& s = m_segments[id];
+        if (std::string_view(m_names.data() + s.offset, s.length) == segment)
+            return id;
+        slot = (slot + 1) & (m_internSlots.size() - 1);
+    }
+    return npos;
+}
+
+uint32_t ZipArchive::FindChild(uint32_t parent, std::string_view name) const
+{
+    // Unknown segments cannot be anywhere in the archive
+    const uint32_t segment = FindSegment(name);
+    if (segment == npos)
+        return npos;
+
+    const ChildRange children = Children(parent);
+    const uint32_t* it = std::lower_bound(children.begin(), children.end(), name, [&](uint32_t child, std::string_view value)
+        {
+            return Name(child) < value;
+        });
+    if (it != children.end() && m_entries[*it].segment == segment)
+        return *it;
+    return npos;
+}
+
+void ZipArchive::SetBufferSize(size_t bufferSize)
+{
+    m_inflater.SetInputBufferSize(bufferSize);
+}
+
+void ZipArchive::ReleaseFile()
+{
+    if (m_file.is_open())
+        m_file.close();
+    m_file.clear();
+    m_inflater.Release();
+}
+
+bool ZipArchive::SeekToData(const Entry& entry)
+{
+    if (!m_file.is_open())
+    {
+        m_file.open(m_filePath, std::ios::binary);
+        if (!m_file.is_open())
+            return false;
+    }
+
+    uint8_t header[LOCAL_HEADER_SIZE];
+    m_file.clear();
+    m_file.seekg(entry.localHeaderOffset);
+    m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!m_file || ReadU32(header) != LOCAL_SIGNATURE)
+        return false;
+
+    m_file.seekg(entry.localHeaderOffset + LOCAL_HEADER_SIZE + ReadU16(header + 26) + ReadU16(header + 28));
+    return (bool)m_file;
+}
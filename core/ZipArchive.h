@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Inflate.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only ZIP archive backed by a flat entry table.
+//
+// The central directory is parsed once into a few contiguous arrays:
+//  - every distinct path segment ("include", "lib", ...) is interned once into a character arena
+//  - entries are laid out depth-first, so the descendants of an entry are the index range
+//    (index, subtreeEnd) and can be walked with a plain loop
+//  - the children of each entry are a contiguous, name-sorted range of the child table
+// Lookups take a std::string_view and never allocate.
+//
+// Archives written by "premake-gen --pack" embed this table as a stored entry that the archive
+// comment points at, so opening them skips the central directory walk entirely.
+class ZipArchive
+{
+public:
+	static constexpr uint32_t npos = UINT32_MAX;
+	static constexpr const char* INDEX_ENTRY_NAME = ".premake-gen-index";
+
+	struct Entry
+	{
+		uint32_t segment = 0;           // interned name segment
+		uint32_t parent = npos;
+		uint32_t subtreeEnd = 0;        // one past the last descendant
+		uint32_t firstChild = 0;        // offset into the child table
+		uint32_t childCount = 0;
+		bool isFile = false;
+
+		uint16_t method = 0;            // 0 = stored, 8 = deflate
+		uint16_t flags = 0;
+		uint16_t unixMode = 0;          // permission bits archived on Unix; 0 if not recorded or read from an index
+		uint32_t crc32 = 0;
+		uint32_t dosDateTime = 0;
+		uint64_t compressedSize = 0;
+		uint64_t uncompressedSize = 0;
+		uint64_t localHeaderOffset = 0;
+	};
+
+	// Iterates entry indices in [first, last)
+	class IndexIterator
+	{
+	public:
+		IndexIterator(uint32_t index) : m_index(index) {}
+		uint32_t operator*() const { return m_index; }
+		IndexIterator& operator++() { ++m_index; return *this; }
+		bool operator!=(const IndexIterator& other) const { return m_index != other.m_index; }
+		bool operator==(const IndexIterator& other) const { return m_index == other.m_index; }
+
+	private:
+		uint32_t m_index;
+	};
+
+	struct SubtreeRange
+	{
+		uint32_t first = 0;
+		uint32_t last = 0;
+		IndexIterator begin() const { return first; }
+		IndexIterator end() const { return last; }
+		size_t size() const { return last - first; }
+	};
+
+	struct ChildRange
+	{
+		const uint32_t* first = nullptr;
+		const uint32_t* last = nullptr;
+		const uint32_t* begin() const { return first; }
+		const uint32_t* end() const { return last; }
+		size_t size() const { return last - first; }
+	};
+
+	ZipArchive() = default;
+	ZipArchive(const std::string& path);
+
+	ZipArchive(const ZipArchive&) = delete;
+	ZipArchive& operator=(const ZipArchive&) = delete;
+
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen() const;
+	const std::string& FilePath() const;
+
+	size_t Size() const; // number of entries, not counting the root
+	uint32_t Root() const { return 0; }
+
+	uint32_t Find(std::string_view path) const; // npos if not found
+	bool Contains(std::string_view path) const;
+
+	const Entry& operator[](uint32_t index) const;
+	std::string_view Name(uint32_t index) const;
+	ChildRange Children(uint32_t index) const;
+
+	// Descendants of index in depth-first order (parents before their children)
+	SubtreeRange Subtree(uint32_t index, bool includeRoot = false) const;
+
+	// Writes the '/' separated path of index relative to ancestor into out, reusing its capacity
+	void RelativePath(uint32_t index, uint32_t ancestor, std::string& out) const;
+	std::string PathOf(uint32_t index) const;
+
+	bool ExtractToSink(uint32_t index, InflateSink sink, void* userData = nullptr);
+	bool ExtractToFile(uint32_t index, const std::string& filePath);
+	// Removes '\r' like zipp. Fails instead of allocating for entries larger than maxSize.
+	bool ExtractToString(uint32_t index, std::string& buffer, size_t maxSize = SIZE_MAX);
+
+	bool LoadedFromIndex() const;
+	const std::string& Comment() const { return m_comment; }
+
+	// Size of the read buffer used by extraction; the inflate window adds a fixed 32KB
+	void SetBufferSize(size_t bufferSize);
+
+	// Closes the file handle and frees the extraction buffers but keeps the entry table;
+	// the next extraction reopens the file
+	void ReleaseFile();
+
+	// Serialized entry table for a central directory, and the archive comment that locates it
+	static bool BuildIndex(const std::vector<uint8_t>& directory, uint64_t entryCount, std::vector<uint8_t>& index);
+	static std::string IndexComment(uint64_t indexOffset, const std::vector<uint8_t>& index, uint64_t directoryOffset);
+
+private:
+	struct Segment
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	std::vector<Entry> m_entries;
+	std::vector<uint32_t> m_children;
+	std::vector<char> m_names;
+	std::vector<Segment> m_segments;
+	std::vector<uint32_t> m_internSlots; // open addressing: segment id + 1, 0 = empty
+
+	std::ifstream m_file;
+	std::string m_filePath;
+	std::string m_comment;
+	Inflater m_inflater;
+	bool m_loadedFromIndex = false;
+
+	bool ReadEndOfDirectory(uint64_t& entryCount, uint64_t& directorySize, uint64_t& directoryOffset, std::string& comment);
+	bool BuildTable(const std::vector<uint8_t>& directory, uint64_t entryCount);
+	void SerializeTable(std::vector<uint8_t>& index) const;
+	bool LoadIndex(const std::string& comment, uint64_t directoryOffset);
+
+	void RebuildInternSlots(size_t slotCount);
+	uint32_t Intern(std::string_view segment);
+	uint32_t FindSegment(std::string_view segment) const;
+	uint32_t FindChild(uint32_t parent, std::string_view name) const;
+	bool SeekToData(const Entry& entry);
+};
@@ -0,0 +1,358 @@
+#include "ZipWriter.h"
+
+#include "Crc32.h"
+
+#include <algorithm>
+#include <ctime>
+
+namespace
+{
+    constexpr uint32_t LOCAL_SIGNATURE = 0x04034b50;
+    constexpr uint32_t CENTRAL_SIGNATURE = 0x02014b50;
+    constexpr uint32_t ZIP64_EOCD_SIGNATURE = 0x06064b50;
+    constexpr uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+    constexpr uint32_t EOCD_SIGNATURE = 0x06054b50;
+
+    constexpr uint16_t FLAG_UTF8 = 0x0800;
+    constexpr uint64_t ZIP64_THRESHOLD = 0xFFFF0000; // leaves room for deflate expansion
+
+    void PutU16(std::vector<uint8_t>& out, uint16_t value)
+    {
+        out.push_back((uint8_t)value);
+        out.push_back((uint8_t)(value >> 8));
+    }
+
+    void PutU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        PutU16(out, (uint16_t)value);
+        PutU16(out, (uint16_t)(value >> 16));
+    }
+
+    void PutU64(std::vector<uint8_t>& out, uint64_t value)
+    {
+        PutU32(out, (uint32_t)value);
+        PutU32(out, (uint32_t)(value >> 32));
+    }
+
+    uint32_t CurrentDosDateTime()
+    {
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        const uint32_t year = (uint32_t)std::max(local.tm_year - 80, 0);
+        const uint32_t date = (year << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday;
+        const uint32_t time = (local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2);
+        return (date << 16) | time;
+    }
+
+    struct OutputTarget
+    {
+        std::ofstream* file;
+        uint64_t written;
+    };
+}
+
+ZipWriter::~ZipWriter()
+{
+    if (m_file.is_open())
+        Close();
+}
+
+bool ZipWriter::Open(const std::string& path, size_t bufferSize)
+{
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+        return false;
+
+    m_path = path;
+    m_records.clear();
+    m_buffer.resize(std::max<size_t>(bufferSize, 4096));
+    m_offset = 0;
+    m_dosDateTime = CurrentDosDateTime();
+    return true;
+}
+
+bool ZipWriter::OpenAppend(const std::string& path, size_t bufferSize)
+{
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+
+    // Not std::ios::app: local headers are patched in place once their sizes are known
+    m_file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!m_file.is_open())
+        return false;
+    m_file.seekp(size);
+
+    m_path = path;
+    m_records.clear();
+    m_buffer.resize(std::max<size_t>(bufferSize, 4096));
+    m_offset = size;
+    m_dosDateTime = CurrentDosDateTime();
+    return true;
+}
+
+bool ZipWriter::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+bool ZipWriter::AddDirectory(const std::string& name)
+{
+    Record record;
+    record.name = name + "/";
+    record.isDirectory = true;
+    record.localHeaderOffset = m_offset;
+    if (!WriteLocalHeader(record, false))
+        return false;
+
+    m_records.push_back(std::move(record));
+    return true;
+}
+
+bool ZipWriter::AddFile(const std::string& name, const std::filesystem::path& source, bool compress, double minSavings)
+{
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(source, ec);
+    if (ec)
+        return false;
+
+    Record record;
+    record.name = name;
+    record.uncompressedSize = size;
+    record.localHeaderOffset = m_offset;
+#ifndef _WIN32
+    // Executables such as a Linux premake5 have to stay executable when extracted
+    record.unixMode = (uint16_t)((uint32_t)std::filesystem::status(source, ec).permissions() & 0777);
+#endif
+    const bool zip64 = size >= ZIP64_THRESHOLD;
+    if (!WriteLocalHeader(record, zip64))
+        return false;
+    const uint64_t dataStart = m_offset;
+
+    bool written = false;
+    if (compress && size > 0)
+    {
+        written = CopyDeflated(source, record);
+        if (written && record.compressedSize > uint64_t(double(size) * (1.0 - minSavings)))
+        {
+            // Not worth the decompression cost, rewrite it stored
+            m_file.seekp(dataStart);
+            written = false;
+        }
+    }
+    if (!written && !CopyStored(source, record))
+        return false;
+
+    m_offset = dataStart + record.compressedSize;
+    m_file.seekp(record.localHeaderOffset);
+    const uint64_t end = m_offset;
+    if (!WriteLocalHeader(record, zip64))
+        return false;
+    m_offset = end;
+    m_file.seekp(m_offset);
+
+    m_records.push_back(std::move(record));
+    return (bool)m_file;
+}
+
+bool ZipWriter::AddData(const std::string& name, const uint8_t* data, size_t size)
+{
+    Record record;
+    record.name = name;
+    record.crc32 = Crc32(data, size);
+    record.compressedSize = size;
+    record.uncompressedSize = size;
+    record.localHeaderOffset = m_offset;
+    if (!WriteLocalHeader(record, size >= ZIP64_THRESHOLD))
+        return false;
+
+    m_file.write(reinterpret_cast<const char*>(data), size);
+    m_offset += size;
+    m_records.push_back(std::move(record));
+    return (bool)m_file;
+}
+
+bool ZipWriter::WriteLocalHeader(const Record& record, bool reserveZip64)
+{
+    std::vector<uint8_t> header;
+    header.reserve(30 + record.name.size() + 20);
+    PutU32(header, LOCAL_SIGNATURE);
+    PutU16(header, reserveZip64 ? 45 : 20);
+    PutU16(header, FLAG_UTF8);
+    PutU16(header, record.method);
+    PutU32(header, m_dosDateTime);
+    PutU32(header, record.crc32);
+    PutU32(header, reserveZip64 ? 0xFFFFFFFF : (uint32_t)record.compressedSize);
+    PutU32(header, reserveZip64 ? 0xFFFFFFFF : (uint32_t)record.uncompressedSize);
+    PutU16(header, (uint16_t)record.name.size());
+    PutU16(header, reserveZip64 ? 20 : 0);
+    header.insert(header.end(), record.name.begin(), record.name.end());
+    if (reserveZip64)
+    {
+        PutU16(header, 0x0001);
+        PutU16(header, 16);
+        PutU64(header, record.uncompressedSize);
+        PutU64(header, record.compressedSize);
+    }
+
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_offset += header.size();
+    return (bool)m_file;
+}
+
+bool ZipWriter::CopyStored(const std::filesystem::path& source, Record& record)
+{
+    std::ifstream input(source, std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    record.method = 0;
+    record.crc32 = 0;
+    record.compressedSize = 0;
+    while (input)
+    {
+        input.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+        const size_t got = (size_t)input.gcount();
+        if (got == 0)
+            break;
+        record.crc32 = Crc32(m_buffer.data(), got, record.crc32);
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()), got);
+        record.compressedSize += got;
+    }
+    return (bool)m_file && record.compressedSize == record.uncompressedSize;
+}
+
+bool ZipWriter::CopyDeflated(const std::filesystem::path& source, Record& record)
+{
+    std::ifstream input(source, std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    OutputTarget target{ &m_file, 0 };
+    m_deflater.Begin([](const uint8_t* data, size_t size, void* userData)
+        {
+            OutputTarget& target = *static_cast<OutputTarget*>(userData);
+            target.file->write(reinterpret_cast<const char*>(data), size);
+            target.written += size;
+            return target.file->good();
+        }, &target);
+
+    record.method = 8;
+    record.crc32 = 0;
+    uint64_t read = 0;
+    while (input)
+    {
+        input.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+        const size_t got = (size_t)input.gcount();
+        if (got == 0)
+            break;
+        record.crc32 = Crc32(m_buffer.data(), got, record.crc32);
+        if (!m_deflater.Write(m_buffer.data(), got))
+            return false;
+        read += got;
+    }
+    if (!m_deflater.Finish() || read != record.uncompressedSize)
+        return false;
+
+    record.compressedSize = target.written;
+    return true;
+}
+
+void ZipWriter::BuildCentralDirectory(std::vector<uint8_t>& directory) const
+{
+    directory.clear();
+    for (const Record& record : m_records)
+    {
+        std::vector<uint8_t> extra;
+        if (record.uncompressedSize >= 0xFFFFFFFF)
+            PutU64(extra, record.uncompressedSize);
+        if (record.compressedSize >= 0xFFFFFFFF)
+            PutU64(extra, record.compressedSize);
+        if (record.localHeaderOffset >= 0xFFFFFFFF)
+            PutU64(extra, record.localHeaderOffset);
+        if (!extra.empty())
+        {
+            const uint16_t size = (uint16_t)extra.size();
+            extra.insert(extra.begin(), { 0x01, 0x00, (uint8_t)size, (uint8_t)(size >> 8) });
+        }
+
+        PutU32(directory, CENTRAL_SIGNATURE);
+        PutU16(directory, record.unixMode != 0 ? 0x0300 | 45 : 45); // version made by: 4.5, Unix or MS-DOS attributes
+        PutU16(directory, extra.empty() ? 20 : 45);
+        PutU16(directory, FLAG_UTF8);
+        PutU16(directory, record.method);
+        PutU32(directory, m_dosDateTime);
+        PutU32(directory, record.crc32);
+        PutU32(directory, (uint32_t)std::min<uint64_t>(record.compressedSize, 0xFFFFFFFF));
+        PutU32(directory, (uint32_t)std::min<uint64_t>(record.uncompressedSize, 0xFFFFFFFF));
+        PutU16(directory, (uint16_t)record.name.size());
+        PutU16(directory, (uint16_t)extra.size());
+        PutU16(directory, 0);                   // comment
+        PutU16(directory, 0);                   // disk
+        PutU16(directory, 0);                   // internal attributes
+        PutU32(directory, (record.isDirectory ? 0x10 : 0) | (record.unixMode != 0 ? (0100000u | record.unixMode) << 16 : 0));
+        PutU32(directory, (uint32_t)std::min<uint64_t>(record.localHeaderOffset, 0xFFFFFFFF));
+        directory.insert(directory.end(), record.name.begin(), record.name.end());
+        directory.insert(directory.end(), extra.begin(), extra.end());
+    }
+}
+
+bool ZipWriter::Close(const std::string& comment)
+{
+    if (!m_file.is_open())
+        return false;
+
+    std::vector<uint8_t> tail;
+    BuildCentralDirectory(tail);
+    const uint64_t directoryOffset = m_offset;
+    const uint64_t directorySize = tail.size();
+    const uint64_t entryCount = m_records.size();
+
+    if (entryCount >= 0xFFFF || directoryOffset >= 0xFFFFFFFF || directorySize >= 0xFFFFFFFF)
+    {
+        const uint64_t recordOffset = directoryOffset + directorySize;
+        PutU32(tail, ZIP64_EOCD_SIGNATURE);
+        PutU64(tail, 44);
+        PutU16(tail, 45);
+        PutU16(tail, 45);
+        PutU32(tail, 0);
+        PutU32(tail, 0);
+        PutU64(tail, entryCount);
+        PutU64(tail, entryCount);
+        PutU64(tail, directorySize);
+        PutU64(tail, directoryOffset);
+
+        PutU32(tail, ZIP64_LOCATOR_SIGNATURE);
+        PutU32(tail, 0);
+        PutU64(tail, recordOffset);
+        PutU32(tail, 1);
+    }
+
+    const size_t commentSize = std::min<size_t>(comment.size(), 0xFFFF);
+    PutU32(tail, EOCD_SIGNATURE);
+    PutU16(tail, 0);
+    PutU16(tail, 0);
+    PutU16(tail, (uint16_t)std::min<uint64_t>(entryCount, 0xFFFF));
+    PutU16(tail, (uint16_t)std::min<uint64_t>(entryCount, 0xFFFF));
+    PutU32(tail, (uint32_t)std::min<uint64_t>(directorySize, 0xFFFFFFFF));
+    PutU32(tail, (uint32_t)std::min<uint64_t>(directoryOffset, 0xFFFFFFFF));
+    PutU16(tail, (uint16_t)commentSize);
+    tail.insert(tail.end(), comment.begin(), comment.begin() + commentSize);
+
+    m_file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+    m_offset += tail.size();
+    const bool ok = (bool)m_file;
+    m_file.close();
+
+    // A stored rewrite can leave stale deflate output past the real end
+    std::error_code ec;
+    if (ok)
+        std::filesystem::resize_file(m_path, m_offset, ec);
+    return ok && !ec;
+}
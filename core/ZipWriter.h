@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Deflate.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Sequential ZIP writer (ZIP64 aware). Entries are written in the order they are added.
+class ZipWriter
+{
+public:
+	struct Record
+	{
+		std::string name;
+		bool isDirectory = false;
+		uint16_t method = 0;
+		uint32_t crc32 = 0;
+		uint64_t compressedSize = 0;
+		uint64_t uncompressedSize = 0;
+		uint64_t localHeaderOffset = 0;
+		uint16_t unixMode = 0;          // permission bits of the source file where the platform has them
+	};
+
+	ZipWriter() = default;
+	~ZipWriter();
+
+	ZipWriter(const ZipWriter&) = delete;
+	ZipWriter& operator=(const ZipWriter&) = delete;
+
+	bool Open(const std::string& path, size_t bufferSize = 256 * 1024);
+	// Writes the archive after the current end of an existing file (e.g. an executable). Offsets are
+	// absolute, so the result opens as an ordinary ZIP.
+	bool OpenAppend(const std::string& path, size_t bufferSize = 256 * 1024);
+	bool IsOpen() const;
+
+	bool AddDirectory(const std::string& name);
+	// Deflates the file unless compress is false or deflating saves less than minSavings (0..1)
+	bool AddFile(const std::string& name, const std::filesystem::path& source, bool compress, double minSavings = 0.1);
+	bool AddData(const std::string& name, const uint8_t* data, size_t size);
+
+	// Central directory records for everything added so far, as they will be written by Close()
+	void BuildCentralDirectory(std::vector<uint8_t>& directory) const;
+	bool Close(const std::string& comment = "");
+
+	uint64_t Offset() const { return m_offset; }
+	const std::vector<Record>& Records() const { return m_records; }
+
+private:
+	std::ofstream m_file;
+	std::string m_path;
+	std::vector<Record> m_records;
+	std::vector<uint8_t> m_buffer;
+	Deflater m_deflater;
+	uint64_t m_offset = 0;
+	uint32_t m_dosDateTime = 0;
+
+	bool WriteLocalHeader(const Record& record, bool reserveZip64);
+	bool CopyStored(const std::filesystem::path& source, Record& record);
+	bool CopyDeflated(const std::filesystem::path& source, Record& record);
+};
@@ -20,8 +20,8 @@ project "core"
 
 	files
 	{
-		"**.h",
-		"**.cpp"
+		"%{prj.name}/**.h",
+		"%{prj.name}/**.cpp"
 	}
 	
 	includedirs
@@ -48,15 +48,101 @@ project "core"
 	filter "configurations:Debug"
 		defines { "_DEBUG", "_CONSOLE" }
 		symbols "On"
-		links
-		{
-			"zipp-d"
-		}
 		
 	filter "configurations:Release"
 		defines { "NDEBUG", "_CONSOLE" }
 		optimize "On"
-		links
-		{
-			"zipp"
-		}
+
+-- ZIP reader micro-benchmarks (run the Release build: premake-gen-bench [filter] [--min-ms N] [--csv])
+project "bench"
+	location "%{prj.name}"
+	kind "ConsoleApp"
+	language "C++"
+	targetname "premake-gen-bench"
+	targetdir ("bin/".. outputdir)
+	objdir ("%{prj.name}/int/".. outputdir)
+	cppdialect "C++17"
+	staticruntime "Off"
+
+	files
+	{
+		"%{prj.name}/**.cpp",
+		"core/ZipArchive.h",
+		"core/ZipArchive.cpp",
+		"core/ZipWriter.h",
+		"core/ZipWriter.cpp",
+		"core/Inflate.h",
+		"core/Inflate.cpp",
+		"core/Deflate.h",
+		"core/Deflate.cpp",
+		"core/Crc32.h",
+		"core/Crc32.cpp"
+	}
+
+	includedirs "core"
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+
+	filter "system:linux"
+		defines { "LINUX" }
+
+	filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "Speed"
+		symbols "On"
+
+-- Unit tests (premake-gen-tests [filter]; exits non-zero if one fails)
+project "tests"
+	location "%{prj.name}"
+	kind "ConsoleApp"
+	language "C++"
+	targetname "premake-gen-tests"
+	targetdir ("bin/".. outputdir)
+	objdir ("%{prj.name}/int/".. outputdir)
+	cppdialect "C++17"
+	staticruntime "Off"
+
+	files
+	{
+		"%{prj.name}/**.h",
+		"%{prj.name}/**.cpp",
+		"core/SymbolIndex.h",
+		"core/SymbolIndex.cpp",
+		"core/ZipArchive.h",
+		"core/ZipArchive.cpp",
+		"core/ZipWriter.h",
+		"core/ZipWriter.cpp",
+		"core/Inflate.h",
+		"core/Inflate.cpp",
+		"core/Deflate.h",
+		"core/Deflate.cpp",
+		"core/Crc32.h",
+		"core/Crc32.cpp",
+		"core/Console.h",
+		"core/Console.cpp",
+		"core/Json.h",
+		"core/Json.cpp"
+	}
+
+	includedirs "core"
+
+	filter "system:windows"
+		systemversion "latest"
+		defines { "WIN32" }
+
+	filter "system:linux"
+		defines { "LINUX" }
+
+	filter "configurations:Debug"
+		defines { "_DEBUG", "_CONSOLE" }
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG", "_CONSOLE" }
+		optimize "On"
@@ -0,0 +1,36 @@
+#include "Test.h"
+
+#include "Console.h"
+
+#include <string>
+#include <vector>
+
+TEST(ConsoleOptionsAreRemovedFromArguments)
+{
+    std::vector<std::string> args = { "MySolution", "MyProject", "-q", "-example" };
+    ParseConsoleOptions(args);
+    CHECK(ConsoleVerbosity() == Verbosity::Quiet);
+    CHECK((args == std::vector<std::string>{ "MySolution", "MyProject", "-example" }));
+
+    args = { "MySolution", "MyProject", "--verbose", "--json" };
+    ParseConsoleOptions(args);
+    CHECK(ConsoleVerbosity() == Verbosity::Verbose);
+    CHECK(ConsoleJson());
+    CHECK(args.size() == 2);
+}
+
+TEST(ConsoleOptionsKeepUpdateLibraryRemovals)
+{
+    // "-q", "-v" and "-json" remove the libraries q, v and json
+    std::vector<std::string> args = { "--update", "-q", "+fmt", "-v", "-json" };
+    ParseConsoleOptions(args);
+    CHECK(ConsoleVerbosity() == Verbosity::Normal);
+    CHECK(!ConsoleJson());
+    CHECK((args == std::vector<std::string>{ "--update", "-q", "+fmt", "-v", "-json" }));
+
+    args = { "--update", "-q", "--quiet", "--json" };
+    ParseConsoleOptions(args);
+    CHECK(ConsoleVerbosity() == Verbosity::Quiet);
+    CHECK(ConsoleJson());
+    CHECK((args == std::vector<std::string>{ "--update", "-q" }));
+}
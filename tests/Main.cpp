@@ -0,0 +1,43 @@
+#include "Test.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    size_t failures = 0;
+}
+
+std::vector<TestCase>& TestCases()
+{
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+    std::cout << "  [FAIL] " << file << ":" << line << ": " << expression << "\n";
+    ++failures;
+}
+
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    size_t run = 0;
+    size_t failed = 0;
+    for (const TestCase& test : TestCases())
+    {
+        if (std::strstr(test.name, filter) == nullptr)
+            continue;
+
+        std::cout << test.name << "\n";
+        const size_t before = failures;
+        test.run();
+        ++run;
+        if (failures != before)
+            ++failed;
+    }
+
+    std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include "Test.h"
+
+#include "SymbolIndex.h"
+
+#include <algorithm>
+
+namespace
+{
+    SymbolTable Table(std::vector<std::string> defined, std::vector<std::string> undefined)
+    {
+        SymbolTable table;
+        table.defined = std::move(defined);
+        table.undefined = std::move(undefined);
+        return table;
+    }
+
+    LinkEntry Entry(const std::string& name, const SymbolTable& archive)
+    {
+        LinkEntry entry;
+        entry.name = name;
+        entry.archives.push_back(&archive);
+        return entry;
+    }
+
+    // An ar archive of short import objects (what lib.exe writes for a DLL), one per symbol
+    std::vector<uint8_t> ImportLibrary(const std::vector<std::string>& symbols, const std::string& dll)
+    {
+        std::string archive = "!<arch>\n";
+        for (const std::string& symbol : symbols)
+        {
+            std::string member(20, '\0');
+            member[2] = member[3] = '\xFF';
+            member[6] = '\x64';
+            member[7] = '\x86';
+            member += symbol + '\0' + dll + '\0';
+
+            std::string header = "import/         0           0     0     644     " + std::to_string(member.size());
+            header.resize(58, ' ');
+            archive += header + "`\n" + member;
+            if (member.size() % 2 != 0)
+                archive += '\n';
+        }
+        return std::vector<uint8_t>(archive.begin(), archive.end());
+    }
+}
+
+TEST(ResolveLinksKeepsDebugReleasePair)
+{
+    // LibA-d.lib and LibA-r.lib define the same symbols; each is the only provider in its configuration
+    const SymbolTable objects = Table({ "main" }, { "LibA_Init" });
+    const SymbolTable debug = Table({ "LibA_Init" }, {});
+    const SymbolTable release = Table({ "LibA_Init" }, {});
+    std::vector<LinkEntry> entries = { Entry("LibA-d", debug), Entry("LibA-r", release) };
+
+    ResolveLinks(objects, { { "LibA-d" }, { "LibA-r" } }, entries);
+    CHECK(entries[0].used);
+    CHECK(entries[1].used);
+}
+
+TEST(ResolveLinksDropsEntryUnusedInEveryConfiguration)
+{
+    const SymbolTable objects = Table({ "main" }, { "Used" });
+    const SymbolTable used = Table({ "Used" }, {});
+    const SymbolTable unused = Table({ "Unused" }, {});
+    std::vector<LinkEntry> entries = { Entry("used", used), Entry("unused", unused) };
+
+    ResolveLinks(objects, { { "used", "unused" }, { "used", "unused" } }, entries);
+    CHECK(entries[0].used);
+    CHECK(!entries[1].used);
+}
+
+TEST(ResolveLinksFollowsArchiveDependencies)
+{
+    // used needs dep, which only the release configuration links
+    const SymbolTable objects = Table({ "main" }, { "Used" });
+    const SymbolTable used = Table({ "Used" }, { "Dep" });
+    const SymbolTable dep = Table({ "Dep" }, {});
+    std::vector<LinkEntry> entries = { Entry("used", used), Entry("dep", dep) };
+
+    ResolveLinks(objects, { { "used" }, { "used", "dep" } }, entries);
+    CHECK(entries[0].used);
+    CHECK(entries[1].used);
+}
+
+TEST(ResolveLinksMarksOpaqueOnlyWhereLinked)
+{
+    const SymbolTable objects = Table({ "main" }, { "Used" });
+    SymbolTable partial = Table({ "Used" }, {});
+    partial.complete = false;
+    const SymbolTable other = Table({ "Other" }, {});
+    std::vector<LinkEntry> entries = { Entry("partial", partial), Entry("debugOnly", other), Entry("releaseOnly", other) };
+
+    ResolveLinks(objects, { { "partial", "debugOnly" }, { "releaseOnly" } }, entries);
+    CHECK(entries[1].opaque);
+    CHECK(!entries[2].opaque);
+}
+
+TEST(ResolveLinksKeepsEntriesAnyExecutableNeeds)
+{
+    // The main project doesn't call LibA, the bench project does
+    const SymbolTable main = Table({ "main" }, { "Used" });
+    const SymbolTable bench = Table({ "main" }, { "Used", "LibA_Run" });
+    const SymbolTable used = Table({ "Used" }, {});
+    const SymbolTable libA = Table({ "LibA_Run" }, {});
+    std::vector<LinkEntry> entries = { Entry("used", used), Entry("LibA", libA) };
+
+    ResolveLinks(main, { { "used", "LibA" } }, entries);
+    CHECK(!entries[1].used);
+    ResolveLinks(bench, { { "used", "LibA" } }, entries);
+    CHECK(entries[1].used);
+}
+
+TEST(ArchiveSymbolReaderReadsStreamedArchive)
+{
+    const std::vector<uint8_t> archive = ImportLibrary({ "LibA_Init", "LibA_Run" }, "LibA.dll");
+
+    // However the stream is cut, the table is the same
+    for (size_t chunk : { archive.size(), size_t(61), size_t(1) })
+    {
+        ArchiveSymbolReader reader;
+        for (size_t offset = 0; offset < archive.size(); offset += chunk)
+            CHECK(reader.Feed(archive.data() + offset, std::min(chunk, archive.size() - offset)));
+
+        SymbolTable table;
+        CHECK(reader.Finish(table));
+        CHECK(table.complete);
+        CHECK((table.dlls == std::vector<std::string>{ "liba.dll" }));
+        CHECK((table.defined == std::vector<std::string>{ "LibA_Init", "LibA_Run", "__imp_LibA_Init", "__imp_LibA_Run" }));
+    }
+}
+
+TEST(ArchiveSymbolReaderRejectsTruncatedArchive)
+{
+    const std::vector<uint8_t> archive = ImportLibrary({ "LibA_Init" }, "LibA.dll");
+    ArchiveSymbolReader reader;
+    CHECK(reader.Feed(archive.data(), archive.size() - 4));
+    SymbolTable table;
+    CHECK(!reader.Finish(table));
+
+    ArchiveSymbolReader notArchive;
+    CHECK(!notArchive.Feed(reinterpret_cast<const uint8_t*>("MZ\x90\0\3\0\0\0"), 8));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+// Minimal test harness: TEST() registers a function that Main.cpp runs, CHECK() records a failure and
+// carries on so one run reports every broken expectation.
+//
+// Usage: premake-gen-tests [filter]
+//   filter    only runs tests whose name contains this text
+
+struct TestCase
+{
+	const char* name;
+	void (*run)();
+};
+
+std::vector<TestCase>& TestCases();
+void ReportFailure(const char* file, int line, const char* expression);
+
+#define TEST(name) \
+	static void name(); \
+	static const bool name##Registered = (TestCases().push_back({ #name, name }), true); \
+	static void name()
+
+#define CHECK(expression) \
+	do { if (!(expression)) ReportFailure(__FILE__, __LINE__, #expression); } while (false)
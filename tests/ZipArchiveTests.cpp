@@ -0,0 +1,245 @@
+#include "Test.h"
+
+#include "ZipArchive.h"
+#include "ZipWriter.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+    std::string TempPath(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).generic_u8string();
+    }
+
+    // Two files and a "--pack" index. A non-zero indexSize replaces the size the comment records, and
+    // renaming a segment in the index (keeping its length) stands in for a crafted index.
+    bool WritePacked(const std::string& path, uint64_t indexSize = 0, const std::string& segment = "", const std::string& renamed = "")
+    {
+        ZipWriter writer;
+        const std::string text = "int main() { return 0; }\n";
+        if (!writer.Open(path) || !writer.AddData("src/main.cpp", reinterpret_cast<const uint8_t*>(text.data()), text.size()) ||
+            !writer.AddData("ab/lib.h", reinterpret_cast<const uint8_t*>(text.data()), text.size()))
+            return false;
+
+        std::vector<uint8_t> directory;
+        std::vector<uint8_t> index;
+        writer.BuildCentralDirectory(directory);
+        if (!ZipArchive::BuildIndex(directory, writer.Records().size(), index))
+            return false;
+        if (!segment.empty())
+        {
+            const auto at = std::search(index.begin(), index.end(), segment.begin(), segment.end());
+            if (at == index.end() || renamed.size() != segment.size())
+                return false;
+            std::copy(renamed.begin(), renamed.end(), at);
+        }
+        const uint64_t indexOffset = writer.Offset();
+        if (!writer.AddData(ZipArchive::INDEX_ENTRY_NAME, index.data(), index.size()))
+            return false;
+
+        std::string comment = ZipArchive::IndexComment(indexOffset, index, writer.Offset());
+        if (indexSize != 0)
+        {
+            const std::string size = " " + std::to_string(index.size()) + " ";
+            comment.replace(comment.find(size), size.size(), " " + std::to_string(indexSize) + " ");
+        }
+        return writer.Close(comment);
+    }
+
+    void PutU16(std::string& out, uint64_t value)
+    {
+        for (int i = 0; i < 2; ++i)
+            out += char((value >> (i * 8)) & 0xFF);
+    }
+
+    void PutU32(std::string& out, uint64_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            out += char((value >> (i * 8)) & 0xFF);
+    }
+
+    void PutU64(std::string& out, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            out += char((value >> (i * 8)) & 0xFF);
+    }
+
+    // One file whose end record claims entryCount entries; counts that do not fit 16 bits go through a ZIP64 record
+    bool WriteWithEntryCount(const std::string& path, uint64_t entryCount)
+    {
+        ZipWriter writer;
+        if (!writer.Open(path) || !writer.AddData("a.txt", reinterpret_cast<const uint8_t*>("a"), 1) || !writer.Close())
+            return false;
+
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        const size_t EOCD_SIZE = 22;
+        if (data.size() < EOCD_SIZE || data.compare(data.size() - EOCD_SIZE, 4, "PK\x05\x06") != 0)
+            return false;
+
+        const std::string eocd = data.substr(data.size() - EOCD_SIZE);
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(eocd.data());
+        const uint64_t directorySize = p[12] | (p[13] << 8) | (p[14] << 16) | (uint64_t(p[15]) << 24);
+        const uint64_t directoryOffset = p[16] | (p[17] << 8) | (p[18] << 16) | (uint64_t(p[19]) << 24);
+        data.resize(data.size() - EOCD_SIZE);
+
+        const bool zip64 = entryCount >= 0xFFFF;
+        if (zip64)
+        {
+            const uint64_t recordOffset = data.size();
+            data += "PK\x06\x06";
+            PutU64(data, 44);
+            PutU16(data, 45);
+            PutU16(data, 45);
+            PutU32(data, 0);
+            PutU32(data, 0);
+            PutU64(data, entryCount);
+            PutU64(data, entryCount);
+            PutU64(data, directorySize);
+            PutU64(data, directoryOffset);
+
+            data += "PK\x06\x07";
+            PutU32(data, 0);
+            PutU64(data, recordOffset);
+            PutU32(data, 1);
+        }
+
+        data += "PK\x05\x06";
+        PutU16(data, 0);
+        PutU16(data, 0);
+        PutU16(data, zip64 ? 0xFFFF : entryCount);
+        PutU16(data, zip64 ? 0xFFFF : entryCount);
+        PutU32(data, directorySize);
+        PutU32(data, directoryOffset);
+        PutU16(data, 0);
+        std::ofstream out(path, std::ios::binary);
+        out.write(data.data(), data.size());
+        return bool(out);
+    }
+}
+
+TEST(ZipArchiveLoadsPackedIndex)
+{
+    const std::string path = TempPath("premake-gen-tests-index.zip");
+    CHECK(WritePacked(path));
+
+    ZipArchive archive;
+    CHECK(archive.Open(path));
+    CHECK(archive.LoadedFromIndex());
+    CHECK(archive.Contains("src/main.cpp"));
+    archive.Close();
+    std::filesystem::remove(path);
+}
+
+TEST(ZipArchiveIgnoresIndexLargerThanArchive)
+{
+    // A damaged comment must not size an allocation; the central directory still opens the archive
+    const std::string path = TempPath("premake-gen-tests-bad-index.zip");
+    CHECK(WritePacked(path, uint64_t(1) << 40));
+
+    ZipArchive archive;
+    CHECK(archive.Open(path));
+    CHECK(!archive.LoadedFromIndex());
+    CHECK(archive.Contains("src/main.cpp"));
+    archive.Close();
+    std::filesystem::remove(path);
+}
+
+TEST(ZipArchiveRejectsUnsafeIndexNames)
+{
+    // A crafted index that turns ab/lib.h into ../lib.h, or names a segment "/.h", is dropped for the central directory
+    const std::string path = TempPath("premake-gen-tests-unsafe-index.zip");
+    for (const char* renamed : { "..lib.h", "ab../.h" })
+    {
+        CHECK(WritePacked(path, 0, "ablib.h", renamed));
+
+        ZipArchive archive;
+        CHECK(archive.Open(path));
+        CHECK(!archive.LoadedFromIndex());
+        CHECK(archive.Contains("ab/lib.h"));
+        CHECK(!archive.Contains("../lib.h"));
+        archive.Close();
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ZipArchiveRejectsEntryCountLargerThanDirectory)
+{
+    // A damaged end record claims more entries than the one-entry central directory can hold,
+    // through the 16-bit count and through a ZIP64 record
+    const std::string path = TempPath("premake-gen-tests-count.zip");
+    for (const uint64_t entryCount : { uint64_t(2), uint64_t(1) << 60 })
+    {
+        CHECK(WriteWithEntryCount(path, entryCount));
+
+        ZipArchive archive;
+        CHECK(!archive.Open(path));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(ZipArchiveRejectsEntriesThatDoNotMatchTheirDirectoryRecord)
+{
+    // Changing the CRC-32 or the size the central directory records stands in for a damaged stream
+    const std::string path = TempPath("premake-gen-tests-crc.zip");
+    const std::string target = TempPath("premake-gen-tests-crc.txt");
+    const std::string text = "int main() { return 0; }\n";
+    for (const size_t field : { size_t(0), size_t(16), size_t(24) })
+    {
+        ZipWriter writer;
+        CHECK(writer.Open(path));
+        CHECK(writer.AddData("src/main.cpp", reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+        CHECK(writer.Close());
+        if (field != 0)
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            const size_t header = data.find("PK\x01\x02");
+            CHECK(header != std::string::npos);
+            file.clear();
+            file.seekp(header + field);
+            file.put(char(data[header + field] ^ 1));
+        }
+
+        ZipArchive archive;
+        CHECK(archive.Open(path));
+        const uint32_t entry = archive.Find("src/main.cpp");
+        std::string content;
+        CHECK(entry != ZipArchive::npos);
+        CHECK(archive.ExtractToFile(entry, target) == (field == 0));
+        CHECK(archive.ExtractToString(entry, content) == (field == 0));
+        archive.Close();
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(target);
+}
+
+#ifndef _WIN32
+TEST(ZipArchiveKeepsUnixFileModes)
+{
+    // A Linux premake5 in an embedded payload has to come out executable
+    const std::string source = TempPath("premake-gen-tests-premake5");
+    const std::string path = TempPath("premake-gen-tests-modes.zip");
+    std::ofstream(source) << "#!/bin/sh\n";
+    std::filesystem::permissions(source, std::filesystem::perms(0755));
+
+    ZipWriter writer;
+    CHECK(writer.Open(path));
+    CHECK(writer.AddFile("premake5", source, false));
+    CHECK(writer.Close());
+
+    ZipArchive archive;
+    CHECK(archive.Open(path));
+    const uint32_t entry = archive.Find("premake5");
+    CHECK(entry != ZipArchive::npos && archive[entry].unixMode == 0755);
+    archive.Close();
+    std::filesystem::remove(path);
+    std::filesystem::remove(source);
+}
+#endif